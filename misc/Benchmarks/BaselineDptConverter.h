@@ -0,0 +1,35 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef BASELINEDPTCONVERTER_H_
+#define BASELINEDPTCONVERTER_H_
+
+#include <cstdint>
+
+#include <homegear-base/BaseLib.h>
+
+using namespace BaseLib;
+
+namespace Knx {
+namespace Baseline {
+
+/**
+ * The DptConverter comparing the type string against every supported DPT on each call. Used as reference by
+ * knx-dpt-benchmark.
+ */
+class DptConverter {
+ public:
+  DptConverter(BaseLib::SharedObjects *baseLib);
+  virtual ~DptConverter();
+
+  bool fitsInFirstByte(const std::string &type);
+  std::vector<uint8_t> getDpt(const std::string &type, PVariable &value, const BaseLib::Role &role);
+  PVariable getVariable(const std::string &type, std::vector<uint8_t> &value, const BaseLib::Role &role);
+ protected:
+  BaseLib::SharedObjects *_bl = nullptr;
+  std::shared_ptr<BaseLib::Ansi> _ansi;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,113 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+/*
+ * Counts heap allocations and measures the time per telegram of the receive and send paths of KnxIpPacket and Cemi. The
+ * receive benchmarks parse packets the same way MainInterface and RoutingInterface do. The send benchmarks serialize into
+ * a reused buffer like the send threads.
+ *
+ * Usage: knx-codec-benchmark [iterations]
+ */
+
+#include "Cemi.h"
+#include "KnxIpPacket.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+volatile uint64_t sink = 0; //Keeps the compiler from removing the benchmarked code
+
+template<typename Function>
+void run(const std::string &name, uint64_t iterations, Function function) {
+  function(); //Warm up, so reused buffers have their capacity
+  uint64_t allocationsBefore = allocations;
+  auto startTime = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    function();
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+  uint64_t allocationCount = allocations - allocationsBefore;
+  std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(2) << std::setw(8) << (double)allocationCount / iterations << " allocations" << std::setw(10)
+            << (double)duration / iterations << " ns per telegram" << std::endl;
+}
+
+}
+
+void *operator new(size_t size) {
+  allocations++;
+  void *memory = std::malloc(size == 0 ? 1 : size);
+  if (!memory) throw std::bad_alloc();
+  return memory;
+}
+
+void operator delete(void *memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+  std::free(memory);
+}
+
+int main(int argc, char *argv[]) {
+  using namespace Knx;
+
+  uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  if (iterations == 0) iterations = 1;
+
+  //GroupValueWrite of DPT-9 (21.5) from 1.1.10 to 1/2/3
+  const std::vector<uint8_t> cemi{0x29, 0x00, 0xBC, 0xE0, 0x11, 0x0A, 0x0A, 0x03, 0x03, 0x00, 0x80, 0x0C, 0x33};
+  std::vector<uint8_t> tunnelingRequest{0x06, 0x10, 0x04, 0x20, 0x00, 0x17, 0x04, 0x01, 0x05, 0x00};
+  tunnelingRequest.insert(tunnelingRequest.end(), cemi.begin(), cemi.end());
+  std::vector<uint8_t> routingIndication{0x06, 0x10, 0x05, 0x30, 0x00, 0x13};
+  routingIndication.insert(routingIndication.end(), cemi.begin(), cemi.end());
+
+  std::cout << "Iterations: " << iterations << std::endl;
+
+  //{{{ Receive
+  run("Parse TUNNELING_REQUEST", iterations, [&] {
+    auto packet = std::make_shared<KnxIpPacket>(tunnelingRequest);
+    sink += packet->getTunnelingRequest()->cemi->getDestinationAddress();
+  });
+
+  run("Parse ROUTING_INDICATION", iterations, [&] {
+    auto packet = std::make_shared<KnxIpPacket>(routingIndication);
+    sink += packet->getRoutingIndication()->cemi->getDestinationAddress();
+  });
+
+  run("Parse cEMI only", iterations, [&] {
+    Cemi packet(cemi.data(), cemi.size());
+    sink += packet.getPayload().size();
+  });
+  //}}}
+
+  //{{{ Send
+  std::vector<uint8_t> payload{0x0C, 0x33};
+  auto groupValueWrite = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0x110A, 0x0A03, false, payload);
+  std::vector<uint8_t> buffer;
+  uint8_t sequenceCounter = 0;
+
+  run("Serialize TUNNELING_REQUEST into reused buffer", iterations, [&] {
+    buffer.clear();
+    KnxIpPacket::appendTunnelingRequest(buffer, 1, sequenceCounter++, *groupValueWrite);
+    sink += buffer.size();
+  });
+
+  run("Serialize ROUTING_INDICATION into reused buffer", iterations, [&] {
+    buffer.clear();
+    KnxIpPacket::appendRoutingIndication(buffer, *groupValueWrite);
+    sink += buffer.size();
+  });
+
+  run("Create and serialize GroupValueWrite", iterations, [&] {
+    auto packet = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0x110A, 0x0A03, false, payload);
+    buffer.clear();
+    KnxIpPacket::appendTunnelingRequest(buffer, 1, sequenceCounter++, *packet);
+    sink += buffer.size();
+  });
+  //}}}
+
+  return 0;
+}
@@ -0,0 +1,265 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+/*
+ * Compares the lookup of the peers of a received telegram's group address in KnxCentral::getPeer(uint16_t). "Before" is
+ * the lookup used before: lock _peersMutex and search std::map<uint16_t, PGroupAddressPeers>. "After" is the flat table
+ * with one std::atomic_load per telegram. Both sides use the same data layout as KnxCentral, with a small stand-in for
+ * KnxPeer, so the benchmark doesn't need a running central.
+ *
+ * Every scenario dispatches the given number of synthetic telegrams to random group addresses and calls every peer of
+ * the group address:
+ *   - One dispatch thread.
+ *   - Several dispatch threads like the shards of PacketDispatcher.
+ *   - The same with one more thread that permanently publishes membership changes, like a search or peer deletion.
+ *
+ * Usage: knx-dispatch-benchmark [telegrams] [dispatch threads]
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+volatile uint64_t sink = 0; //Keeps the compiler from removing the benchmarked code
+
+const uint32_t groupAddressCount = 4000; //Group addresses used by peers
+const uint32_t peerCount = 1500;
+
+/**
+ * Stand-in for KnxPeer. packetReceived() only touches the peer, the real one decodes the payload.
+ */
+class Peer {
+ public:
+  explicit Peer(uint64_t id) : _id(id) {}
+  uint64_t getID() const { return _id; }
+  void packetReceived(uint64_t &counter) { counter += _id; }
+ private:
+  uint64_t _id = 0;
+};
+typedef std::shared_ptr<Peer> PPeer;
+
+//{{{ Before: _peersMutex and std::map
+class MapDispatcher {
+ public:
+  typedef std::shared_ptr<std::map<uint64_t, PPeer>> PGroupAddressPeers;
+
+  PGroupAddressPeers getPeer(uint16_t groupAddress) {
+    std::lock_guard<std::mutex> peersGuard(_peersMutex);
+    auto peersIterator = _peersByGroupAddress.find(groupAddress);
+    if (peersIterator != _peersByGroupAddress.end()) return peersIterator->second;
+    return PGroupAddressPeers();
+  }
+
+  void addPeerToGroupAddress(uint16_t groupAddress, const PPeer &peer) {
+    std::lock_guard<std::mutex> peersGuard(_peersMutex);
+    //The old code modified the map in place while dispatch threads iterated over it. Copy it, so the benchmark doesn't
+    //crash. This only makes the writer slower, the readers are unchanged.
+    auto &peers = _peersByGroupAddress[groupAddress];
+    auto newPeers = peers ? std::make_shared<std::map<uint64_t, PPeer>>(*peers) : std::make_shared<std::map<uint64_t, PPeer>>();
+    (*newPeers)[peer->getID()] = peer;
+    peers = std::move(newPeers);
+  }
+
+  void removePeerFromGroupAddress(uint16_t groupAddress, uint64_t peerId) {
+    std::lock_guard<std::mutex> peersGuard(_peersMutex);
+    auto peersIterator = _peersByGroupAddress.find(groupAddress);
+    if (peersIterator == _peersByGroupAddress.end()) return;
+    auto newPeers = std::make_shared<std::map<uint64_t, PPeer>>(*peersIterator->second);
+    newPeers->erase(peerId);
+    if (newPeers->empty()) _peersByGroupAddress.erase(peersIterator);
+    else peersIterator->second = std::move(newPeers);
+  }
+
+  void dispatch(uint16_t groupAddress, uint64_t &counter) {
+    auto peers = getPeer(groupAddress);
+    if (!peers) return;
+    for (auto &peer : *peers) {
+      peer.second->packetReceived(counter);
+    }
+  }
+ private:
+  std::mutex _peersMutex;
+  std::map<uint16_t, PGroupAddressPeers> _peersByGroupAddress;
+};
+//}}}
+
+//{{{ After: flat table of immutable snapshots
+class TableDispatcher {
+ public:
+  typedef std::shared_ptr<const std::vector<PPeer>> PGroupAddressPeers;
+
+  PGroupAddressPeers getPeer(uint16_t groupAddress) {
+    return std::atomic_load(&(*_groupAddressTable)[groupAddress]);
+  }
+
+  void addPeerToGroupAddress(uint16_t groupAddress, const PPeer &peer) {
+    std::lock_guard<std::mutex> peersGuard(_peersMutex);
+    _peersByGroupAddress[groupAddress][peer->getID()] = peer;
+    publishGroupAddress(groupAddress);
+  }
+
+  void removePeerFromGroupAddress(uint16_t groupAddress, uint64_t peerId) {
+    std::lock_guard<std::mutex> peersGuard(_peersMutex);
+    auto peersIterator = _peersByGroupAddress.find(groupAddress);
+    if (peersIterator == _peersByGroupAddress.end()) return;
+    peersIterator->second.erase(peerId);
+    publishGroupAddress(groupAddress);
+    if (peersIterator->second.empty()) _peersByGroupAddress.erase(peersIterator);
+  }
+
+  void dispatch(uint16_t groupAddress, uint64_t &counter) {
+    auto peers = getPeer(groupAddress);
+    if (!peers) return;
+    for (auto &peer : *peers) {
+      peer->packetReceived(counter);
+    }
+  }
+ private:
+  std::mutex _peersMutex;
+  std::map<uint16_t, std::map<uint64_t, PPeer>> _peersByGroupAddress;
+  std::unique_ptr<std::array<PGroupAddressPeers, 65536>> _groupAddressTable{new std::array<PGroupAddressPeers, 65536>()};
+
+  void publishGroupAddress(uint16_t groupAddress) {
+    PGroupAddressPeers snapshot;
+    auto peersIterator = _peersByGroupAddress.find(groupAddress);
+    if (peersIterator != _peersByGroupAddress.end() && !peersIterator->second.empty()) {
+      auto peers = std::make_shared<std::vector<PPeer>>();
+      peers->reserve(peersIterator->second.size());
+      for (auto &peer : peersIterator->second) {
+        peers->push_back(peer.second);
+      }
+      snapshot = std::move(peers);
+    }
+    std::atomic_store(&(*_groupAddressTable)[groupAddress], snapshot);
+  }
+};
+//}}}
+
+struct Setup {
+  std::vector<PPeer> peers;
+  std::vector<uint16_t> groupAddresses; //Group addresses used by peers
+  std::vector<std::pair<uint16_t, PPeer>> memberships;
+  std::vector<uint16_t> telegrams; //Destination addresses of the synthetic telegrams
+};
+
+Setup createSetup() {
+  Setup setup;
+  std::mt19937 random(4711);
+  for (uint32_t i = 0; i < peerCount; i++) {
+    setup.peers.push_back(std::make_shared<Peer>(i + 1));
+  }
+  //Group addresses from 1/0/0 upwards. Like in real installations, most group addresses belong to one or two peers.
+  for (uint32_t i = 0; i < groupAddressCount; i++) {
+    uint16_t groupAddress = (uint16_t)(0x0800 + i);
+    setup.groupAddresses.push_back(groupAddress);
+    uint32_t members = 1 + random() % 3;
+    for (uint32_t j = 0; j < members; j++) {
+      setup.memberships.emplace_back(groupAddress, setup.peers.at(random() % peerCount));
+    }
+  }
+  //90 % of the telegrams are for group addresses of peers, the rest is other bus traffic.
+  setup.telegrams.reserve(1 << 20);
+  for (uint32_t i = 0; i < (1 << 20); i++) {
+    if (random() % 10 == 0) setup.telegrams.push_back((uint16_t)(random() % 65536));
+    else setup.telegrams.push_back(setup.groupAddresses.at(random() % groupAddressCount));
+  }
+  return setup;
+}
+
+/**
+ * @return Returns the time per telegram in nanoseconds.
+ */
+template<typename Dispatcher>
+double run(const Setup &setup, uint64_t telegramCount, uint32_t threadCount, bool contended, uint64_t &membershipChanges) {
+  Dispatcher dispatcher;
+  for (auto &membership : setup.memberships) {
+    dispatcher.addPeerToGroupAddress(membership.first, membership.second);
+  }
+
+  std::atomic_bool stop{false};
+  std::atomic<uint64_t> changes{0};
+  std::thread writerThread;
+  if (contended) {
+    //Moves peers between group addresses as fast as possible.
+    writerThread = std::thread([&] {
+      std::mt19937 random(42);
+      while (!stop) {
+        auto groupAddress = setup.groupAddresses.at(random() % groupAddressCount);
+        auto &peer = setup.peers.at(random() % peerCount);
+        dispatcher.addPeerToGroupAddress(groupAddress, peer);
+        dispatcher.removePeerFromGroupAddress(groupAddress, peer->getID());
+        changes += 2;
+      }
+    });
+  }
+
+  std::vector<std::thread> threads;
+  uint64_t telegramsPerThread = telegramCount / threadCount;
+  auto startTime = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < threadCount; i++) {
+    threads.emplace_back([&, i] {
+      uint64_t counter = 0;
+      size_t index = (i * 7919) % setup.telegrams.size();
+      for (uint64_t j = 0; j < telegramsPerThread; j++) {
+        dispatcher.dispatch(setup.telegrams[index], counter);
+        if (++index == setup.telegrams.size()) index = 0;
+      }
+      sink += counter;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+  stop = true;
+  if (writerThread.joinable()) writerThread.join();
+  membershipChanges = changes;
+  //Wall time per telegram over all threads
+  return (double)duration / (telegramsPerThread * threadCount);
+}
+
+void printResult(const std::string &name, double before, double after, uint64_t changesBefore, uint64_t changesAfter, bool contended) {
+  std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1) << std::setw(14) << before << std::setw(14) << after << std::setw(10) << before / after << "x";
+  if (contended) std::cout << "   membership changes: " << changesBefore << " before, " << changesAfter << " after";
+  std::cout << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t telegramCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+  uint32_t threadCount = argc > 2 ? (uint32_t)std::strtoul(argv[2], nullptr, 10) : 4;
+  if (threadCount == 0) threadCount = 1;
+  if (telegramCount < threadCount) telegramCount = threadCount;
+
+  auto setup = createSetup();
+  std::cout << "Telegrams: " << telegramCount << ", dispatch threads: " << threadCount << ", group addresses: " << groupAddressCount << ", memberships: " << setup.memberships.size()
+            << ". Times in ns per telegram (wall time over all threads)." << std::endl;
+  std::cout << std::left << std::setw(36) << "Scenario" << std::right << std::setw(14) << "before" << std::setw(14) << "after" << std::setw(11) << "speedup" << std::endl;
+
+  uint64_t changesBefore = 0;
+  uint64_t changesAfter = 0;
+  double before = run<MapDispatcher>(setup, telegramCount, 1, false, changesBefore);
+  double after = run<TableDispatcher>(setup, telegramCount, 1, false, changesAfter);
+  printResult("1 thread", before, after, 0, 0, false);
+
+  before = run<MapDispatcher>(setup, telegramCount, threadCount, false, changesBefore);
+  after = run<TableDispatcher>(setup, telegramCount, threadCount, false, changesAfter);
+  printResult(std::to_string(threadCount) + " threads", before, after, 0, 0, false);
+
+  before = run<MapDispatcher>(setup, telegramCount, threadCount, true, changesBefore);
+  after = run<TableDispatcher>(setup, telegramCount, threadCount, true, changesAfter);
+  printResult(std::to_string(threadCount) + " threads + membership changes", before, after, changesBefore, changesAfter, true);
+
+  return 0;
+}
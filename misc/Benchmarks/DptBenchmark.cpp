@@ -0,0 +1,155 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+/*
+ * Compares the DPT conversion of the table driven DptConverter with the string comparing one used before (see
+ * BaselineDptConverter.h). Every supported DPT is encoded and decoded with both converters. "Before" passes the type
+ * string on every call like the old peer code, "after" parses it once like the decode plan of KnxPeer. The results of
+ * both converters are compared, so the benchmark also shows that the behaviour didn't change.
+ *
+ * Usage: knx-dpt-benchmark [iterations per DPT and direction]
+ */
+
+#include "BaselineDptConverter.h"
+#include "DptConverter.h"
+#include "Gd.h"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+volatile uint64_t sink = 0; //Keeps the compiler from removing the benchmarked code
+
+struct Sample {
+  std::string type;
+  BaseLib::PVariable value;
+};
+
+template<typename Function>
+double measure(uint64_t iterations, Function function) {
+  auto startTime = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    function();
+  }
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count() / iterations;
+}
+
+std::vector<Sample> createSamples() {
+  using BaseLib::Variable;
+  std::vector<Sample> samples;
+  auto add = [&](const std::string &type, const BaseLib::PVariable &value) { samples.push_back(Sample{type, value}); };
+
+  add("DPST-1-1", std::make_shared<Variable>(true));
+  add("DPST-2-1", std::make_shared<Variable>((int32_t)3));
+  add("DPST-3-7", std::make_shared<Variable>((int32_t)9));
+  add("DPST-4-1", std::make_shared<Variable>((int32_t)'K'));
+  add("DPST-4-2", std::make_shared<Variable>((int32_t)0xC4));
+  add("DPST-5-1", std::make_shared<Variable>((int32_t)42));
+  add("DPST-5-3", std::make_shared<Variable>((int32_t)180));
+  add("DPST-5-10", std::make_shared<Variable>((int32_t)200));
+  add("DPST-6-1", std::make_shared<Variable>((int32_t)-20));
+  add("DPST-7-1", std::make_shared<Variable>((int32_t)4711));
+  add("DPST-8-1", std::make_shared<Variable>((int32_t)-4711));
+  add("DPST-9-1", std::make_shared<Variable>(21.5));
+  add("DPST-10-1", std::make_shared<Variable>((int32_t)0x4B1E2D));
+  add("DPST-11-1", std::make_shared<Variable>((int32_t)0x1F0C14));
+  add("DPST-12-1", std::make_shared<Variable>((int32_t)123456789));
+  add("DPST-13-1", std::make_shared<Variable>((int32_t)-123456789));
+  add("DPST-14-56", std::make_shared<Variable>(1234.5));
+  add("DPST-15-0", std::make_shared<Variable>((int32_t)0x12345678));
+  add("DPST-16-0", std::make_shared<Variable>(std::string("Homegear KNX")));
+  add("DPST-17-1", std::make_shared<Variable>((int32_t)12));
+  add("DPST-18-1", std::make_shared<Variable>((int32_t)0x8C));
+  add("DPST-19-1", std::make_shared<Variable>((int64_t)0x7814011A0C1E0000));
+  add("DPST-20-102", std::make_shared<Variable>((int32_t)2));
+  add("DPST-21-1", std::make_shared<Variable>((int32_t)0x05));
+  add("DPST-22-101", std::make_shared<Variable>((int32_t)0x0102));
+  add("DPST-23-1", std::make_shared<Variable>((int32_t)2));
+  add("DPST-25-1000", std::make_shared<Variable>((int32_t)0x33));
+  add("DPST-26-1", std::make_shared<Variable>((int32_t)0x41));
+  add("DPST-27-1", std::make_shared<Variable>((int32_t)0x00FF00AA));
+  add("DPST-29-10", std::make_shared<Variable>((int64_t)123456789012));
+  add("DPST-30-1010", std::make_shared<Variable>((int32_t)0x0A0B0C));
+  add("DPST-206-100", std::make_shared<Variable>((int32_t)0x012C01));
+  add("DPST-217-1", std::make_shared<Variable>((int32_t)0x1234));
+  add("DPST-219-1", std::make_shared<Variable>((int64_t)0x0102030405));
+  add("DPST-222-100", std::make_shared<Variable>((int64_t)0x0C800CE00D40));
+  add("DPST-229-1", std::make_shared<Variable>((int64_t)0x000001F40B01));
+  add("DPST-230-1000", std::make_shared<Variable>((int64_t)0x0001020304050607));
+  add("DPST-232-600", std::make_shared<Variable>((int32_t)0xFF8000));
+  add("DPST-234-1", std::make_shared<Variable>((int32_t)0x6465));
+  add("DPST-237-600", std::make_shared<Variable>((int32_t)0x0103));
+  add("DPST-238-600", std::make_shared<Variable>((int32_t)0x41));
+  add("DPST-240-800", std::make_shared<Variable>((int32_t)0x3264FF));
+  add("DPST-241-800", std::make_shared<Variable>((int32_t)0x3264FF03));
+  add("DPST-244-600", std::make_shared<Variable>((int32_t)0x0103));
+  add("DPST-245-600", std::make_shared<Variable>((int64_t)0x010203040506));
+  add("DPST-249-600", std::make_shared<Variable>((int64_t)0x00640FA01407));
+  add("DPST-250-600", std::make_shared<Variable>((int32_t)0x031F01));
+  add("DPST-251-600", std::make_shared<Variable>((int64_t)0x8040C0FF000F));
+  return samples;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+  if (iterations == 0) iterations = 1;
+
+  auto bl = std::make_unique<BaseLib::SharedObjects>();
+  Knx::Gd::bl = bl.get();
+  Knx::Baseline::DptConverter before(bl.get());
+  Knx::DptConverter after(bl.get());
+  BaseLib::Role role;
+
+  std::cout << "Iterations per DPT and direction: " << iterations << ". Times in ns per call." << std::endl;
+  std::cout << std::left << std::setw(16) << "DPT" << std::right << std::setw(16) << "encode before" << std::setw(16) << "encode after" << std::setw(16) << "decode before"
+            << std::setw(16) << "decode after" << std::endl;
+
+  double encodeBeforeSum = 0;
+  double encodeAfterSum = 0;
+  double decodeBeforeSum = 0;
+  double decodeAfterSum = 0;
+  uint32_t mismatches = 0;
+  auto samples = createSamples();
+  for (auto &sample : samples) {
+    auto dpt = Knx::DptConverter::parseDpt(sample.type);
+
+    //Values are only modified when the role scales or inverts them, so they can be reused.
+    auto value = sample.value;
+
+    //{{{ Check that both converters produce the same results
+    auto beforeBinary = before.getDpt(sample.type, value, role);
+    auto afterBinary = after.getDpt(dpt, value, role);
+    auto beforeVariable = before.getVariable(sample.type, beforeBinary, role);
+    auto afterVariable = after.getVariable(dpt, beforeBinary, role);
+    if (beforeBinary != afterBinary || !beforeVariable || !afterVariable || !(*beforeVariable == *afterVariable)) {
+      std::cout << "Mismatch for " << sample.type << ": encoded " << BaseLib::HelperFunctions::getHexString(beforeBinary) << " before and " << BaseLib::HelperFunctions::getHexString(afterBinary)
+                << " after." << std::endl;
+      mismatches++;
+    }
+    //}}}
+
+    std::vector<uint8_t> binary = beforeBinary;
+    double encodeBefore = measure(iterations, [&] { sink += before.getDpt(sample.type, value, role).size(); });
+    double encodeAfter = measure(iterations, [&] { sink += after.getDpt(dpt, value, role).size(); });
+    double decodeBefore = measure(iterations, [&] { sink += (uint64_t)(bool)before.getVariable(sample.type, binary, role); });
+    double decodeAfter = measure(iterations, [&] { sink += (uint64_t)(bool)after.getVariable(dpt, binary, role); });
+    encodeBeforeSum += encodeBefore;
+    encodeAfterSum += encodeAfter;
+    decodeBeforeSum += decodeBefore;
+    decodeAfterSum += decodeAfter;
+
+    std::cout << std::left << std::setw(16) << sample.type << std::right << std::fixed << std::setprecision(1) << std::setw(16) << encodeBefore << std::setw(16) << encodeAfter << std::setw(16)
+              << decodeBefore << std::setw(16) << decodeAfter << std::endl;
+  }
+
+  std::cout << std::left << std::setw(16) << "Average" << std::right << std::fixed << std::setprecision(1) << std::setw(16) << encodeBeforeSum / samples.size() << std::setw(16)
+            << encodeAfterSum / samples.size() << std::setw(16) << decodeBeforeSum / samples.size() << std::setw(16) << decodeAfterSum / samples.size() << std::endl;
+  if (mismatches > 0) {
+    std::cout << mismatches << " DPTs differ between the converters." << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,547 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+/*
+ * Load test of the KNXnet/IP forwarder (KnxIpForwarder) with several simulated tunneling clients. Every client has its
+ * own UDP socket and tunneling connection. The test checks:
+ *   - Channel allocation: Every client gets a unique channel. With "-m", connections above the maximum number of clients
+ *     ("forwarderMaxClients") need to be rejected with E_NO_MORE_CONNECTIONS.
+ *   - Heartbeats: CONNECTIONSTATE_REQUESTs of every client are answered for its own channel. Requests for an unknown
+ *     channel are answered with E_CONNECTION_ID.
+ *   - Sequence counters: All clients send GroupValueWrites at the same time. Every request needs to be acknowledged with
+ *     the client's sequence counter. The first request is sent twice, the repetition must be acknowledged but not sent to
+ *     the bus again. Frames from the forwarder need to arrive with consecutive sequence counters per client.
+ *   - Fan-out: Every client gets one L_Data.con per request and an L_Data.ind for every frame the other clients sent
+ *     successfully.
+ *
+ * The telegrams are really sent to the bus, so use a group address no device listens to. Other telegrams to this group
+ * address during the test are counted as indications and make the fan-out check fail.
+ *
+ * Usage: knx-forwarder-load-test -h <forwarder IP> -g <group address> [-p <port>] [-c <clients>] [-n <telegrams per client>]
+ *                                [-m <forwarderMaxClients>]
+ *
+ * The exit code is 0 when all checks passed.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+enum class ServiceType : uint16_t {
+  CONNECT_REQUEST = 0x0205,
+  CONNECT_RESPONSE = 0x0206,
+  CONNECTIONSTATE_REQUEST = 0x0207,
+  CONNECTIONSTATE_RESPONSE = 0x0208,
+  DISCONNECT_REQUEST = 0x0209,
+  DISCONNECT_RESPONSE = 0x020A,
+  TUNNELING_REQUEST = 0x0420,
+  TUNNELING_ACK = 0x0421
+};
+
+const uint8_t E_NO_ERROR = 0x00;
+const uint8_t E_CONNECTION_ID = 0x21;
+const uint8_t E_NO_MORE_CONNECTIONS = 0x24;
+
+int64_t getTime() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t getTimeMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int32_t parseGroupAddress(const std::string &address) {
+  uint32_t main = 0;
+  uint32_t middle = 0;
+  uint32_t sub = 0;
+  char separator1 = 0;
+  char separator2 = 0;
+  if (sscanf(address.c_str(), "%u%c%u%c%u", &main, &separator1, &middle, &separator2, &sub) != 5 || separator1 != '/' || separator2 != '/' || main > 31 || middle > 7 || sub > 255) return -1;
+  return (int32_t)((main << 11) | (middle << 8) | sub);
+}
+
+struct Settings {
+  std::string host;
+  uint16_t port = 3671;
+  uint32_t clientCount = 8;
+  uint32_t telegramCount = 100;
+  int32_t groupAddress = -1;
+  int32_t maxClients = -1; //-1 if the rejection should not be checked
+};
+
+/**
+ * One tunneling client. All methods are called by one thread at a time.
+ */
+class SimulatedClient {
+ public:
+  struct Statistics {
+    uint64_t requestsSent = 0;
+    uint64_t requestsAcknowledged = 0;
+    uint64_t requestsLost = 0; //Not acknowledged after the repetition
+    uint64_t repetitions = 0;
+    uint64_t ackErrors = 0; //Wrong status or sequence counter
+    uint64_t confirmations = 0;
+    uint64_t negativeConfirmations = 0;
+    uint64_t indications = 0;
+    uint64_t incomingSequenceErrors = 0;
+    int64_t ackLatencySum = 0; //In microseconds
+    int64_t maxAckLatency = 0;
+  };
+
+  SimulatedClient(uint32_t index, const sockaddr_in &forwarderAddress, uint16_t groupAddress) : _index(index), _groupAddress(groupAddress) {
+    _socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (_socket == -1) throw std::runtime_error("Could not create socket: " + std::string(strerror(errno)));
+    //Connecting the UDP socket determines the local IP address used to reach the forwarder.
+    if (::connect(_socket, (const sockaddr *)&forwarderAddress, sizeof(forwarderAddress)) == -1) {
+      close(_socket);
+      throw std::runtime_error("Could not connect socket: " + std::string(strerror(errno)));
+    }
+    sockaddr_in localAddress{};
+    socklen_t localAddressSize = sizeof(localAddress);
+    if (getsockname(_socket, (sockaddr *)&localAddress, &localAddressSize) == -1) {
+      close(_socket);
+      throw std::runtime_error("Could not get local address: " + std::string(strerror(errno)));
+    }
+    _localIp = ntohl(localAddress.sin_addr.s_addr);
+    _localPort = ntohs(localAddress.sin_port);
+  }
+
+  ~SimulatedClient() {
+    if (_socket != -1) close(_socket);
+  }
+
+  uint32_t getIndex() const { return _index; }
+  uint8_t getChannelId() const { return _channelId; }
+  const Statistics &getStatistics() const { return _statistics; }
+
+  /**
+   * @return Returns the status of the CONNECT_RESPONSE or -1 on timeouts.
+   */
+  int32_t connect() {
+    std::vector<uint8_t> request{0x06, 0x10, 0x02, 0x05, 0x00, 0x1A};
+    appendHpai(request); //Control endpoint
+    appendHpai(request); //Data endpoint
+    request.insert(request.end(), {0x04, 0x04, 0x02, 0x00}); //Tunnel connection on the link layer
+    std::vector<uint8_t> response;
+    if (!sendAndWait(request, ServiceType::CONNECT_RESPONSE, -1, response) || response.size() < 8) return -1;
+    if (response[7] == E_NO_ERROR) {
+      _channelId = response[6];
+      _sequenceCounterOut = 0;
+      _sequenceCounterIn = 0;
+    }
+    return response[7];
+  }
+
+  /**
+   * @return Returns the status of the CONNECTIONSTATE_RESPONSE or -1 on timeouts.
+   */
+  int32_t checkConnectionState(uint8_t channelId) {
+    std::vector<uint8_t> request{0x06, 0x10, 0x02, 0x07, 0x00, 0x10, channelId, 0x00};
+    appendHpai(request);
+    std::vector<uint8_t> response;
+    if (!sendAndWait(request, ServiceType::CONNECTIONSTATE_RESPONSE, channelId, response) || response.size() < 8) return -1;
+    return response[7];
+  }
+
+  /**
+   * @return Returns the status of the DISCONNECT_RESPONSE or -1 on timeouts.
+   */
+  int32_t disconnect() {
+    std::vector<uint8_t> request{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, _channelId, 0x00};
+    appendHpai(request);
+    std::vector<uint8_t> response;
+    if (!sendAndWait(request, ServiceType::DISCONNECT_RESPONSE, _channelId, response) || response.size() < 8) return -1;
+    _channelId = 0;
+    return response[7];
+  }
+
+  /**
+   * Sends "count" GroupValueWrites. The first one is sent twice with the same sequence counter.
+   */
+  void sendTelegrams(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      //L_Data.req of a GroupValueWrite with one byte of data. The gateway sets the source address.
+      std::vector<uint8_t> request{0x06, 0x10, 0x04, 0x20, 0x00, 0x16, 0x04, _channelId, _sequenceCounterOut, 0x00,
+                                   0x11, 0x00, 0xBC, 0xE0, 0x00, 0x00, (uint8_t)(_groupAddress >> 8), (uint8_t)(_groupAddress & 0xFF), 0x02, 0x00, 0x80, (uint8_t)(i & 0xFF)};
+      bool acknowledged = sendTunnelingRequest(request);
+      if (acknowledged && i == 0) {
+        //A repeated request must be acknowledged again without sending it to the bus again (section 3.8.4 2.6).
+        _statistics.repetitions++;
+        sendTunnelingRequest(request);
+      }
+      _sequenceCounterOut++;
+    }
+  }
+
+  /**
+   * Acknowledges and counts frames from the forwarder until "endTime".
+   */
+  void receiveUntil(int64_t endTime) {
+    std::vector<uint8_t> packet;
+    while (true) {
+      int64_t timeout = endTime - getTime();
+      if (timeout <= 0 || !receive(packet, (int32_t)timeout)) return;
+      processPacket(packet);
+    }
+  }
+
+ private:
+  uint32_t _index = 0;
+  uint16_t _groupAddress = 0;
+  int32_t _socket = -1;
+  uint32_t _localIp = 0;
+  uint16_t _localPort = 0;
+  uint8_t _channelId = 0;
+  uint8_t _sequenceCounterOut = 0;
+  uint8_t _sequenceCounterIn = 0;
+  Statistics _statistics;
+
+  void appendHpai(std::vector<uint8_t> &data) {
+    data.insert(data.end(), {0x08, 0x01, (uint8_t)(_localIp >> 24), (uint8_t)((_localIp >> 16) & 0xFF), (uint8_t)((_localIp >> 8) & 0xFF), (uint8_t)(_localIp & 0xFF),
+                             (uint8_t)(_localPort >> 8), (uint8_t)(_localPort & 0xFF)});
+  }
+
+  static ServiceType getServiceType(const std::vector<uint8_t> &packet) {
+    return (ServiceType)((((uint16_t)packet[2]) << 8) | packet[3]);
+  }
+
+  void send(const std::vector<uint8_t> &packet) {
+    if (::send(_socket, packet.data(), packet.size(), 0) == -1) throw std::runtime_error("Could not send packet: " + std::string(strerror(errno)));
+  }
+
+  bool receive(std::vector<uint8_t> &packet, int32_t timeout) {
+    pollfd pollInfo{_socket, POLLIN, 0};
+    int32_t result = poll(&pollInfo, 1, timeout);
+    if (result == 0) return false;
+    if (result == -1) {
+      if (errno == EINTR) return false;
+      throw std::runtime_error("Error polling socket: " + std::string(strerror(errno)));
+    }
+    packet.resize(2048);
+    auto bytesReceived = recv(_socket, packet.data(), packet.size(), 0);
+    if (bytesReceived == -1) {
+      //ICMP errors of a closed port show up as ECONNREFUSED on connected UDP sockets.
+      if (errno == ECONNREFUSED || errno == EINTR) return false;
+      throw std::runtime_error("Error reading from socket: " + std::string(strerror(errno)));
+    }
+    packet.resize(bytesReceived);
+    return packet.size() >= 8 && packet[0] == 0x06 && packet[1] == 0x10;
+  }
+
+  /**
+   * Sends "request" and waits up to one second for a response of "responseType". When "channelId" is not -1, byte 6 of
+   * the response needs to match it. Tunneling requests received in the meantime are processed.
+   */
+  bool sendAndWait(const std::vector<uint8_t> &request, ServiceType responseType, int32_t channelId, std::vector<uint8_t> &response) {
+    send(request);
+    int64_t endTime = getTime() + 1000;
+    while (true) {
+      int64_t timeout = endTime - getTime();
+      if (timeout <= 0 || !receive(response, (int32_t)timeout)) {
+        if (getTime() >= endTime) return false;
+        continue;
+      }
+      if (getServiceType(response) == responseType && (channelId == -1 || response[6] == channelId)) return true;
+      processPacket(response);
+    }
+  }
+
+  /**
+   * Sends a TUNNELING_REQUEST and waits for its TUNNELING_ACK. Repeats the request once after one second like a real
+   * client (section 3.8.4 2.6).
+   */
+  bool sendTunnelingRequest(const std::vector<uint8_t> &request) {
+    uint8_t sequenceCounter = request[8];
+    for (int32_t attempt = 0; attempt < 2; attempt++) {
+      _statistics.requestsSent++;
+      int64_t startTime = getTimeMicroseconds();
+      send(request);
+      int64_t endTime = getTime() + 1000;
+      std::vector<uint8_t> packet;
+      while (true) {
+        int64_t timeout = endTime - getTime();
+        if (timeout <= 0) break;
+        if (!receive(packet, (int32_t)timeout)) continue;
+        if (getServiceType(packet) != ServiceType::TUNNELING_ACK || packet.size() < 10 || packet[7] != _channelId) {
+          processPacket(packet);
+          continue;
+        }
+        if (packet[8] != sequenceCounter || packet[9] != E_NO_ERROR) {
+          _statistics.ackErrors++;
+          continue;
+        }
+        int64_t latency = getTimeMicroseconds() - startTime;
+        _statistics.ackLatencySum += latency;
+        _statistics.maxAckLatency = std::max(_statistics.maxAckLatency, latency);
+        _statistics.requestsAcknowledged++;
+        return true;
+      }
+    }
+    _statistics.requestsLost++;
+    return false;
+  }
+
+  void processPacket(const std::vector<uint8_t> &packet) {
+    if (getServiceType(packet) != ServiceType::TUNNELING_REQUEST || packet.size() < 12 || packet[7] != _channelId) return;
+    uint8_t sequenceCounter = packet[8];
+    send(std::vector<uint8_t>{0x06, 0x10, 0x04, 0x21, 0x00, 0x0A, 0x04, _channelId, sequenceCounter, E_NO_ERROR});
+
+    //The forwarder counts its sequence counter per client, so there must not be gaps.
+    if (sequenceCounter != _sequenceCounterIn) _statistics.incomingSequenceErrors++;
+    _sequenceCounterIn = sequenceCounter + 1;
+
+    size_t cemiStart = 10;
+    size_t controlFieldPosition = cemiStart + 2 + packet[cemiStart + 1];
+    if (packet.size() < controlFieldPosition + 6) return;
+    uint16_t destinationAddress = (((uint16_t)packet[controlFieldPosition + 4]) << 8) | packet[controlFieldPosition + 5];
+    if (destinationAddress != _groupAddress) return;
+    uint8_t messageCode = packet[cemiStart];
+    if (messageCode == 0x2E) { //L_Data.con
+      _statistics.confirmations++;
+      if (packet[controlFieldPosition] & 0x01) _statistics.negativeConfirmations++;
+    } else if (messageCode == 0x29) _statistics.indications++; //L_Data.ind
+  }
+};
+
+typedef std::shared_ptr<SimulatedClient> PSimulatedClient;
+
+class LoadTest {
+ public:
+  explicit LoadTest(const Settings &settings) : _settings(settings) {
+    _forwarderAddress.sin_family = AF_INET;
+    _forwarderAddress.sin_port = htons(settings.port);
+    if (inet_pton(AF_INET, settings.host.c_str(), &_forwarderAddress.sin_addr) != 1) throw std::runtime_error("Invalid IP address: " + settings.host);
+  }
+
+  bool run() {
+    connectClients();
+    checkConnectionStates("Heartbeats after connecting");
+    checkUnknownChannel();
+    sendTelegrams();
+    checkConnectionStates("Heartbeats after sending");
+    disconnectClients();
+    std::cout << std::endl << (_failures == 0 ? "All checks passed." : std::to_string(_failures) + " checks failed.") << std::endl;
+    return _failures == 0;
+  }
+
+ private:
+  Settings _settings;
+  sockaddr_in _forwarderAddress{};
+  std::vector<PSimulatedClient> _clients; //Connected clients
+  uint32_t _failures = 0;
+
+  void check(bool condition, const std::string &message) {
+    std::cout << (condition ? "  OK:     " : "  FAILED: ") << message << std::endl;
+    if (!condition) _failures++;
+  }
+
+  void connectClients() {
+    std::cout << "Connecting " << _settings.clientCount << " clients..." << std::endl;
+    std::set<uint8_t> channelIds;
+    uint32_t rejected = 0;
+    uint32_t otherErrors = 0;
+    for (uint32_t i = 0; i < _settings.clientCount; i++) {
+      auto client = std::make_shared<SimulatedClient>(i, _forwarderAddress, (uint16_t)_settings.groupAddress);
+      int32_t status = client->connect();
+      if (status == E_NO_ERROR) {
+        channelIds.insert(client->getChannelId());
+        _clients.push_back(client);
+      } else if (status == E_NO_MORE_CONNECTIONS) rejected++;
+      else {
+        std::cout << "  Client " << i << ": " << (status == -1 ? std::string("No CONNECT_RESPONSE received.") : "CONNECT_RESPONSE with status " + std::to_string(status) + ".") << std::endl;
+        otherErrors++;
+      }
+    }
+    std::cout << "  " << _clients.size() << " clients connected, " << rejected << " rejected with E_NO_MORE_CONNECTIONS." << std::endl;
+
+    check(channelIds.size() == _clients.size() && channelIds.count(0) == 0, "Every client got a unique channel.");
+    check(otherErrors == 0, "No connection failed for other reasons than E_NO_MORE_CONNECTIONS.");
+    if (_settings.maxClients >= 0) {
+      uint32_t expectedClients = std::min(_settings.clientCount, (uint32_t)_settings.maxClients);
+      check(_clients.size() == expectedClients, "Exactly " + std::to_string(expectedClients) + " clients were accepted.");
+      check(rejected == _settings.clientCount - expectedClients, "Exactly " + std::to_string(_settings.clientCount - expectedClients) + " clients were rejected.");
+    } else check(rejected == 0, "No client was rejected.");
+  }
+
+  void checkConnectionStates(const std::string &name) {
+    std::cout << name << "..." << std::endl;
+    uint32_t errors = 0;
+    for (auto &client : _clients) {
+      int32_t status = client->checkConnectionState(client->getChannelId());
+      if (status != E_NO_ERROR) {
+        std::cout << "  Client " << client->getIndex() << " on channel " << (int32_t)client->getChannelId() << ": "
+                  << (status == -1 ? std::string("No CONNECTIONSTATE_RESPONSE received.") : "Status " + std::to_string(status) + ".") << std::endl;
+        errors++;
+      }
+    }
+    check(errors == 0, "Every client's CONNECTIONSTATE_REQUEST was answered with E_NO_ERROR.");
+  }
+
+  void checkUnknownChannel() {
+    if (_clients.empty()) return;
+    std::set<uint8_t> channelIds;
+    for (auto &client : _clients) {
+      channelIds.insert(client->getChannelId());
+    }
+    uint8_t unknownChannelId = 1;
+    while (channelIds.count(unknownChannelId) && unknownChannelId < 255) unknownChannelId++;
+    int32_t status = _clients.front()->checkConnectionState(unknownChannelId);
+    check(status == E_CONNECTION_ID, "CONNECTIONSTATE_REQUEST for unknown channel " + std::to_string(unknownChannelId) + " was answered with E_CONNECTION_ID.");
+  }
+
+  void sendTelegrams() {
+    if (_clients.empty()) return;
+    std::cout << "Sending " << _settings.telegramCount << " telegrams per client with " << _clients.size() << " clients at the same time..." << std::endl;
+
+    //Clients keep receiving until all clients are done and the last L_Data.con and L_Data.ind frames arrived.
+    std::atomic<uint32_t> clientsDone{0};
+    std::atomic<int64_t> endTime{0};
+    std::mutex errorMutex;
+    std::string error;
+    std::vector<std::thread> threads;
+    int64_t startTime = getTime();
+    for (auto &client : _clients) {
+      threads.emplace_back([&, client] {
+        try {
+          client->sendTelegrams(_settings.telegramCount);
+          if (++clientsDone == _clients.size()) endTime = getTime() + 3000;
+          while (endTime == 0) client->receiveUntil(getTime() + 100);
+          client->receiveUntil(endTime);
+        }
+        catch (const std::exception &ex) {
+          std::lock_guard<std::mutex> errorGuard(errorMutex);
+          error = ex.what();
+          if (++clientsDone == _clients.size()) endTime = getTime();
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    int64_t duration = getTime() - startTime - 3000;
+    if (!error.empty()) {
+      check(false, "Error in client thread: " + error);
+      return;
+    }
+
+    SimulatedClient::Statistics total;
+    uint64_t successfulConfirmations = 0;
+    for (auto &client : _clients) {
+      auto &statistics = client->getStatistics();
+      total.requestsSent += statistics.requestsSent;
+      total.requestsAcknowledged += statistics.requestsAcknowledged;
+      total.requestsLost += statistics.requestsLost;
+      total.repetitions += statistics.repetitions;
+      total.ackErrors += statistics.ackErrors;
+      total.confirmations += statistics.confirmations;
+      total.negativeConfirmations += statistics.negativeConfirmations;
+      total.indications += statistics.indications;
+      total.incomingSequenceErrors += statistics.incomingSequenceErrors;
+      total.ackLatencySum += statistics.ackLatencySum;
+      total.maxAckLatency = std::max(total.maxAckLatency, statistics.maxAckLatency);
+      successfulConfirmations += statistics.confirmations - statistics.negativeConfirmations;
+    }
+
+    std::cout << "  Requests sent:            " << total.requestsSent << " (" << total.repetitions << " deliberate repetitions)" << std::endl;
+    std::cout << "  Requests acknowledged:    " << total.requestsAcknowledged << std::endl;
+    std::cout << "  Average ACK latency:      " << (total.requestsAcknowledged > 0 ? total.ackLatencySum / (int64_t)total.requestsAcknowledged : 0) << " us" << std::endl;
+    std::cout << "  Maximum ACK latency:      " << total.maxAckLatency << " us" << std::endl;
+    std::cout << "  Throughput:               " << (duration > 0 ? (total.requestsAcknowledged * 1000) / duration : 0) << " telegrams/s" << std::endl;
+    std::cout << "  L_Data.con received:      " << total.confirmations << " (" << total.negativeConfirmations << " negative)" << std::endl;
+    std::cout << "  L_Data.ind received:      " << total.indications << std::endl;
+
+    uint64_t telegramsPerClient = _settings.telegramCount;
+    check(total.requestsLost == 0, "Every request was acknowledged.");
+    check(total.ackErrors == 0, "No TUNNELING_ACK had a wrong sequence counter or an error status.");
+    check(total.incomingSequenceErrors == 0, "The forwarder's sequence counters had no gaps.");
+
+    uint32_t confirmationErrors = 0;
+    uint32_t indicationErrors = 0;
+    for (auto &client : _clients) {
+      auto &statistics = client->getStatistics();
+      //The repeated first request must not be confirmed twice.
+      if (statistics.confirmations != telegramsPerClient) confirmationErrors++;
+      uint64_t expectedIndications = successfulConfirmations - (statistics.confirmations - statistics.negativeConfirmations);
+      if (statistics.indications != expectedIndications) {
+        std::cout << "  Client " << client->getIndex() << " received " << statistics.indications << " L_Data.ind instead of " << expectedIndications << "." << std::endl;
+        indicationErrors++;
+      }
+    }
+    check(confirmationErrors == 0, "Every client got exactly one L_Data.con per telegram.");
+    check(total.negativeConfirmations == 0, "No L_Data.con reported an error.");
+    check(indicationErrors == 0, "Every client got an L_Data.ind for every telegram the other clients sent successfully.");
+  }
+
+  void disconnectClients() {
+    std::cout << "Disconnecting clients..." << std::endl;
+    uint32_t errors = 0;
+    for (auto &client : _clients) {
+      if (client->disconnect() != E_NO_ERROR) errors++;
+    }
+    check(errors == 0, "Every DISCONNECT_REQUEST was answered with E_NO_ERROR.");
+  }
+};
+
+void printUsage(const char *name) {
+  std::cout << "Usage: " << name << " -h <forwarder IP> -g <group address> [-p <port>] [-c <clients>] [-n <telegrams per client>] [-m <forwarderMaxClients>]" << std::endl;
+  std::cout << "  -h  IP address of the forwarder (\"forwarderListenIp\")" << std::endl;
+  std::cout << "  -g  Group address the telegrams are sent to, e. g. 31/7/255. The telegrams are sent to the bus." << std::endl;
+  std::cout << "  -p  Port of the forwarder (\"forwarderListenPort\"). Default: 3671" << std::endl;
+  std::cout << "  -c  Number of simulated clients. Default: 8" << std::endl;
+  std::cout << "  -n  Number of telegrams each client sends. Default: 100" << std::endl;
+  std::cout << "  -m  The forwarder's \"forwarderMaxClients\". When set, clients above it need to be rejected." << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+  Settings settings;
+  int32_t option = 0;
+  while ((option = getopt(argc, argv, "h:g:p:c:n:m:")) != -1) {
+    switch (option) {
+      case 'h':settings.host = optarg;
+        break;
+      case 'g':settings.groupAddress = parseGroupAddress(optarg);
+        break;
+      case 'p':settings.port = (uint16_t)std::stoul(optarg);
+        break;
+      case 'c':settings.clientCount = (uint32_t)std::stoul(optarg);
+        break;
+      case 'n':settings.telegramCount = (uint32_t)std::stoul(optarg);
+        break;
+      case 'm':settings.maxClients = std::stoi(optarg);
+        break;
+      default:printUsage(argv[0]);
+        return 2;
+    }
+  }
+  if (settings.host.empty() || settings.groupAddress == -1 || settings.clientCount == 0) {
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  try {
+    LoadTest loadTest(settings);
+    return loadTest.run() ? 0 : 1;
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+  }
+  return 1;
+}
@@ -0,0 +1,221 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+/*
+ * Loopback test of the frame extraction of KNXnet/IP over TCP (TcpFrameReader, used by TcpInterface::readSocket()). A
+ * stand-in gateway on 127.0.0.1 writes frames to a non-blocking client socket the way a real TCP stream can deliver them:
+ * split at arbitrary positions, several frames in one segment and frames larger than one receive buffer. It also checks
+ * that invalid headers and closed connections are detected.
+ *
+ * Usage: knx-tcp-framing-test
+ *
+ * The exit code is 0 when all checks passed.
+ */
+
+#include "PhysicalInterfaces/TcpFrameReader.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Knx::TcpFrameReader;
+
+uint32_t failures = 0;
+
+void check(bool condition, const std::string &message) {
+  std::cout << (condition ? "  OK:     " : "  FAILED: ") << message << std::endl;
+  if (!condition) failures++;
+}
+
+/**
+ * Creates a KNXnet/IP frame of "size" bytes with a recognizable body.
+ */
+std::vector<uint8_t> createFrame(uint16_t serviceType, uint16_t size, uint8_t seed) {
+  std::vector<uint8_t> frame{0x06, 0x10, (uint8_t)(serviceType >> 8), (uint8_t)(serviceType & 0xFF), (uint8_t)(size >> 8), (uint8_t)(size & 0xFF)};
+  for (uint32_t i = 6; i < size; i++) {
+    frame.push_back((uint8_t)(seed + i));
+  }
+  return frame;
+}
+
+/**
+ * A connected pair of loopback TCP sockets. "gateway" is blocking, "client" is non-blocking like the interface's socket.
+ */
+class Connection {
+ public:
+  Connection() {
+    int32_t listenDescriptor = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenDescriptor == -1) throw std::runtime_error("Could not create socket: " + std::string(strerror(errno)));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressSize = sizeof(address);
+    if (bind(listenDescriptor, (sockaddr *)&address, addressSize) == -1 || listen(listenDescriptor, 1) == -1 || getsockname(listenDescriptor, (sockaddr *)&address, &addressSize) == -1) {
+      close(listenDescriptor);
+      throw std::runtime_error("Could not listen on loopback: " + std::string(strerror(errno)));
+    }
+
+    client = socket(AF_INET, SOCK_STREAM, 0);
+    if (client == -1 || connect(client, (sockaddr *)&address, sizeof(address)) == -1) {
+      close(listenDescriptor);
+      throw std::runtime_error("Could not connect: " + std::string(strerror(errno)));
+    }
+    gateway = accept(listenDescriptor, nullptr, nullptr);
+    close(listenDescriptor);
+    if (gateway == -1) throw std::runtime_error("Could not accept connection: " + std::string(strerror(errno)));
+
+    //Send every write as its own segment, so splits reach the client as they are written.
+    int32_t noDelay = 1;
+    setsockopt(gateway, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+  }
+
+  ~Connection() {
+    if (gateway != -1) close(gateway);
+    if (client != -1) close(client);
+  }
+
+  void write(const std::vector<uint8_t> &data, size_t offset, size_t length) {
+    while (length > 0) {
+      auto bytesWritten = send(gateway, data.data() + offset, length, 0);
+      if (bytesWritten == -1) throw std::runtime_error("Could not write: " + std::string(strerror(errno)));
+      offset += bytesWritten;
+      length -= bytesWritten;
+    }
+  }
+
+  void closeGateway() {
+    close(gateway);
+    gateway = -1;
+  }
+
+  int32_t gateway = -1;
+  int32_t client = -1;
+};
+
+/**
+ * Reads frames like the reactor: wait until the socket is readable, then call read() until it needs more data.
+ *
+ * @return Returns the last result other than "frame" and "needMoreData" or "needMoreData" on timeouts.
+ */
+TcpFrameReader::Result readFrames(TcpFrameReader &reader, int32_t descriptor, size_t expectedFrames, std::vector<std::vector<uint8_t>> &frames) {
+  auto endTime = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (frames.size() < expectedFrames || expectedFrames == 0) {
+    auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - std::chrono::steady_clock::now()).count();
+    if (timeout <= 0) return TcpFrameReader::Result::needMoreData;
+    pollfd pollInfo{descriptor, POLLIN, 0};
+    if (poll(&pollInfo, 1, (int32_t)timeout) <= 0) continue;
+    while (true) {
+      std::vector<uint8_t> frame;
+      auto result = reader.read(descriptor, frame);
+      if (result == TcpFrameReader::Result::frame) frames.push_back(std::move(frame));
+      else if (result == TcpFrameReader::Result::needMoreData) break;
+      else return result;
+    }
+  }
+  return TcpFrameReader::Result::frame;
+}
+
+/**
+ * Writes "frames" as one stream split into the given chunk sizes (the rest in one chunk) and checks that exactly these
+ * frames are read.
+ */
+void testStream(const std::string &name, const std::vector<std::vector<uint8_t>> &frames, const std::vector<size_t> &chunkSizes) {
+  Connection connection;
+  TcpFrameReader reader;
+  std::vector<uint8_t> stream;
+  for (auto &frame : frames) {
+    stream.insert(stream.end(), frame.begin(), frame.end());
+  }
+
+  std::thread writer([&] {
+    size_t offset = 0;
+    for (auto chunkSize : chunkSizes) {
+      if (offset >= stream.size()) break;
+      if (chunkSize > stream.size() - offset) chunkSize = stream.size() - offset;
+      connection.write(stream, offset, chunkSize);
+      offset += chunkSize;
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    if (offset < stream.size()) connection.write(stream, offset, stream.size() - offset);
+  });
+
+  std::vector<std::vector<uint8_t>> receivedFrames;
+  auto result = readFrames(reader, connection.client, frames.size(), receivedFrames);
+  writer.join();
+  check(result == TcpFrameReader::Result::frame && receivedFrames == frames && reader.getBuffer().empty(), name);
+}
+
+}
+
+int main() {
+  try {
+    std::cout << "Testing TcpFrameReader over loopback TCP..." << std::endl;
+
+    auto tunnelingRequest = createFrame(0x0420, 21, 1);
+    auto connectionStateResponse = createFrame(0x0208, 8, 2);
+    auto configRequest = createFrame(0x0310, 30, 3);
+    auto largeFrame = createFrame(0x0420, 5000, 4); //Larger than one receive buffer of 2048 bytes
+
+    testStream("One frame in one segment", {tunnelingRequest}, {});
+    testStream("One frame split into single bytes", {tunnelingRequest}, std::vector<size_t>(tunnelingRequest.size(), 1));
+    testStream("Frame split inside the header", {tunnelingRequest, connectionStateResponse}, {3, 4, 20});
+    testStream("Several frames in one segment", {tunnelingRequest, connectionStateResponse, configRequest, tunnelingRequest}, {});
+    testStream("Frame ending in the middle of a segment", {connectionStateResponse, tunnelingRequest, configRequest}, {10, 30});
+    testStream("Frame larger than the receive buffer", {tunnelingRequest, largeFrame, connectionStateResponse}, {1000, 2048, 10});
+
+    {
+      Connection connection;
+      TcpFrameReader reader;
+      auto invalidStream = tunnelingRequest;
+      invalidStream.insert(invalidStream.end(), {0x07, 0x10, 0x04, 0x20, 0x00, 0x08, 0x00, 0x00});
+      connection.write(invalidStream, 0, invalidStream.size());
+      std::vector<std::vector<uint8_t>> frames;
+      auto result = readFrames(reader, connection.client, 0, frames);
+      check(result == TcpFrameReader::Result::invalidData && frames.size() == 1, "Invalid header after a valid frame is detected");
+    }
+
+    {
+      Connection connection;
+      TcpFrameReader reader;
+      auto invalidStream = createFrame(0x0420, 21, 1);
+      invalidStream.at(5) = 3; //Total length smaller than the header
+      connection.write(invalidStream, 0, invalidStream.size());
+      std::vector<std::vector<uint8_t>> frames;
+      auto result = readFrames(reader, connection.client, 0, frames);
+      check(result == TcpFrameReader::Result::invalidData && frames.empty(), "Total length smaller than the header is detected");
+    }
+
+    {
+      Connection connection;
+      TcpFrameReader reader;
+      connection.write(tunnelingRequest, 0, 10);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      connection.closeGateway();
+      std::vector<std::vector<uint8_t>> frames;
+      auto result = readFrames(reader, connection.client, 0, frames);
+      check(result == TcpFrameReader::Result::closed && frames.empty(), "Connection closed in the middle of a frame is detected");
+    }
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return 1;
+  }
+
+  std::cout << std::endl << (failures == 0 ? "All checks passed." : std::to_string(failures) + " checks failed.") << std::endl;
+  return failures == 0 ? 0 : 1;
+}
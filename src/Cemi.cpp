@@ -30,23 +30,28 @@ Cemi::Cemi(Operation operation, uint16_t sourceAddress, uint16_t destinationAddr
   }
 }
 
-Cemi::Cemi(const std::vector<uint8_t> &binaryPacket) {
-  if (binaryPacket.empty()) throw InvalidKnxPacketException("Too small packet.");
+Cemi::Cemi(const uint8_t *binaryPacket, size_t size) {
+  if (size == 0) throw InvalidKnxPacketException("Too small packet.");
   //Message always starts with the message code (section 4.1.3.1 of chapter 3.6.3)
   _messageCode = binaryPacket[0];
-  if (_messageCode == 0x11 || _messageCode == 0x29) {
-    if (binaryPacket.size() >= 11) {
-      int32_t additionalInformationLength = binaryPacket[1]; //Always there (section 4.1.4.1 of chapter 3.6.3), except for local device management. Can be ignored, if we are not interested.
-      if ((signed)binaryPacket.size() < 11 + additionalInformationLength) throw InvalidKnxPacketException("Too small packet.");
-      _sourceAddress = (((uint16_t)(uint8_t)binaryPacket[4 + additionalInformationLength]) << 8) | (uint8_t)binaryPacket[5 + additionalInformationLength];
-      _destinationAddress = (((uint16_t)(uint8_t)binaryPacket[6 + additionalInformationLength]) << 8) | (uint8_t)binaryPacket[7 + additionalInformationLength];
-      _operation = (Operation)(((binaryPacket[9 + additionalInformationLength] & 0x03) << 2) | ((binaryPacket[10 + additionalInformationLength] & 0xC0) >> 6));
-      if ((signed)binaryPacket.size() == 11 + additionalInformationLength) _payload.push_back((uint8_t)(binaryPacket.at(10 + additionalInformationLength) & 0x3F));
-      else _payload.insert(_payload.end(), binaryPacket.begin() + 11 + additionalInformationLength, binaryPacket.end());
+  if (isDataFrame(_messageCode)) {
+    if (size >= 11) {
+      size_t additionalInformationLength = binaryPacket[1]; //Always there (section 4.1.4.1 of chapter 3.6.3), except for local device management. Can be ignored, if we are not interested.
+      if (size < 11 + additionalInformationLength) throw InvalidKnxPacketException("Too small packet.");
+      const uint8_t *data = binaryPacket + additionalInformationLength;
+      _priority = (Priority)((data[2] >> 2) & 0x03);
+      _repetition = !(data[2] & 0x20);
+      _groupAddressed = data[3] & 0x80;
+      _hopCount = (data[3] >> 4) & 0x07;
+      _sourceAddress = (((uint16_t)data[4]) << 8) | data[5];
+      _destinationAddress = (((uint16_t)data[6]) << 8) | data[7];
+      _operation = (Operation)(((data[9] & 0x03) << 2) | ((data[10] & 0xC0) >> 6));
+      if (size == 11 + additionalInformationLength) _payload.assign(1, (uint8_t)(data[10] & 0x3F));
+      else _payload.assign(data + 11, binaryPacket + size);
     }
   }
 
-  _rawPacket = binaryPacket;
+  _rawPacket.assign(binaryPacket, binaryPacket + size);
 }
 
 BaseLib::PVariable Cemi::toVariable() {
@@ -89,18 +94,79 @@ std::string Cemi::getOperationString() {
   return "";
 }
 
+std::string Cemi::getPriorityString(Priority priority) {
+  switch (priority) {
+    case Priority::system:return "system";
+    case Priority::normal:return "normal";
+    case Priority::urgent:return "urgent";
+    case Priority::low:return "low";
+  }
+
+  return "";
+}
+
+bool Cemi::parsePriority(const std::string &priorityString, Priority &priority) {
+  if (priorityString == "system") priority = Priority::system;
+  else if (priorityString == "normal") priority = Priority::normal;
+  else if (priorityString == "urgent") priority = Priority::urgent;
+  else if (priorityString == "low") priority = Priority::low;
+  else return false;
+  return true;
+}
+
+size_t Cemi::getRawControlFieldPosition() {
+  if (_rawPacket.size() < 11 || !isDataFrame(_messageCode) || _rawPacket.size() < 11u + _rawPacket[1]) return 0;
+  return 2 + _rawPacket[1];
+}
+
+void Cemi::setMessageCode(uint8_t value) {
+  if (isDataFrame(value) && getRawControlFieldPosition() != 0) _rawPacket[0] = value;
+  else _rawPacket.clear();
+  _messageCode = value;
+}
+
+void Cemi::setSourceAddress(uint16_t value) {
+  auto position = getRawControlFieldPosition();
+  if (position != 0) {
+    _rawPacket[position + 2] = (uint8_t)(value >> 8);
+    _rawPacket[position + 3] = (uint8_t)(value & 0xFF);
+  } else _rawPacket.clear();
+  _sourceAddress = value;
+}
+
+void Cemi::setHopCount(uint8_t value) {
+  value &= 0x07;
+  auto position = getRawControlFieldPosition();
+  if (position != 0) _rawPacket[position + 1] = (uint8_t)((_rawPacket[position + 1] & 0x8F) | (value << 4));
+  else _rawPacket.clear();
+  _hopCount = value;
+}
+
+void Cemi::setConfirmationError(bool value) {
+  auto position = getRawControlFieldPosition();
+  if (position != 0) _rawPacket[position] = (uint8_t)((_rawPacket[position] & 0xFE) | (value ? 1 : 0));
+  else _rawPacket.clear();
+  _confirmationError = value;
+}
+
 std::vector<uint8_t> Cemi::getBinary() {
-  if (!_rawPacket.empty()) return _rawPacket;
+  if (_rawPacket.empty()) appendBinary(_rawPacket);
+  return _rawPacket;
+}
+
+void Cemi::appendBinary(std::vector<uint8_t> &packet) {
+  if (!_rawPacket.empty()) {
+    packet.insert(packet.end(), _rawPacket.begin(), _rawPacket.end());
+    return;
+  }
 
-  if (_operation == Operation::unset) return std::vector<uint8_t>();
+  if (_operation == Operation::unset) return;
 
-  std::vector<uint8_t> packet;
-  uint32_t size = 11 + (_payloadFitsInFirstByte ? 0 : (uint32_t)_payload.size());
-  packet.reserve(size);
+  packet.reserve(packet.size() + 11 + (_payloadFitsInFirstByte ? 0 : _payload.size()));
 
   //{{{ cEMI
   /*
-  Controlfield 1: 0xbc (section 4.1.5.3.2 of chapter 3.6.3)
+  Controlfield 1: 0xb0 | (priority << 2) (section 4.1.5.3.2 of chapter 3.6.3)
       1... .... = Frametype: 1 (0: extended frame, 1: standard frame)
       .0.. .... = Always 0
       ..1. .... = Repeat: 0 (0: repeat frame on medium if error, 1: do not repeat)
@@ -116,8 +182,8 @@ std::vector<uint8_t> Cemi::getBinary() {
 
   packet.push_back(_messageCode); //Message code (L_Data.req)
   packet.push_back(0); //Additional information length
-  packet.push_back((char)(uint8_t)0xB4); //Controlfield 1
-  packet.push_back((char)(uint8_t)0xE0); //Controlfiled 2
+  packet.push_back((char)(uint8_t)(0xB0 | ((uint8_t)_priority << 2) | (_confirmationError ? 1 : 0))); //Controlfield 1
+  packet.push_back((char)(uint8_t)((_groupAddressed ? 0x80 : 0) | (_hopCount << 4))); //Controlfiled 2
   packet.push_back((char)(uint8_t)(_sourceAddress >> 8));
   packet.push_back((char)(uint8_t)(_sourceAddress & 0xFF));
   packet.push_back((char)(uint8_t)(_destinationAddress >> 8));
@@ -130,9 +196,6 @@ std::vector<uint8_t> Cemi::getBinary() {
     if (!_payload.empty()) packet.insert(packet.end(), _payload.begin(), _payload.end());
   }
   //}}}
-
-  _rawPacket = std::move(packet);
-  return _rawPacket;
 }
 
 std::string Cemi::getFormattedPhysicalAddress(uint16_t address) {
@@ -41,8 +41,19 @@ class Cemi : public BaseLib::Systems::Packet {
     escape = 0x0F //APCI is defined by 6 following bits
   };
 
+  /**
+   * The frame priority as encoded in bits 2 and 3 of control field 1.
+   */
+  enum class Priority : uint8_t {
+    system = 0,
+    normal = 1,
+    urgent = 2,
+    low = 3
+  };
+
   Cemi() = default;
-  explicit Cemi(const std::vector<uint8_t> &binaryPacket);
+  explicit Cemi(const std::vector<uint8_t> &binaryPacket) : Cemi(binaryPacket.data(), binaryPacket.size()) {}
+  Cemi(const uint8_t *binaryPacket, size_t size);
   Cemi(Operation operation, uint16_t sourceAddress, uint16_t destinationAddress);
   Cemi(Operation operation, uint16_t sourceAddress, uint16_t destinationAddress, bool payloadFitsInFirstByte, std::vector<uint8_t> &payload);
   Cemi(Operation operation, uint16_t sourceAddress, uint16_t destinationAddress, uint8_t tpduSequenceNumber, bool payloadFitsInFirstByte, std::vector<uint8_t> &payload);
@@ -51,12 +62,45 @@ class Cemi : public BaseLib::Systems::Packet {
   BaseLib::PVariable toVariable() override;
 
   std::vector<uint8_t> getBinary();
+
+  /**
+   * Appends the binary packet to "buffer" without caching it.
+   */
+  void appendBinary(std::vector<uint8_t> &buffer);
   uint8_t getMessageCode() { return _messageCode; }
+
+  /**
+   * Changes the message code. Received L_Data frames are modified in place, so fields that are not parsed (like the
+   * address type, the hop count or the TPCI) are kept. This way frames of forwarder clients can be changed safely.
+   */
+  void setMessageCode(uint8_t value);
   uint16_t getSourceAddress() { return _sourceAddress; }
-  void setSourceAddress(uint16_t value) { _rawPacket.clear(); _sourceAddress = value; }
+  void setSourceAddress(uint16_t value);
+
+  /**
+   * Sets the confirm flag of an L_Data.con. It is set when the frame could not be sent.
+   */
+  void setConfirmationError(bool value);
+
+  /**
+   * The routing counter of control field 2. Frames with a hop count of 0 must not be routed, 7 is never decremented.
+   */
+  uint8_t getHopCount() { return _hopCount; }
+  void setHopCount(uint8_t value);
+
+  /**
+   * Returns true for received frames that were repeated on the bus, because the first transmission was not acknowledged
+   * (the repeat flag in control field 1 is 0).
+   */
+  bool isRepetition() { return _repetition; }
+  bool isGroupAddressed() { return _groupAddressed; }
   uint16_t getDestinationAddress() { return _destinationAddress; }
   Operation getOperation() { return _operation; }
   std::string getOperationString();
+  Priority getPriority() { return _priority; }
+  void setPriority(Priority value) { _rawPacket.clear(); _priority = value; }
+  static std::string getPriorityString(Priority priority);
+  static bool parsePriority(const std::string &priorityString, Priority &priority);
   static std::string getFormattedPhysicalAddress(uint16_t address);
   static uint16_t parsePhysicalAddress(const std::string &address);
   std::string getFormattedSourceAddress() { return getFormattedPhysicalAddress(_sourceAddress); }
@@ -67,6 +111,11 @@ class Cemi : public BaseLib::Systems::Packet {
  protected:
   std::vector<uint8_t> _rawPacket;
   uint8_t _messageCode = 0;
+  Priority _priority = Priority::normal;
+  bool _confirmationError = false;
+  uint8_t _hopCount = 6;
+  bool _repetition = false;
+  bool _groupAddressed = true;
   Operation _operation = Operation::unset;
   uint16_t _sourceAddress = 0;
   uint16_t _destinationAddress = 0;
@@ -75,6 +124,13 @@ class Cemi : public BaseLib::Systems::Packet {
   uint8_t _tpduSequenceNumber = 0;
   bool _payloadFitsInFirstByte = false;
   std::vector<uint8_t> _payload;
+
+  static bool isDataFrame(uint8_t messageCode) { return messageCode == 0x11 || messageCode == 0x29 || messageCode == 0x2E; }
+
+  /**
+   * Returns the position of control field 1 in "_rawPacket" or 0 if "_rawPacket" doesn't contain a parsed L_Data frame.
+   */
+  size_t getRawControlFieldPosition();
 };
 
 typedef std::shared_ptr<Cemi> PCemi;
@@ -10,17 +10,120 @@
 using namespace BaseLib;
 
 namespace Knx {
+
+/**
+ * Converts between KNX datapoint types and Homegear variables. The converter holds no state besides the ANSI conversion
+ * tables, which are not modified after construction. So a single instance (Gd::dptConverter) is shared by all peers
+ * and can be used from any thread.
+ */
 class DptConverter {
  public:
+  /**
+   * Numeric identity of a datapoint type. "DPT-9" is {9, 0}, "DPST-9-1" is {9, 1}. "main" is 0 for invalid types.
+   */
+  struct Dpt {
+    uint16_t main = 0;
+    uint16_t sub = 0;
+  };
+
   DptConverter(BaseLib::SharedObjects *baseLib);
   virtual ~DptConverter();
 
-  bool fitsInFirstByte(const std::string &type);
-  std::vector<uint8_t> getDpt(const std::string &type, PVariable &value, const BaseLib::Role &role);
-  PVariable getVariable(const std::string &type, std::vector<uint8_t> &value, const BaseLib::Role &role);
+  /**
+   * Parses a type string like "DPT-9" or "DPST-9-1". Parse types once and use the overloads taking a Dpt where
+   * possible.
+   */
+  static Dpt parseDpt(const std::string &type);
+
+  bool fitsInFirstByte(const std::string &type) const;
+  bool fitsInFirstByte(const Dpt &dpt) const;
+  std::vector<uint8_t> getDpt(const std::string &type, PVariable &value, const BaseLib::Role &role) const;
+  std::vector<uint8_t> getDpt(const Dpt &dpt, PVariable &value, const BaseLib::Role &role) const;
+  PVariable getVariable(const std::string &type, const std::vector<uint8_t> &value, const BaseLib::Role &role) const;
+  PVariable getVariable(const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role) const;
  protected:
+  typedef void (*Encoder)(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  typedef PVariable (*Decoder)(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+
+  struct Codec {
+    Encoder encode = nullptr;
+    Decoder decode = nullptr;
+    bool fitsInFirstByte = false;
+  };
+
+  static constexpr uint16_t maxMainType = 251;
+
   BaseLib::SharedObjects *_bl = nullptr;
   std::shared_ptr<BaseLib::Ansi> _ansi;
+
+  static constexpr std::array<Codec, maxMainType + 1> createCodecs();
+  static const Codec *getCodec(const Dpt &dpt);
+  static bool checkSize(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, size_t size);
+  static double scale(const BaseLib::Role &role, double value);
+
+  //{{{ Encoders
+  static void encodeBoolean(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  template<uint8_t mask> static void encodeMasked(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  static void encodeDpt4(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  static void encodeDpt5(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  static void encodeDpt9(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  static void encodeDpt14(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  static void encodeDpt16(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  template<uint32_t size> static void encodeInteger(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  template<uint32_t size> static void encodeInteger64(const DptConverter &converter, const Dpt &dpt, const PVariable &value, std::vector<uint8_t> &result);
+  //}}}
+
+  //{{{ Decoders
+  static PVariable decodeBoolean(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  template<uint8_t mask> static PVariable decodeMasked(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  static PVariable decodeDpt4(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  static PVariable decodeDpt5(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  static PVariable decodeDpt6(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  static PVariable decodeDpt9(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  static PVariable decodeDpt14(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  static PVariable decodeDpt16(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  template<typename T, uint32_t size> static PVariable decodeInteger(const DptConverter &converter, const Dpt &dpt, const std::vector<uint8_t> &value, const BaseLib::Role &role);
+  //}}}
+};
+
+/**
+ * Decodes the payload of one telegram for all parameters receiving it. Every distinct combination of type, role and bit
+ * range is only decoded once and the resulting variable is shared, so it must not be modified. Not thread-safe, use one
+ * instance per telegram.
+ */
+class TelegramDecoder {
+ public:
+  explicit TelegramDecoder(const std::vector<uint8_t> &payload) : _payload(payload) {}
+
+  const std::vector<uint8_t> &getPayload() const { return _payload; }
+
+  /**
+   * Decodes the whole payload.
+   */
+  PVariable getVariable(const DptConverter::Dpt &dpt, const BaseLib::Role &role);
+
+  /**
+   * Decodes part of the payload as used by grouped parameters.
+   *
+   * @param data Returns the extracted bits.
+   */
+  PVariable getVariable(const DptConverter::Dpt &dpt, const BaseLib::Role &role, uint32_t bitPosition, uint32_t bitSize, std::vector<uint8_t> &data);
+ private:
+  struct Entry {
+    DptConverter::Dpt dpt;
+    uint32_t bitPosition = 0;
+    uint32_t bitSize = 0; //0 for the whole payload
+    bool invert = false;
+    bool scale = false;
+    BaseLib::Role::ScaleInfo scaleInfo;
+    std::vector<uint8_t> data;
+    PVariable value;
+  };
+
+  const std::vector<uint8_t> &_payload;
+  std::vector<Entry> _entries; //There are only a few distinct types per group address, so a linear search is fastest.
+
+  Entry *find(const DptConverter::Dpt &dpt, const BaseLib::Role &role, uint32_t bitPosition, uint32_t bitSize);
 };
 
 }
@@ -7,5 +7,9 @@ BaseLib::SharedObjects *Gd::bl = nullptr;
 Knx *Gd::family = nullptr;
 std::map<std::string, std::shared_ptr<MainInterface>> Gd::physicalInterfaces;
 std::shared_ptr<MainInterface> Gd::defaultPhysicalInterface;
+std::map<std::string, std::shared_ptr<KnxIpForwarder>> Gd::forwarders;
+std::shared_ptr<LineCoupler> Gd::lineCoupler;
+std::shared_ptr<Reactor> Gd::reactor;
+std::shared_ptr<const DptConverter> Gd::dptConverter;
 BaseLib::Output Gd::out;
 }
@@ -9,9 +9,14 @@
 #include <homegear-base/BaseLib.h>
 #include "Knx.h"
 #include "PhysicalInterfaces/MainInterface.h"
+#include "Reactor.h"
+#include "DptConverter.h"
 
 namespace Knx {
 
+class KnxIpForwarder;
+class LineCoupler;
+
 class Gd {
  public:
   virtual ~Gd();
@@ -20,6 +25,10 @@ class Gd {
   static Knx *family;
   static std::map<std::string, std::shared_ptr<MainInterface>> physicalInterfaces;
   static std::shared_ptr<MainInterface> defaultPhysicalInterface;
+  static std::map<std::string, std::shared_ptr<KnxIpForwarder>> forwarders; //By interface ID
+  static std::shared_ptr<LineCoupler> lineCoupler; //nullptr when no routes are configured
+  static std::shared_ptr<Reactor> reactor;
+  static std::shared_ptr<const DptConverter> dptConverter;
   static BaseLib::Output out;
  private:
   Gd();
@@ -0,0 +1,50 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "GroupAddressFilter.h"
+
+namespace Knx {
+
+int32_t GroupAddressFilter::parseGroupAddress(const std::string &address) {
+  auto addressParts = BaseLib::HelperFunctions::splitAll(address, '/');
+  if (addressParts.size() != 3) return -1;
+  for (auto &addressPart : addressParts) {
+    BaseLib::HelperFunctions::trim(addressPart);
+    if (!BaseLib::Math::isNumber(addressPart, false)) return -1;
+  }
+  int32_t mainGroup = BaseLib::Math::getNumber(addressParts.at(0), false);
+  int32_t middleGroup = BaseLib::Math::getNumber(addressParts.at(1), false);
+  int32_t subGroup = BaseLib::Math::getNumber(addressParts.at(2), false);
+  if (mainGroup < 0 || mainGroup > 31 || middleGroup < 0 || middleGroup > 7 || subGroup < 0 || subGroup > 255) return -1;
+  return (mainGroup << 11) | (middleGroup << 8) | subGroup;
+}
+
+bool GroupAddressFilter::add(const std::string &filter) {
+  bool valid = true;
+  auto entries = BaseLib::HelperFunctions::splitAll(filter, ',');
+  for (auto &entry : entries) {
+    BaseLib::HelperFunctions::trim(entry);
+    if (entry.empty()) continue;
+    if (entry == "*") {
+      add(0, 0xFFFF);
+      continue;
+    }
+
+    auto range = BaseLib::HelperFunctions::splitFirst(entry, '-');
+    int32_t firstGroupAddress = parseGroupAddress(range.first);
+    int32_t lastGroupAddress = range.second.empty() ? firstGroupAddress : parseGroupAddress(range.second);
+    if (firstGroupAddress == -1 || lastGroupAddress == -1 || lastGroupAddress < firstGroupAddress) {
+      valid = false;
+      continue;
+    }
+    add((uint16_t)firstGroupAddress, (uint16_t)lastGroupAddress);
+  }
+  return valid;
+}
+
+void GroupAddressFilter::add(uint16_t firstGroupAddress, uint16_t lastGroupAddress) {
+  for (uint32_t groupAddress = firstGroupAddress; groupAddress <= lastGroupAddress; groupAddress++) {
+    _bitmap.set(groupAddress);
+  }
+}
+
+}
@@ -0,0 +1,41 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef GROUPADDRESSFILTER_H_
+#define GROUPADDRESSFILTER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <bitset>
+
+namespace Knx {
+
+/**
+ * Set of group addresses with one bit per address, so a lookup is a single memory access. It is filled once and only read
+ * afterwards, so it can be used from any thread without locking.
+ */
+class GroupAddressFilter {
+ public:
+  GroupAddressFilter() = default;
+  virtual ~GroupAddressFilter() = default;
+
+  /**
+   * Adds a comma separated list of group addresses ("1/2/3") and ranges ("1/2/0-1/2/255"). "*" adds all group addresses.
+   *
+   * @return Returns false when an entry is invalid. All valid entries are added.
+   */
+  bool add(const std::string &filter);
+  void add(uint16_t firstGroupAddress, uint16_t lastGroupAddress);
+  bool contains(uint16_t groupAddress) const { return _bitmap[groupAddress]; }
+  size_t count() const { return _bitmap.count(); }
+ private:
+  std::bitset<65536> _bitmap;
+
+  /**
+   * @return Returns -1 if the address is invalid.
+   */
+  static int32_t parseGroupAddress(const std::string &address);
+};
+
+}
+
+#endif
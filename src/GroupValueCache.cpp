@@ -0,0 +1,42 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "GroupValueCache.h"
+
+namespace Knx {
+
+void GroupValueCache::addInterface(const std::string &interfaceId) {
+  if (_tables.find(interfaceId) != _tables.end()) return;
+  _tables.emplace(interfaceId, std::unique_ptr<Table>(new Table()));
+}
+
+void GroupValueCache::set(const std::string &interfaceId, const PCemi &packet, bool sent) {
+  if (!packet || (packet->getOperation() != Cemi::Operation::groupValueWrite && packet->getOperation() != Cemi::Operation::groupValueResponse)) return;
+  auto tableIterator = _tables.find(interfaceId);
+  if (tableIterator == _tables.end()) return;
+  auto entry = std::make_shared<Entry>();
+  entry->operation = packet->getOperation();
+  entry->sourceAddress = packet->getSourceAddress();
+  entry->sent = sent;
+  entry->time = BaseLib::HelperFunctions::getTime();
+  entry->payload = packet->getPayload();
+  std::atomic_store(&(*tableIterator->second)[packet->getDestinationAddress()], PEntry(std::move(entry)));
+}
+
+GroupValueCache::PEntry GroupValueCache::get(const std::string &interfaceId, uint16_t groupAddress) const {
+  auto tableIterator = _tables.find(interfaceId);
+  if (tableIterator == _tables.end()) return PEntry();
+  return std::atomic_load(&(*tableIterator->second)[groupAddress]);
+}
+
+GroupValueCache::PEntry GroupValueCache::get(uint16_t groupAddress, std::string &interfaceId) const {
+  PEntry newestEntry;
+  for (auto &table : _tables) {
+    auto entry = std::atomic_load(&(*table.second)[groupAddress]);
+    if (!entry || (newestEntry && entry->time <= newestEntry->time)) continue;
+    newestEntry = std::move(entry);
+    interfaceId = table.first;
+  }
+  return newestEntry;
+}
+
+}
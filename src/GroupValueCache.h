@@ -0,0 +1,65 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef GROUPVALUECACHE_H_
+#define GROUPVALUECACHE_H_
+
+#include "Cemi.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Knx {
+
+/**
+ * Holds the last value received or sent for every group address, independent of whether a peer uses the group address.
+ * Every interface is a separate line with its own values, so there is one table per interface. Every slot is an
+ * immutable entry that is replaced atomically, so values can be read from any thread without locking.
+ */
+class GroupValueCache {
+ public:
+  struct Entry {
+    Cemi::Operation operation = Cemi::Operation::unset; //groupValueWrite or groupValueResponse
+    uint16_t sourceAddress = 0;
+    bool sent = false; //True when Homegear sent the value
+    int64_t time = 0; //Unix time in milliseconds
+    std::vector<uint8_t> payload;
+  };
+  typedef std::shared_ptr<const Entry> PEntry;
+
+  GroupValueCache() = default;
+  virtual ~GroupValueCache() = default;
+
+  /**
+   * Adds the table of an interface. Must be called for all interfaces before values are set or read.
+   */
+  void addInterface(const std::string &interfaceId);
+
+  /**
+   * Stores the payload of GroupValueWrite and GroupValueResponse packets. Other packets and unknown interfaces are
+   * ignored.
+   *
+   * @param sent Set to true for packets Homegear sent successfully.
+   */
+  void set(const std::string &interfaceId, const PCemi &packet, bool sent);
+
+  /**
+   * @return Returns nullptr when no value was received or sent for the group address on the interface.
+   */
+  PEntry get(const std::string &interfaceId, uint16_t groupAddress) const;
+
+  /**
+   * Returns the newest value of the group address on any interface.
+   *
+   * @param[out] interfaceId The interface the value was received or sent on.
+   * @return Returns nullptr when no value was received or sent for the group address.
+   */
+  PEntry get(uint16_t groupAddress, std::string &interfaceId) const;
+ private:
+  typedef std::array<PEntry, 65536> Table;
+
+  //Only modified by addInterface(), so no locking is needed afterwards.
+  std::map<std::string, std::unique_ptr<Table>> _tables;
+};
+
+}
+
+#endif
@@ -3,7 +3,10 @@
 #include "Interfaces.h"
 #include "Gd.h"
 #include "KnxIpForwarder.h"
+#include "LineCoupler.h"
 #include "Cemi.h"
+#include "PhysicalInterfaces/RoutingInterface.h"
+#include "PhysicalInterfaces/TcpInterface.h"
 
 namespace Knx {
 
@@ -21,6 +24,8 @@ void Interfaces::create() {
       if (!deviceEntry.second) continue;
       Gd::out.printDebug("Debug: Creating physical device. Type defined in knx.conf is: " + deviceEntry.second->type);
       if (deviceEntry.second->type == "knxnetip") device.reset(new MainInterface(deviceEntry.second));
+      else if (deviceEntry.second->type == "knxnetiptcp") device.reset(new TcpInterface(deviceEntry.second));
+      else if (deviceEntry.second->type == "knxnetiprouting") device.reset(new RoutingInterface(deviceEntry.second));
       else Gd::out.printError("Error: Unsupported physical device type: " + deviceEntry.second->type);
       if (device) {
         if (_physicalInterfaces.find(deviceEntry.second->id) != _physicalInterfaces.end()) Gd::out.printError("Error: id used for two devices: " + deviceEntry.second->id);
@@ -30,6 +35,11 @@ void Interfaces::create() {
 
         auto iterator = deviceEntry.second->all.find("enableforwarder");
         if (iterator != deviceEntry.second->all.end()) {
+          if (deviceEntry.second->type != "knxnetip" && deviceEntry.second->type != "knxnetiptcp") {
+            Gd::out.printError("Error: The KNXnet/IP forwarder is only supported for tunneling interfaces.");
+            continue;
+          }
+
           auto listenIpIterator = deviceEntry.second->all.find("forwarderlistenip");
           auto portIterator = deviceEntry.second->all.find("forwarderlistenport");
 
@@ -50,13 +60,41 @@ void Interfaces::create() {
           Gd::out.printInfo("Info: Starting KNXnet/IP forwarder for interface " + deviceEntry.second->id + "...");
 
           //Add forwarder for device
-          auto forwarder = std::make_shared<KnxIpForwarder>(listenIp, port, device);
+          auto forwarder = std::make_shared<KnxIpForwarder>(listenIp, port, device, deviceEntry.second);
           _forwarders.emplace(deviceEntry.second->id, forwarder);
+          Gd::forwarders[deviceEntry.second->id] = forwarder;
           forwarder->startListening();
         }
       }
     }
     if (!Gd::defaultPhysicalInterface) Gd::defaultPhysicalInterface = std::make_shared<MainInterface>(std::make_shared<BaseLib::Systems::PhysicalInterfaceSettings>());
+
+    //{{{ Routes between interfaces. All interfaces need to exist before.
+    auto lineCoupler = std::make_shared<LineCoupler>();
+    for (const auto &deviceEntry : _physicalInterfaceSettings) {
+      if (!deviceEntry.second || _physicalInterfaces.find(deviceEntry.second->id) == _physicalInterfaces.end()) continue;
+      auto routeToIterator = deviceEntry.second->all.find("routeto");
+      if (routeToIterator == deviceEntry.second->all.end() || routeToIterator->second->stringValue.empty()) continue;
+
+      auto filterIterator = deviceEntry.second->all.find("routefilter");
+      auto targetIds = BaseLib::HelperFunctions::splitAll(routeToIterator->second->stringValue, ',');
+      for (auto &targetId : targetIds) {
+        BaseLib::HelperFunctions::trim(targetId);
+        if (targetId.empty()) continue;
+        std::unique_ptr<GroupAddressFilter> filter;
+        if (filterIterator != deviceEntry.second->all.end() && !filterIterator->second->stringValue.empty()) {
+          filter = std::make_unique<GroupAddressFilter>();
+          if (!filter->add(filterIterator->second->stringValue)) Gd::out.printError("Error: \"routeFilter\" of interface " + deviceEntry.second->id + " contains invalid entries: " + filterIterator->second->stringValue);
+        }
+        lineCoupler->addRoute(deviceEntry.second->id, targetId, std::move(filter));
+      }
+    }
+    if (lineCoupler->hasRoutes()) {
+      lineCoupler->start();
+      _lineCoupler = lineCoupler;
+      Gd::lineCoupler = lineCoupler;
+    }
+    //}}}
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
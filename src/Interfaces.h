@@ -8,6 +8,7 @@
 namespace Knx {
 
 class KnxIpForwarder;
+class LineCoupler;
 
 using namespace BaseLib;
 
@@ -18,6 +19,7 @@ class Interfaces : public BaseLib::Systems::PhysicalInterfaces {
 
  protected:
   std::unordered_map<std::string, std::shared_ptr<KnxIpForwarder>> _forwarders;
+  std::shared_ptr<LineCoupler> _lineCoupler;
 
   virtual void create();
 };
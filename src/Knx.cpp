@@ -3,6 +3,8 @@
 #include "Gd.h"
 #include "Interfaces.h"
 #include "Knx.h"
+#include "KnxIpForwarder.h"
+#include "LineCoupler.h"
 #include "KnxCentral.h"
 
 namespace Knx {
@@ -13,7 +15,24 @@ Knx::Knx(BaseLib::SharedObjects *bl, BaseLib::Systems::IFamilyEventSink *eventHa
   Gd::out.init(bl);
   Gd::out.setPrefix(std::string("Module ") + MY_FAMILY_NAME + ": ");
   Gd::out.printDebug("Debug: Loading module...");
-  _physicalInterfaces.reset(new Interfaces(bl, _settings->getPhysicalInterfaceSettings()));
+  Gd::dptConverter = std::make_shared<DptConverter>(bl);
+  auto physicalInterfaceSettings = _settings->getPhysicalInterfaceSettings();
+  //The reactor replaces the listen threads of all interfaces, so it runs with the highest listen thread priority.
+  int32_t reactorThreadPriority = -1;
+  int32_t reactorThreadPolicy = SCHED_OTHER;
+  for (auto &settings : physicalInterfaceSettings) {
+    if (settings.second->listenThreadPriority > reactorThreadPriority) {
+      reactorThreadPriority = settings.second->listenThreadPriority;
+      reactorThreadPolicy = settings.second->listenThreadPolicy;
+    }
+  }
+  if (reactorThreadPriority == -1) {
+    reactorThreadPriority = 45;
+    reactorThreadPolicy = SCHED_FIFO;
+  }
+  Gd::reactor = std::make_shared<Reactor>();
+  Gd::reactor->start(reactorThreadPriority, reactorThreadPolicy);
+  _physicalInterfaces.reset(new Interfaces(bl, physicalInterfaceSettings));
 }
 
 Knx::~Knx() = default;
@@ -29,7 +48,19 @@ bool Knx::init() {
 
 void Knx::dispose() {
   if (_disposed) return;
+  //Stop the forwarders first, so clients can't queue packets on interfaces that are shutting down. Gd::forwarders holds
+  //them until the module is unloaded otherwise.
+  for (auto &forwarder : Gd::forwarders) {
+    forwarder.second->stopListening();
+  }
+  Gd::forwarders.clear();
+  //Stop routing between interfaces that are shutting down. stop() removes the line coupler's event handlers.
+  if (Gd::lineCoupler) {
+    Gd::lineCoupler->stop();
+    Gd::lineCoupler.reset();
+  }
   DeviceFamily::dispose();
+  Gd::reactor->stop();
 
   _central.reset();
 }
@@ -4,6 +4,8 @@
 #include "Gd.h"
 #include "Cemi.h"
 #include "KnxIpPacket.h"
+#include "KnxIpForwarder.h"
+#include "LineCoupler.h"
 
 #include <iomanip>
 
@@ -28,6 +30,9 @@ void KnxCentral::dispose(bool wait) {
 
     _stopWorkerThread = true;
 
+    if (_dispatcher) _dispatcher->stop();
+    if (_readScheduler) _readScheduler->stop();
+
     auto peers = getPeers();
     for (auto &peer: peers) {
       auto myPeer = std::dynamic_pointer_cast<KnxPeer>(peer);
@@ -36,6 +41,8 @@ void KnxCentral::dispose(bool wait) {
 
     Gd::out.printDebug("Debug: Waiting for worker thread of device " + std::to_string(_deviceId) + "...");
     Gd::bl->threadManager.join(_workerThread);
+    Gd::bl->threadManager.join(_eventFlushThread);
+    flushParameters();
 
     Gd::out.printDebug("Removing device " + std::to_string(_deviceId) + " from physical device's event queue...");
     for (std::map<std::string, std::shared_ptr<MainInterface>>::iterator i = Gd::physicalInterfaces.begin(); i != Gd::physicalInterfaces.end(); ++i) {
@@ -74,38 +81,226 @@ void KnxCentral::init() {
                                                                                                                                                                               std::placeholders::_1,
                                                                                                                                                                               std::placeholders::_2)));
 
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getInterfaceStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getInterfaceStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getForwarderStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getForwarderStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getRoutingStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getRoutingStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getDispatchStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getDispatchStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getStartupReadStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getStartupReadStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getGroupValue",
+                                                                                                                                                                    std::bind(&KnxCentral::getGroupValue,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getGroupValues",
+                                                                                                                                                                    std::bind(&KnxCentral::getGroupValues,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getPersistenceStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getPersistenceStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
+    _localRpcMethods.insert(std::pair<std::string, std::function<BaseLib::PVariable(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters)>>("getEventFilterStatistics",
+                                                                                                                                                                    std::bind(&KnxCentral::getEventFilterStatistics,
+                                                                                                                                                                              this,
+                                                                                                                                                                              std::placeholders::_1,
+                                                                                                                                                                              std::placeholders::_2)));
+
     _search.reset(new Search());
 
+    {
+      uint32_t dispatchThreads = 4;
+      uint32_t dispatchQueueSize = 1000;
+      auto setting = Gd::family->getFamilySetting("dispatchThreads");
+      if (setting && setting->integerValue > 0) dispatchThreads = setting->integerValue;
+      setting = Gd::family->getFamilySetting("dispatchQueueSize");
+      if (setting && setting->integerValue > 0) dispatchQueueSize = setting->integerValue;
+      _dispatcher = std::make_unique<PacketDispatcher>(dispatchThreads, dispatchQueueSize, std::bind(&KnxCentral::processPacket, this, std::placeholders::_1));
+      _dispatcher->start();
+    }
+
+    {
+      uint32_t startupReadRate = 20;
+      auto setting = Gd::family->getFamilySetting("startupReadRate");
+      if (setting && setting->integerValue >= 0) startupReadRate = setting->integerValue;
+      _readScheduler = std::make_unique<ReadScheduler>(startupReadRate);
+      _readScheduler->start();
+    }
+
+    {
+      auto setting = Gd::family->getFamilySetting("parameterSaveInterval");
+      if (setting && setting->integerValue >= 0) _parameterSaveInterval = setting->integerValue;
+      setting = Gd::family->getFamilySetting("eventBatchWindow");
+      if (setting && setting->integerValue > 0) _eventBatchWindow = setting->integerValue;
+    }
+
     for (std::map<std::string, std::shared_ptr<MainInterface>>::iterator i = Gd::physicalInterfaces.begin(); i != Gd::physicalInterfaces.end(); ++i) {
+      _groupValueCache.addInterface(i->first);
       _physicalInterfaceEventhandlers[i->first] = i->second->addEventHandler((BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink *)this);
-      i->second->setReconnected(std::function<void()>(std::bind(&KnxCentral::interfaceReconnected, this)));
+      i->second->addReconnectedCallback(std::function<void()>(std::bind(&KnxCentral::interfaceReconnected, this, i->first)));
+      i->second->addPacketSentCallback(std::function<void(const PCemi &)>(std::bind(&KnxCentral::packetSent, this, i->first, std::placeholders::_1)));
     }
 
     _stopWorkerThread = false;
     Gd::bl->threadManager.start(_workerThread, true, _bl->settings.workerThreadPriority(), _bl->settings.workerThreadPolicy(), &KnxCentral::worker, this);
+    if (_eventBatchWindow > 0) Gd::bl->threadManager.start(_eventFlushThread, true, _bl->settings.workerThreadPriority(), _bl->settings.workerThreadPolicy(), &KnxCentral::eventFlushWorker, this);
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
-void KnxCentral::interfaceReconnected() {
+void KnxCentral::interfaceReconnected(const std::string &interfaceId) {
+  setStartupPacketsPending(interfaceId);
+}
+
+void KnxCentral::packetSent(const std::string &interfaceId, const PCemi &packet) {
+  //Received packets don't contain our own writes, so they are stored here.
+  _groupValueCache.set(interfaceId, packet, true);
+}
+
+void KnxCentral::setStartupPacketsPending(const std::string &interfaceId) {
   try {
+    std::lock_guard<std::mutex> startupPacketsGuard(_startupPacketsMutex);
+    _interfacesPendingStartupPackets.emplace(interfaceId);
+    _startupPacketsPending = true;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void KnxCentral::queueStartupPackets() {
+  try {
+    if (!_readScheduler) return;
+
+    //Interfaces that are not open yet stay pending. They are queued once they are connected.
+    std::vector<std::shared_ptr<MainInterface>> interfaces;
+    {
+      std::lock_guard<std::mutex> startupPacketsGuard(_startupPacketsMutex);
+      for (auto interfaceIdIterator = _interfacesPendingStartupPackets.begin(); interfaceIdIterator != _interfacesPendingStartupPackets.end();) {
+        auto interfaceIterator = Gd::physicalInterfaces.find(*interfaceIdIterator);
+        if (interfaceIterator == Gd::physicalInterfaces.end()) {
+          interfaceIdIterator = _interfacesPendingStartupPackets.erase(interfaceIdIterator);
+          continue;
+        }
+        if (!interfaceIterator->second->isOpen()) {
+          interfaceIdIterator++;
+          continue;
+        }
+        interfaces.push_back(interfaceIterator->second);
+        interfaceIdIterator = _interfacesPendingStartupPackets.erase(interfaceIdIterator);
+      }
+      _startupPacketsPending = !_interfacesPendingStartupPackets.empty();
+    }
+    if (interfaces.empty()) return;
+
+    std::vector<ReadScheduler::Request> writes;
+    std::vector<ReadScheduler::Request> reads;
+    std::vector<PCemi> peerWrites;
+    std::vector<PCemi> peerReads;
     auto peers = getPeers();
-    for (auto &peer: peers) {
+    for (auto &peer : peers) {
+      auto myPeer = std::dynamic_pointer_cast<KnxPeer>(peer);
+      if (!myPeer || myPeer->deleting) continue;
+      peerWrites.clear();
+      peerReads.clear();
+      if (!myPeer->getStartupPackets(peerWrites, peerReads)) continue;
+      for (auto &interface : interfaces) {
+        if (!myPeer->usesInterface(interface->getID())) continue;
+        for (auto &packet : peerWrites) {
+          writes.emplace_back(ReadScheduler::Request{interface, packet});
+        }
+        for (auto &packet : peerReads) {
+          reads.emplace_back(ReadScheduler::Request{interface, packet});
+        }
+      }
+    }
+    //The scheduler sends every group address only once per interface.
+    _readScheduler->add(writes, reads);
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void KnxCentral::flushParameters() {
+  try {
+    auto startTime = std::chrono::steady_clock::now();
+    size_t queued = 0;
+    size_t written = 0;
+    auto peers = getPeers();
+    for (auto &peer : peers) {
       auto myPeer = std::dynamic_pointer_cast<KnxPeer>(peer);
-      myPeer->interfaceReconnected();
+      if (!myPeer) continue;
+      size_t peerQueued = 0;
+      written += myPeer->flushParameters(peerQueued);
+      queued += peerQueued;
     }
+    if (queued == 0) return;
+
+    int64_t flushTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    _parameterSavesQueued += queued;
+    _parameterSavesWritten += written;
+    _parameterFlushes++;
+    _parameterFlushTimeSum += flushTime;
+    if (flushTime > _maxParameterFlushTime) _maxParameterFlushTime = flushTime; //Only called by one thread at a time
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
+void KnxCentral::eventFlushWorker() {
+  while (!_stopWorkerThread && !Gd::bl->shuttingDown) {
+    try {
+      std::this_thread::sleep_for(std::chrono::milliseconds(_eventBatchWindow));
+      auto peers = getPeers();
+      for (auto &peer : peers) {
+        auto myPeer = std::dynamic_pointer_cast<KnxPeer>(peer);
+        if (myPeer) myPeer->flushEvents();
+      }
+    }
+    catch (const std::exception &ex) {
+      Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+}
+
 void KnxCentral::worker() {
   try {
     std::chrono::milliseconds sleepingTime(100);
     uint32_t counter = 0;
+    auto lastParameterFlush = std::chrono::steady_clock::now();
     uint64_t lastPeer;
     lastPeer = 0;
 
@@ -113,6 +308,11 @@ void KnxCentral::worker() {
       try {
         std::this_thread::sleep_for(sleepingTime);
         if (_stopWorkerThread || Gd::bl->shuttingDown) return;
+        if (_startupPacketsPending) queueStartupPackets();
+        if (std::chrono::steady_clock::now() - lastParameterFlush >= std::chrono::milliseconds(_parameterSaveInterval)) {
+          lastParameterFlush = std::chrono::steady_clock::now();
+          flushParameters();
+        }
         if (counter > 1000) {
           counter = 0;
 
@@ -175,12 +375,13 @@ void KnxCentral::loadPeers() {
       _peersById[peerID] = peer;
       if (peer->getAddress() != -1) _peers[peer->getAddress()] = peer;
       std::vector<uint16_t> groupAddresses = peer->getGroupAddresses();
-      for (std::vector<uint16_t>::iterator i = groupAddresses.begin(); i != groupAddresses.end(); ++i) {
-        auto peersIterator = _peersByGroupAddress.find(*i);
-        if (peersIterator == _peersByGroupAddress.end()) _peersByGroupAddress.emplace(*i, std::make_shared<std::map<uint64_t, PKnxPeer>>());
-        _peersByGroupAddress[*i]->emplace(peerID, peer);
+      for (auto groupAddress : groupAddresses) {
+        addPeerToGroupAddress(groupAddress, peer);
       }
     }
+    for (auto &interface : Gd::physicalInterfaces) {
+      setStartupPacketsPending(interface.first);
+    }
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -224,15 +425,33 @@ std::shared_ptr<KnxPeer> KnxCentral::getPeer(std::string serialNumber) {
 }
 
 PGroupAddressPeers KnxCentral::getPeer(uint16_t groupAddress) {
-  try {
-    std::lock_guard<std::mutex> peersGuard(_peersMutex);
-    auto peersIterator = _peersByGroupAddress.find(groupAddress);
-    if (peersIterator != _peersByGroupAddress.end()) return peersIterator->second;
+  return std::atomic_load(&(*_groupAddressTable)[groupAddress]);
+}
+
+void KnxCentral::addPeerToGroupAddress(uint16_t groupAddress, const PKnxPeer &peer) {
+  _peersByGroupAddress[groupAddress][peer->getID()] = peer;
+  publishGroupAddress(groupAddress);
+}
+
+void KnxCentral::publishGroupAddress(uint16_t groupAddress) {
+  PGroupAddressPeers snapshot;
+  auto peersIterator = _peersByGroupAddress.find(groupAddress);
+  if (peersIterator != _peersByGroupAddress.end() && !peersIterator->second.empty()) {
+    auto peers = std::make_shared<std::vector<PKnxPeer>>();
+    peers->reserve(peersIterator->second.size());
+    for (auto &peer : peersIterator->second) {
+      peers->push_back(peer.second);
+    }
+    snapshot = std::move(peers);
   }
-  catch (const std::exception &ex) {
-    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  std::atomic_store(&(*_groupAddressTable)[groupAddress], snapshot);
+}
+
+void KnxCentral::clearGroupAddresses() {
+  for (auto &peers : _peersByGroupAddress) {
+    std::atomic_store(&(*_groupAddressTable)[peers.first], PGroupAddressPeers());
   }
-  return PGroupAddressPeers();
+  _peersByGroupAddress.clear();
 }
 
 uint64_t KnxCentral::getRoomIdByName(std::string &name) {
@@ -250,13 +469,12 @@ bool KnxCentral::onPacketReceived(std::string &senderId, std::shared_ptr<BaseLib
       Gd::out.printInfo("Packet received from " + myPacket->getFormattedSourceAddress() + " to " + myPacket->getFormattedDestinationAddress() + ". Operation: " + myPacket->getOperationString() + ". Payload: "
                             + BaseLib::HelperFunctions::getHexString(myPacket->getPayload()));
 
-    auto peers = getPeer(myPacket->getDestinationAddress());
-    if (!peers) return false;
-    for (auto &peer: *peers) {
-      peer.second->packetReceived(myPacket);
+    //This is called on the reactor thread. Peer processing (database writes, events) is done by the dispatcher's workers.
+    if (_readScheduler && (myPacket->getOperation() == Cemi::Operation::groupValueResponse || myPacket->getOperation() == Cemi::Operation::groupValueWrite)) {
+      _readScheduler->responseReceived(senderId, myPacket->getDestinationAddress());
     }
-
-    return true;
+    _groupValueCache.set(senderId, myPacket, false);
+    return _dispatcher && _dispatcher->enqueue(myPacket);
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -264,6 +482,21 @@ bool KnxCentral::onPacketReceived(std::string &senderId, std::shared_ptr<BaseLib
   return false;
 }
 
+void KnxCentral::processPacket(const PCemi &packet) {
+  try {
+    if (_disposing) return;
+    auto peers = getPeer(packet->getDestinationAddress());
+    if (!peers) return;
+    TelegramDecoder decoder(packet->getPayload());
+    for (auto &peer: *peers) {
+      peer->packetReceived(packet, decoder, _eventBatchWindow > 0);
+    }
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 void KnxCentral::savePeers(bool full) {
   try {
     std::lock_guard<std::mutex> peersGuard(_peersMutex);
@@ -282,6 +515,8 @@ void KnxCentral::setPeerId(uint64_t oldPeerId, uint64_t newPeerId) {
     ICentral::setPeerId(oldPeerId, newPeerId);
 
     auto peer = getPeer(newPeerId);
+    if (!peer) return;
+    peer->initParametersByGroupAddress(); //The event source contains the peer ID
     auto groupAddresses = peer->getGroupAddresses();
 
     for (const uint16_t &address: groupAddresses) {
@@ -290,9 +525,7 @@ void KnxCentral::setPeerId(uint64_t oldPeerId, uint64_t newPeerId) {
 
     std::lock_guard<std::mutex> peersGuard(_peersMutex);
     for (const uint16_t &address: groupAddresses) {
-      auto peersIterator = _peersByGroupAddress.find(address);
-      if (peersIterator == _peersByGroupAddress.end()) _peersByGroupAddress.emplace(address, std::make_shared<std::map<uint64_t, PKnxPeer>>());
-      _peersByGroupAddress[address]->emplace(newPeerId, peer);
+      addPeerToGroupAddress(address, peer);
     }
   }
   catch (const std::exception &ex) {
@@ -305,7 +538,9 @@ void KnxCentral::removePeerFromGroupAddresses(uint16_t groupAddress, uint64_t pe
     std::lock_guard<std::mutex> peersGuard(_peersMutex);
     auto peersIterator = _peersByGroupAddress.find(groupAddress);
     if (peersIterator == _peersByGroupAddress.end()) return;
-    peersIterator->second->erase(peerId);
+    peersIterator->second.erase(peerId);
+    if (peersIterator->second.empty()) _peersByGroupAddress.erase(peersIterator);
+    publishGroupAddress(groupAddress);
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -354,6 +589,8 @@ void KnxCentral::deletePeer(uint64_t id) {
     }
     if (i == 600) Gd::out.printError("Error: Peer deletion took too long.");
 
+    size_t queued = 0;
+    peer->flushParameters(queued);
     peer->deleteFromDatabase();
 
     Gd::out.printInfo("Info: Deleting XML file \"" + peer->getRpcDevice()->getPath() + "\"");
@@ -377,6 +614,7 @@ std::string KnxCentral::handleCliCommand(std::string command) {
       stringStream << "peers remove (pr)  Remove a peer" << std::endl;
       stringStream << "peers select (ps)  Select a peer" << std::endl;
       stringStream << "peers setname (pn) Name a peer" << std::endl;
+      stringStream << "memory (mem)       Shows the estimated memory usage of all peers" << std::endl;
       stringStream << "search (sp)        Searches for new devices" << std::endl;
       stringStream << "unselect (u)       Unselect this device" << std::endl;
       return stringStream.str();
@@ -559,6 +797,61 @@ std::string KnxCentral::handleCliCommand(std::string command) {
         stringStream << "Name set to \"" << name << "\"." << std::endl;
       }
       return stringStream.str();
+    } else if (BaseLib::HelperFunctions::checkCliCommand(command, "memory", "mem", "", 0, arguments, showHelp)) {
+      if (showHelp) {
+        stringStream << "Description: This command shows the estimated memory usage of all peers in bytes." << std::endl;
+        stringStream << "Usage: memory" << std::endl << std::endl;
+        stringStream << "Parameters:" << std::endl;
+        stringStream << "  There are no parameters." << std::endl;
+        return stringStream.str();
+      }
+
+      std::vector<std::shared_ptr<KnxPeer>> peers;
+      {
+        std::lock_guard<std::mutex> peersGuard(_peersMutex);
+        peers.reserve(_peersById.size());
+        for (auto &peer : _peersById) {
+          auto knxPeer = std::dynamic_pointer_cast<KnxPeer>(peer.second);
+          if (knxPeer) peers.push_back(knxPeer);
+        }
+      }
+
+      std::string bar(" │ ");
+      const int32_t idWidth = 8;
+      const int32_t sizeWidth = 12;
+      stringStream << std::setfill(' ')
+                   << std::setw(idWidth) << "ID" << bar
+                   << std::setw(sizeWidth) << "Parameters" << bar
+                   << std::setw(sizeWidth) << "Values" << bar
+                   << std::setw(sizeWidth) << "Maps" << bar
+                   << std::setw(sizeWidth) << "Total"
+                   << std::endl;
+      stringStream << "─────────┼──────────────┼──────────────┼──────────────┼─────────────" << std::endl;
+      KnxPeer::MemoryUsage total;
+      for (auto &peer : peers) {
+        auto memoryUsage = peer->getMemoryUsage();
+        stringStream << std::setw(idWidth) << peer->getID() << bar
+                     << std::setw(sizeWidth) << memoryUsage.parameters << bar
+                     << std::setw(sizeWidth) << memoryUsage.values << bar
+                     << std::setw(sizeWidth) << memoryUsage.maps << bar
+                     << std::setw(sizeWidth) << (memoryUsage.parameters + memoryUsage.values + memoryUsage.maps)
+                     << std::endl;
+        total.parameterCount += memoryUsage.parameterCount;
+        total.parameters += memoryUsage.parameters;
+        total.valueCount += memoryUsage.valueCount;
+        total.values += memoryUsage.values;
+        total.maps += memoryUsage.maps;
+      }
+      stringStream << "─────────┼──────────────┼──────────────┼──────────────┼─────────────" << std::endl;
+      stringStream << std::setw(idWidth) << "Total" << bar
+                   << std::setw(sizeWidth) << total.parameters << bar
+                   << std::setw(sizeWidth) << total.values << bar
+                   << std::setw(sizeWidth) << total.maps << bar
+                   << std::setw(sizeWidth) << (total.parameters + total.values + total.maps)
+                   << std::endl << std::endl;
+      stringStream << "Peers: " << peers.size() << ", parameters: " << total.parameterCount << ", values: " << total.valueCount << std::endl;
+      stringStream << "Shared DPT converter (all peers): " << (sizeof(DptConverter) + sizeof(BaseLib::Ansi)) << " bytes (approximate)" << std::endl;
+      return stringStream.str();
     } else if (command.compare(0, 6, "search") == 0 || command.compare(0, 2, "sp") == 0) {
       std::stringstream stream(command);
       std::string element;
@@ -693,7 +986,7 @@ PVariable KnxCentral::searchDevices(BaseLib::PRpcClientInfo clientInfo, const st
       _peers.clear();
       _peersBySerial.clear();
       _peersById.clear();
-      _peersByGroupAddress.clear();
+      clearGroupAddresses();
     }
 
     auto usedTypeNumbers = Gd::family->getRpcDevices()->getKnownTypeNumbers();
@@ -787,10 +1080,8 @@ size_t KnxCentral::reloadAndUpdatePeers(BaseLib::PRpcClientInfo clientInfo, cons
       _peersBySerial[peer->getSerialNumber()] = peer;
       _peersById[peer->getID()] = peer;
       std::vector<uint16_t> groupAddresses = peer->getGroupAddresses();
-      for (std::vector<uint16_t>::iterator j = groupAddresses.begin(); j != groupAddresses.end(); ++j) {
-        auto peersIterator = _peersByGroupAddress.find(*j);
-        if (peersIterator == _peersByGroupAddress.end()) _peersByGroupAddress.emplace(*j, std::make_shared<std::map<uint64_t, PKnxPeer>>());
-        _peersByGroupAddress[*j]->emplace(peer->getID(), peer);
+      for (auto groupAddress : groupAddresses) {
+        addPeerToGroupAddress(groupAddress, peer);
       }
       newPeers.push_back(peer);
     }
@@ -885,21 +1176,27 @@ BaseLib::PVariable KnxCentral::updateDevices(const BaseLib::PRpcClientInfo &clie
 
 BaseLib::PVariable KnxCentral::groupValueRead(const PRpcClientInfo &clientInfo, const PArray &parameters) {
   try {
-    if (parameters->size() != 2) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (parameters->size() != 2 && parameters->size() != 3) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
     if (parameters->at(0)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type String.");
+    if (parameters->size() == 3 && parameters->at(2)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 3 is not of type String.");
 
     auto interfaceId = parameters->at(0)->stringValue;
     auto destinationAddress = Cemi::parseGroupAddress(parameters->at(1)->stringValue);
 
     if (destinationAddress == 0) return Variable::createError(-1, "Invalid group address.");
 
+    auto priority = Cemi::Priority::normal;
+    if (parameters->size() == 3 && !Cemi::parsePriority(parameters->at(2)->stringValue, priority)) return Variable::createError(-1, "Invalid priority. Valid values are \"system\", \"urgent\", \"normal\" and \"low\".");
+
     auto cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueRead, 0, destinationAddress);
+    cemi->setPriority(priority);
 
     auto interfaceIterator = Gd::physicalInterfaces.find(interfaceId);
     if (interfaceIterator == Gd::physicalInterfaces.end()) {
       return Variable::createError(-2, "Unknown communication interface.");
     }
-    interfaceIterator->second->sendPacket(cemi);
+    auto result = interfaceIterator->second->queuePacket(cemi);
+    if (result != MainInterface::SendResult::queued) return Variable::createError(-3, MainInterface::getSendResultString(result));
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -911,27 +1208,31 @@ BaseLib::PVariable KnxCentral::groupValueRead(const PRpcClientInfo &clientInfo,
 
 BaseLib::PVariable KnxCentral::groupValueWrite(const PRpcClientInfo &clientInfo, const PArray &parameters) {
   try {
-    if (parameters->size() != 4) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (parameters->size() != 4 && parameters->size() != 5) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
     if (parameters->at(0)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type String.");
     if (parameters->at(1)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 2 is not of type String.");
     if (parameters->at(2)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 3 is not of type String.");
-
-    DptConverter dptConverter(_bl);
+    if (parameters->size() == 5 && parameters->at(4)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 5 is not of type String.");
 
     auto interfaceId = parameters->at(0)->stringValue;
     auto destinationAddress = Cemi::parseGroupAddress(parameters->at(1)->stringValue);
     auto dpt = BaseLib::HelperFunctions::toUpper(parameters->at(2)->stringValue);
-    auto value = dptConverter.getDpt(dpt, parameters->at(3), BaseLib::Role());
+    auto value = Gd::dptConverter->getDpt(dpt, parameters->at(3), BaseLib::Role());
 
     if (destinationAddress == 0) return Variable::createError(-1, "Invalid group address.");
 
-    auto cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, destinationAddress, dptConverter.fitsInFirstByte(dpt), value);
+    auto priority = Cemi::Priority::normal;
+    if (parameters->size() == 5 && !Cemi::parsePriority(parameters->at(4)->stringValue, priority)) return Variable::createError(-1, "Invalid priority. Valid values are \"system\", \"urgent\", \"normal\" and \"low\".");
+
+    auto cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, destinationAddress, Gd::dptConverter->fitsInFirstByte(dpt), value);
+    cemi->setPriority(priority);
 
     auto interfaceIterator = Gd::physicalInterfaces.find(interfaceId);
     if (interfaceIterator == Gd::physicalInterfaces.end()) {
       return Variable::createError(-2, "Unknown communication interface.");
     }
-    interfaceIterator->second->sendPacket(cemi);
+    auto result = interfaceIterator->second->queuePacket(cemi);
+    if (result != MainInterface::SendResult::queued) return Variable::createError(-3, MainInterface::getSendResultString(result));
 
     return std::make_shared<BaseLib::Variable>();
   }
@@ -940,6 +1241,258 @@ BaseLib::PVariable KnxCentral::groupValueWrite(const PRpcClientInfo &clientInfo,
   }
   return Variable::createError(-32500, "Unknown application error.");
 }
+
+BaseLib::PVariable KnxCentral::getInterfaceStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (parameters->size() > 1) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (parameters->size() == 1 && parameters->at(0)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type String.");
+
+    if (parameters->size() == 1) {
+      auto interfaceIterator = Gd::physicalInterfaces.find(parameters->at(0)->stringValue);
+      if (interfaceIterator == Gd::physicalInterfaces.end()) {
+        return Variable::createError(-2, "Unknown communication interface.");
+      }
+      return interfaceIterator->second->getStatistics();
+    }
+
+    auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    for (auto &interface : Gd::physicalInterfaces) {
+      result->structValue->emplace(interface.first, interface.second->getStatistics());
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getForwarderStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (parameters->size() > 1) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (parameters->size() == 1 && parameters->at(0)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type String.");
+
+    if (parameters->size() == 1) {
+      auto forwarderIterator = Gd::forwarders.find(parameters->at(0)->stringValue);
+      if (forwarderIterator == Gd::forwarders.end()) {
+        return Variable::createError(-2, "No forwarder is enabled for this communication interface.");
+      }
+      return forwarderIterator->second->getStatistics();
+    }
+
+    auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    for (auto &forwarder : Gd::forwarders) {
+      result->structValue->emplace(forwarder.first, forwarder.second->getStatistics());
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getRoutingStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (!parameters->empty()) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (!Gd::lineCoupler) return Variable::createError(-2, "No routes are configured.");
+    return Gd::lineCoupler->getStatistics();
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getDispatchStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (!parameters->empty()) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (!_dispatcher) return Variable::createError(-32500, "Dispatcher is not initialized.");
+    return _dispatcher->getStatistics();
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getCachedGroupValue(uint16_t groupAddress, const std::string &interfaceId, const GroupValueCache::PEntry &entry, const DptConverter::Dpt &dpt) {
+  auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+  auto type = dpt;
+  BaseLib::Role role;
+  if (type.main == 0) {
+    //Use the type of the first peer that knows the group address.
+    auto peers = getPeer(groupAddress);
+    if (peers) {
+      for (auto &peer : *peers) {
+        if (peer->getGroupAddressType(groupAddress, type, role)) break;
+      }
+    }
+  }
+
+  if (type.main != 0) {
+    auto value = Gd::dptConverter->getVariable(type, entry->payload, role);
+    if (value) result->structValue->emplace("value", value);
+    result->structValue->emplace("dpt", std::make_shared<BaseLib::Variable>(type.sub == 0 ? "DPT-" + std::to_string(type.main) : "DPST-" + std::to_string(type.main) + "-" + std::to_string(type.sub)));
+  }
+  result->structValue->emplace("rawValue", std::make_shared<BaseLib::Variable>(BaseLib::HelperFunctions::getHexString(entry->payload)));
+  result->structValue->emplace("source", std::make_shared<BaseLib::Variable>(Cemi::getFormattedPhysicalAddress(entry->sourceAddress)));
+  result->structValue->emplace("interface", std::make_shared<BaseLib::Variable>(interfaceId));
+  result->structValue->emplace("sent", std::make_shared<BaseLib::Variable>(entry->sent));
+  result->structValue->emplace("time", std::make_shared<BaseLib::Variable>(entry->time));
+  result->structValue->emplace("operation", std::make_shared<BaseLib::Variable>(std::string(entry->operation == Cemi::Operation::groupValueResponse ? "GroupValueResponse" : "GroupValueWrite")));
+  return result;
+}
+
+GroupValueCache::PEntry KnxCentral::getCachedGroupValueEntry(uint16_t groupAddress, std::string &interfaceId) {
+  //Without an interface the newest value of all interfaces is returned.
+  if (interfaceId.empty()) return _groupValueCache.get(groupAddress, interfaceId);
+  return _groupValueCache.get(interfaceId, groupAddress);
+}
+
+BaseLib::PVariable KnxCentral::getGroupValue(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (parameters->empty() || parameters->size() > 3) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (parameters->at(0)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type String.");
+    if (parameters->size() >= 2 && parameters->at(1)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 2 is not of type String.");
+    if (parameters->size() == 3 && parameters->at(2)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 3 is not of type String.");
+
+    auto groupAddress = Cemi::parseGroupAddress(parameters->at(0)->stringValue);
+    if (groupAddress == 0) return Variable::createError(-1, "Invalid group address.");
+
+    //An empty DPT uses the type of the peers, so the interface can be passed without a DPT.
+    DptConverter::Dpt dpt;
+    if (parameters->size() >= 2 && !parameters->at(1)->stringValue.empty()) {
+      dpt = DptConverter::parseDpt(BaseLib::HelperFunctions::toUpper(parameters->at(1)->stringValue));
+      if (dpt.main == 0) return Variable::createError(-1, "Invalid DPT.");
+    }
+
+    std::string interfaceId;
+    if (parameters->size() == 3) {
+      interfaceId = parameters->at(2)->stringValue;
+      if (Gd::physicalInterfaces.find(interfaceId) == Gd::physicalInterfaces.end()) return Variable::createError(-1, "Unknown interface.");
+    }
+
+    auto entry = getCachedGroupValueEntry(groupAddress, interfaceId);
+    if (!entry) return std::make_shared<BaseLib::Variable>();
+    return getCachedGroupValue(groupAddress, interfaceId, entry, dpt);
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getGroupValues(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (parameters->size() > 2) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (!parameters->empty() && parameters->at(0)->type != BaseLib::VariableType::tArray) return BaseLib::Variable::createError(-1, "Parameter 1 is not of type Array.");
+    if (parameters->size() == 2 && parameters->at(1)->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 2 is not of type String.");
+
+    std::string requestedInterfaceId;
+    if (parameters->size() == 2) {
+      requestedInterfaceId = parameters->at(1)->stringValue;
+      if (Gd::physicalInterfaces.find(requestedInterfaceId) == Gd::physicalInterfaces.end()) return Variable::createError(-1, "Unknown interface.");
+    }
+
+    auto result = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    //An empty array returns all group addresses, so the interface can be passed without group addresses.
+    if (parameters->empty() || parameters->at(0)->arrayValue->empty()) {
+      for (int32_t groupAddress = 1; groupAddress < 65536; groupAddress++) {
+        std::string interfaceId = requestedInterfaceId;
+        auto entry = getCachedGroupValueEntry(groupAddress, interfaceId);
+        if (!entry) continue;
+        result->structValue->emplace(Cemi::getFormattedGroupAddress(groupAddress), getCachedGroupValue(groupAddress, interfaceId, entry, DptConverter::Dpt()));
+      }
+      return result;
+    }
+
+    for (auto &element : *parameters->at(0)->arrayValue) {
+      if (element->type != BaseLib::VariableType::tString) return BaseLib::Variable::createError(-1, "Parameter 1 contains an element that is not of type String.");
+      auto groupAddress = Cemi::parseGroupAddress(element->stringValue);
+      if (groupAddress == 0) return Variable::createError(-1, "Invalid group address: " + element->stringValue);
+      std::string interfaceId = requestedInterfaceId;
+      auto entry = getCachedGroupValueEntry(groupAddress, interfaceId);
+      if (!entry) continue;
+      result->structValue->emplace(element->stringValue, getCachedGroupValue(groupAddress, interfaceId, entry, DptConverter::Dpt()));
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getPersistenceStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (!parameters->empty()) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+
+    uint64_t queued = _parameterSavesQueued;
+    uint64_t written = _parameterSavesWritten;
+    uint64_t flushes = _parameterFlushes;
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    statistics->structValue->emplace("flushInterval", std::make_shared<BaseLib::Variable>(_parameterSaveInterval));
+    statistics->structValue->emplace("valuesQueued", std::make_shared<BaseLib::Variable>((int64_t)queued));
+    statistics->structValue->emplace("valuesWritten", std::make_shared<BaseLib::Variable>((int64_t)written));
+    //Values queued per database write. "1" means nothing was coalesced.
+    statistics->structValue->emplace("coalescingRatio", std::make_shared<BaseLib::Variable>(written > 0 ? (double)queued / written : 1.0));
+    statistics->structValue->emplace("flushes", std::make_shared<BaseLib::Variable>((int64_t)flushes));
+    statistics->structValue->emplace("averageFlushTime", std::make_shared<BaseLib::Variable>(flushes > 0 ? _parameterFlushTimeSum / (int64_t)flushes : (int64_t)0)); //In microseconds
+    statistics->structValue->emplace("maxFlushTime", std::make_shared<BaseLib::Variable>((int64_t)_maxParameterFlushTime)); //In microseconds
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getEventFilterStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (!parameters->empty()) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+
+    int64_t eventsRaised = 0;
+    int64_t eventsSuppressed = 0;
+    auto peersStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    auto peers = getPeers();
+    for (auto &peer : peers) {
+      auto myPeer = std::dynamic_pointer_cast<KnxPeer>(peer);
+      if (!myPeer) continue;
+      int64_t peerEventsRaised = myPeer->getEventsRaised();
+      int64_t peerEventsSuppressed = myPeer->getEventsSuppressed();
+      eventsRaised += peerEventsRaised;
+      eventsSuppressed += peerEventsSuppressed;
+      if (peerEventsSuppressed == 0) continue;
+      auto peerStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      peerStruct->structValue->emplace("eventsRaised", std::make_shared<BaseLib::Variable>(peerEventsRaised));
+      peerStruct->structValue->emplace("eventsSuppressed", std::make_shared<BaseLib::Variable>(peerEventsSuppressed));
+      peersStruct->structValue->emplace(std::to_string(myPeer->getID()), peerStruct);
+    }
+
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    statistics->structValue->emplace("eventsRaised", std::make_shared<BaseLib::Variable>(eventsRaised));
+    statistics->structValue->emplace("eventsSuppressed", std::make_shared<BaseLib::Variable>(eventsSuppressed));
+    statistics->structValue->emplace("peers", peersStruct); //Only peers with suppressed events
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+BaseLib::PVariable KnxCentral::getStartupReadStatistics(const PRpcClientInfo &clientInfo, const PArray &parameters) {
+  try {
+    if (!parameters->empty()) return BaseLib::Variable::createError(-1, "Wrong parameter count.");
+    if (!_readScheduler) return Variable::createError(-32500, "Read scheduler is not initialized.");
+    return _readScheduler->getStatistics();
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
 //}}}
 
 }
@@ -7,6 +7,9 @@
 
 #include <homegear-base/BaseLib.h>
 #include "KnxPeer.h"
+#include "PacketDispatcher.h"
+#include "ReadScheduler.h"
+#include "GroupValueCache.h"
 #include "Search.h"
 
 #include <stdio.h>
@@ -16,7 +19,7 @@
 
 namespace Knx {
 
-typedef std::shared_ptr<std::map<uint64_t, PKnxPeer>> PGroupAddressPeers;
+typedef std::shared_ptr<const std::vector<PKnxPeer>> PGroupAddressPeers;
 
 class KnxCentral : public BaseLib::Systems::ICentral {
  public:
@@ -49,11 +52,42 @@ class KnxCentral : public BaseLib::Systems::ICentral {
 
   std::unique_ptr<Search> _search;
   std::mutex _searchMutex;
-  std::map<uint16_t, PGroupAddressPeers> _peersByGroupAddress;
+  std::map<uint16_t, std::map<uint64_t, PKnxPeer>> _peersByGroupAddress; //Protected by _peersMutex
+
+  /**
+   * Flat dispatch table indexed by group address. Every slot holds an immutable snapshot of the peers in
+   * _peersByGroupAddress and is replaced atomically when the membership changes, so received packets can be dispatched
+   * without locking _peersMutex.
+   */
+  std::unique_ptr<std::array<PGroupAddressPeers, 65536>> _groupAddressTable{new std::array<PGroupAddressPeers, 65536>()};
 
   std::atomic_bool _stopWorkerThread;
   std::thread _workerThread;
 
+  std::unique_ptr<PacketDispatcher> _dispatcher;
+  std::unique_ptr<ReadScheduler> _readScheduler;
+  GroupValueCache _groupValueCache;
+
+  //{{{ Event batching
+  int64_t _eventBatchWindow = 0; //In milliseconds. "0" raises the events of a packet immediately.
+  std::thread _eventFlushThread;
+  //}}}
+
+  //{{{ Write-behind of peer variables
+  int64_t _parameterSaveInterval = 1000; //In milliseconds
+  std::atomic<uint64_t> _parameterSavesQueued{0};
+  std::atomic<uint64_t> _parameterSavesWritten{0};
+  std::atomic<uint64_t> _parameterFlushes{0};
+  std::atomic<int64_t> _parameterFlushTimeSum{0}; //In microseconds
+  std::atomic<int64_t> _maxParameterFlushTime{0}; //In microseconds
+  //}}}
+
+  //{{{ Startup packets
+  std::atomic_bool _startupPacketsPending{false}; //Set when _interfacesPendingStartupPackets is not empty
+  std::mutex _startupPacketsMutex;
+  std::set<std::string> _interfacesPendingStartupPackets; //IDs of the interfaces the peers need to acquire their state on
+  //}}}
+
   virtual void init();
   virtual void worker();
   void loadPeers() override;
@@ -64,13 +98,41 @@ class KnxCentral : public BaseLib::Systems::ICentral {
   PKnxPeer createPeer(uint64_t type, int32_t address, std::string serialNumber, bool save = true);
   void deletePeer(uint64_t id);
   void removePeerFromGroupAddresses(uint16_t groupAddress, uint64_t peerId);
-  void interfaceReconnected();
+
+  //{{{ Group address table. _peersMutex needs to be locked when calling these methods.
+  void addPeerToGroupAddress(uint16_t groupAddress, const PKnxPeer &peer);
+  void publishGroupAddress(uint16_t groupAddress);
+  void clearGroupAddresses();
+  //}}}
+  void interfaceReconnected(const std::string &interfaceId);
+  void packetSent(const std::string &interfaceId, const PCemi &packet);
+  void setStartupPacketsPending(const std::string &interfaceId);
+  void queueStartupPackets();
+  void flushParameters();
+  void eventFlushWorker();
+  void processPacket(const PCemi &packet);
+  BaseLib::PVariable getCachedGroupValue(uint16_t groupAddress, const std::string &interfaceId, const GroupValueCache::PEntry &entry, const DptConverter::Dpt &dpt);
+
+  /**
+   * @param[in,out] interfaceId When empty, the newest value of all interfaces is returned and interfaceId is set to its
+   *                            interface.
+   */
+  GroupValueCache::PEntry getCachedGroupValueEntry(uint16_t groupAddress, std::string &interfaceId);
   size_t reloadAndUpdatePeers(BaseLib::PRpcClientInfo clientInfo, const std::vector<Search::PeerInfo> &peerInfo);
 
   //{{{ Family RPC methods
   BaseLib::PVariable updateDevices(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
   BaseLib::PVariable groupValueRead(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
   BaseLib::PVariable groupValueWrite(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getInterfaceStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getForwarderStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getRoutingStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getDispatchStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getStartupReadStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getGroupValue(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getGroupValues(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getPersistenceStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
+  BaseLib::PVariable getEventFilterStatistics(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters);
   //}}}
 };
 
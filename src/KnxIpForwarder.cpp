@@ -9,15 +9,43 @@
 
 namespace Knx {
 
-KnxIpForwarder::KnxIpForwarder(std::string listenIp, uint16_t port, std::shared_ptr<MainInterface> interface) : _listenIpSetting(std::move(listenIp)), _port(port) {
+KnxIpForwarder::KnxIpForwarder(std::string listenIp, uint16_t port, std::shared_ptr<MainInterface> interface, const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings) : _listenIpSetting(std::move(listenIp)), _port(port) {
   _out.init(Gd::bl);
   _out.setPrefix(Gd::out.getPrefix() + "KNXNet/IP forwarder (port " + std::to_string(port) + "): ");
 
   signal(SIGPIPE, SIG_IGN);
 
+  auto settingsIterator = settings->all.find("forwardermaxclients");
+  if (settingsIterator != settings->all.end() && settingsIterator->second->integerValue64 > 0) _maxClients = settingsIterator->second->integerValue64 > 254 ? 254 : (uint32_t)settingsIterator->second->integerValue64;
+
+  settingsIterator = settings->all.find("forwarderdescriptioncachetime");
+  if (settingsIterator != settings->all.end() && settingsIterator->second->integerValue64 >= 0) _descriptionCacheTime = settingsIterator->second->integerValue64 * 1000;
+
+  settingsIterator = settings->all.find("forwardermulticastgroup");
+  if (settingsIterator != settings->all.end() && !settingsIterator->second->stringValue.empty()) {
+    struct in_addr multicastGroup{};
+    if (inet_pton(AF_INET, settingsIterator->second->stringValue.c_str(), &multicastGroup) != 1 || !IN_MULTICAST(ntohl(multicastGroup.s_addr))) {
+      _out.printError("Error: \"forwarderMulticastGroup\" is not a valid IPv4 multicast address: " + settingsIterator->second->stringValue);
+    } else _multicastGroup = settingsIterator->second->stringValue;
+  }
+
+  if (!_multicastGroup.empty()) {
+    settingsIterator = settings->all.find("forwardermulticastport");
+    if (settingsIterator != settings->all.end() && settingsIterator->second->integerValue64 > 0 && settingsIterator->second->integerValue64 <= 65535) _multicastPort = settingsIterator->second->integerValue64;
+
+    settingsIterator = settings->all.find("forwardermulticastexport");
+    if (settingsIterator != settings->all.end() && !settingsIterator->second->stringValue.empty()) {
+      _multicastExportFilter = std::make_unique<GroupAddressFilter>();
+      if (!_multicastExportFilter->add(settingsIterator->second->stringValue)) _out.printError("Error: \"forwarderMulticastExport\" contains invalid entries: " + settingsIterator->second->stringValue);
+    }
+
+    _out.printInfo("Info: Sending group telegrams to " + _multicastGroup + ":" + std::to_string(_multicastPort) + (_multicastExportFilter ? " (" + std::to_string(_multicastExportFilter->count()) + " group addresses)." : "."));
+  }
+
   _interface = std::move(interface);
   _interface->registerPacketReceivedCallback(std::function<void(const PKnxIpPacket &)>(std::bind(&KnxIpForwarder::packetReceivedCallback, this, std::placeholders::_1)));
-  _interface->setReconnected(std::function<void()>(std::bind(&KnxIpForwarder::reconnectedCallback, this)));
+  _interface->addReconnectedCallback(std::function<void()>(std::bind(&KnxIpForwarder::reconnectedCallback, this)));
+  _interface->addPacketSentCallback(std::function<void(const PCemi &)>(std::bind(&KnxIpForwarder::packetSentCallback, this, std::placeholders::_1)));
 }
 
 KnxIpForwarder::~KnxIpForwarder() {
@@ -127,10 +155,9 @@ void KnxIpForwarder::listen() {
         FD_SET(_serverSocketDescriptor->descriptor, &readFileDescriptor);
         fileDescriptorGuard.unlock();
         bytesReceived = select(nfds, &readFileDescriptor, nullptr, nullptr, &socketTimeout);
-        if (bytesReceived == 0) {
-          if (_interface->managementConnected() && BaseLib::HelperFunctions::getTime() - _lastPacketReceived > 300000) _interface->disconnectManagement();
-          continue;
-        } else if (bytesReceived != 1) {
+        checkClients(BaseLib::HelperFunctions::getTime());
+        if (bytesReceived == 0) continue;
+        else if (bytesReceived != 1) {
           _out.printError("Error: Socket closed (2).");
           Gd::bl->fileDescriptorManager.shutdown(_serverSocketDescriptor);
           continue;
@@ -221,137 +248,298 @@ std::shared_ptr<BaseLib::FileDescriptor> KnxIpForwarder::getSocketDescriptor() {
   return serverSocketDescriptor;
 }
 
+BaseLib::PVariable KnxIpForwarder::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    auto clientsArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    {
+      std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+      clientsArray->arrayValue->reserve(_clients.size());
+      for (auto &clientEntry : _clients) {
+        auto clientStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        clientStruct->structValue->emplace("ip", std::make_shared<BaseLib::Variable>(clientEntry.second->ip));
+        clientStruct->structValue->emplace("channelId", std::make_shared<BaseLib::Variable>((int32_t)clientEntry.second->channelId));
+        clientStruct->structValue->emplace("management", std::make_shared<BaseLib::Variable>(clientEntry.second->management));
+        clientsArray->arrayValue->push_back(clientStruct);
+      }
+    }
+
+    int64_t descriptionResponseTime = _descriptionResponseTime;
+    statistics->structValue->emplace("clients", clientsArray);
+    statistics->structValue->emplace("maxClients", std::make_shared<BaseLib::Variable>((int64_t)_maxClients));
+    statistics->structValue->emplace("descriptionCacheHits", std::make_shared<BaseLib::Variable>((int64_t)_descriptionCacheHits));
+    statistics->structValue->emplace("descriptionCacheMisses", std::make_shared<BaseLib::Variable>((int64_t)_descriptionCacheMisses));
+    statistics->structValue->emplace("descriptionRequestsFailed", std::make_shared<BaseLib::Variable>((int64_t)_descriptionRequestsFailed));
+    statistics->structValue->emplace("descriptionAge", std::make_shared<BaseLib::Variable>(descriptionResponseTime == 0 ? (int64_t)-1 : (BaseLib::HelperFunctions::getTime() - descriptionResponseTime) / 1000)); //In seconds
+    statistics->structValue->emplace("searchRequests", std::make_shared<BaseLib::Variable>((int64_t)_searchRequests));
+    if (!_multicastGroup.empty()) {
+      statistics->structValue->emplace("multicastPacketsSent", std::make_shared<BaseLib::Variable>((int64_t)_multicastPacketsSent));
+      statistics->structValue->emplace("multicastPacketsFiltered", std::make_shared<BaseLib::Variable>((int64_t)_multicastPacketsFiltered));
+      statistics->structValue->emplace("multicastPacketsNotRouted", std::make_shared<BaseLib::Variable>((int64_t)_multicastPacketsNotRouted));
+    }
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+KnxIpForwarder::PClient KnxIpForwarder::getClient(uint8_t channelId) {
+  auto clientIterator = _clients.find(channelId);
+  if (clientIterator == _clients.end()) return PClient();
+  return clientIterator->second;
+}
+
+uint8_t KnxIpForwarder::getFreeChannelId() {
+  //Channel ID 0 is invalid. Don't reuse the ID of a client that just disconnected, so late packets can't be mixed up.
+  for (int32_t i = 0; i < 255; i++) {
+    _lastChannelId = _lastChannelId == 255 ? 1 : _lastChannelId + 1;
+    if (_clients.find(_lastChannelId) == _clients.end()) return _lastChannelId;
+  }
+  return 0;
+}
+
+bool KnxIpForwarder::removeClient(PClient client) {
+  try {
+    if (!client) return false;
+    _clients.erase(client->channelId);
+    _out.printInfo("Info: Client " + client->ip + " (channel " + std::to_string(client->channelId) + ") disconnected. " + std::to_string(_clients.size()) + " clients are connected.");
+    if (client == _managementClient) {
+      _managementClient.reset();
+      _lastManagementSequenceCounterIn = 0;
+      return true;
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void KnxIpForwarder::checkClients(int64_t time) {
+  try {
+    if (time - _lastClientCheck < 1000) return;
+    _lastClientCheck = time;
+
+    bool disconnectManagement = false;
+    {
+      std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+      for (auto clientIterator = _clients.begin(); clientIterator != _clients.end();) {
+        auto client = clientIterator->second;
+        clientIterator++;
+        if (time - client->lastPacketReceived > _clientTimeout) {
+          _out.printWarning("Warning: No heartbeat received from client " + client->ip + " (channel " + std::to_string(client->channelId) + ").");
+          if (removeClient(client)) disconnectManagement = true;
+        }
+      }
+    }
+    if (disconnectManagement && _interface->managementConnected()) _interface->disconnectManagement();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 void KnxIpForwarder::processRawPacket(const std::string &senderIp, uint16_t senderPort, const std::vector<uint8_t> &data) {
   try {
     auto time = BaseLib::HelperFunctions::getTime();
     auto packet = std::make_shared<KnxIpPacket>(data);
     if (packet->getServiceType() == ServiceType::CONNECT_REQUEST) {
+      auto packetData = packet->getConnectRequest();
+      if (!packetData) return;
       std::vector<uint8_t> rawResponsePacket;
-      if (senderIp != _lastSenderIp && time - _lastPacketReceived < 60000) {
-        uint8_t status = (uint8_t)KnxIpErrorCodes::E_NO_MORE_CONNECTIONS;
+      auto dataEndpointIp = KnxIpPacket::getIpString(packetData->dataEndpointIp);
+      if (packetData->dataEndpointIp != packetData->controlEndpointIp || dataEndpointIp != senderIp) {
+        Gd::out.printError("Error: Can't process connect packet from " + senderIp + ". The IP addresses in the packet (" + dataEndpointIp + " and " + KnxIpPacket::getIpString(packetData->controlEndpointIp)
+                               + ") do not match the sender's IP address. This is currently not supported.");
+        auto status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_OPTION;
+        rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 6, 0, 8, 0, status};
+      } else if (packetData->connectionTypeCode != 3 && packetData->connectionTypeCode != 4) {
+        auto status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_TYPE;
         rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 6, 0, 8, 0, status};
       } else {
-        auto packetData = packet->getConnectRequest();
-        if (!packetData) return;
-        if (packetData->dataEndpointIpString != packetData->controlEndpointIpString || packetData->dataEndpointIpString != senderIp) {
-          Gd::out.printError("Error: Can't process connect packet from " + senderIp + ". The IP addresses in the packet (" + packetData->dataEndpointIpString + " and " + packetData->controlEndpointIpString
-                                 + ") do not match the sender's IP address. This is currently not supported.");
-          auto status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_OPTION;
+        bool management = packetData->connectionTypeCode == 3;
+        std::unique_lock<std::mutex> clientsGuard(_clientsMutex);
+
+        //A client connecting again from the same endpoint lost its connection, so the old one is not used anymore.
+        for (auto &clientEntry : _clients) {
+          if (clientEntry.second->ip == senderIp && clientEntry.second->controlPort == packetData->controlEndpointPort && clientEntry.second->management == management) {
+            removeClient(clientEntry.second);
+            break;
+          }
+        }
+
+        //There is only one management connection to the gateway. The last client requesting it gets it.
+        if (management && _managementClient) removeClient(_managementClient);
+        if (management && _interface->managementConnected()) {
+          //Don't block packetReceivedCallback() while disconnecting. Only this thread adds clients.
+          clientsGuard.unlock();
+          _interface->disconnectManagement();
+          clientsGuard.lock();
+        }
+
+        uint32_t tunnelingClientCount = 0;
+        for (auto &clientEntry : _clients) {
+          if (!clientEntry.second->management) tunnelingClientCount++;
+        }
+
+        uint8_t channelId = (management || tunnelingClientCount < _maxClients) ? getFreeChannelId() : 0;
+        if (channelId == 0) {
+          _out.printWarning("Warning: Rejecting connection from " + senderIp + ", because " + std::to_string(tunnelingClientCount) + " clients are connected already.");
+          auto status = (uint8_t)KnxIpErrorCodes::E_NO_MORE_CONNECTIONS;
           rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 6, 0, 8, 0, status};
         } else {
-          if (packetData->connectionTypeCode == 3 && _interface->managementConnected()) _interface->disconnectManagement();
+          auto client = std::make_shared<Client>();
+          client->ip = senderIp;
+          client->controlPort = packetData->controlEndpointPort;
+          client->dataPort = packetData->dataEndpointPort;
+          client->channelId = channelId;
+          client->management = management;
+          client->lastPacketReceived = time;
+          _clients.emplace(channelId, client);
 
-          _lastSenderIp = senderIp;
-          _lastPacketReceived = time;
-          _senderConfigPort = packetData->controlEndpointPort;
-          _senderDataPort = packetData->dataEndpointPort;
-          auto physicalAddress = _interface->getPhysicalAddress();
           auto status = (uint8_t)KnxIpErrorCodes::E_NO_ERROR;
-          if (packetData->connectionTypeCode == 4) rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 6, 0, 0x14, ++_channelId, status, 8, 1, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], (uint8_t)(_port >> 8),
-                                                                                            (uint8_t)(_port & 0xFF), 4, 4, (uint8_t)(physicalAddress >> 8), (uint8_t)(physicalAddress & 0xFF)};
-          else if (packetData->connectionTypeCode == 3) rawResponsePacket =
-                                                            std::vector<uint8_t>{6, 0x10, 2, 6, 0, 0x12, ++_managementChannelId, status, 8, 1, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], (uint8_t)(_port >> 8),
-                                                                                 (uint8_t)(_port & 0xFF), 2, 3};
-
-          if (packetData->connectionTypeCode == 3) {
-            _managementSequenceCounterOut = 0;
-            _managementConnected = true;
-          } else if (packetData->connectionTypeCode == 4) {
-            _sequenceCounterOut = 0;
-            _connected = true;
+          if (management) {
+            _managementClient = client;
+            rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 6, 0, 0x12, channelId, status, 8, 1, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], (uint8_t)(_port >> 8), (uint8_t)(_port & 0xFF), 2, 3};
+          } else {
+            //All clients share the KNX address of the gateway's tunnel.
+            auto physicalAddress = _interface->getPhysicalAddress();
+            rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 6, 0, 0x14, channelId, status, 8, 1, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], (uint8_t)(_port >> 8), (uint8_t)(_port & 0xFF), 4, 4,
+                                                     (uint8_t)(physicalAddress >> 8), (uint8_t)(physicalAddress & 0xFF)};
           }
-        }
-
-        if (packetData->connectionTypeCode == 3 && !_interface->managementConnected()) {
-          _interface->connectManagement();
+          _out.printInfo("Info: Client " + senderIp + " connected on channel " + std::to_string(channelId) + (management ? " (device management)" : "") + ". " + std::to_string(_clients.size()) + " clients are connected.");
         }
       }
 
-      sendPacket(senderIp, senderPort, std::make_shared<KnxIpPacket>(rawResponsePacket), true);
+      sendPacket(senderIp, senderPort, rawResponsePacket);
+      if (packetData->connectionTypeCode == 3 && rawResponsePacket.size() > 7 && rawResponsePacket.at(7) == (uint8_t)KnxIpErrorCodes::E_NO_ERROR && !_interface->managementConnected()) {
+        _interface->connectManagement();
+      }
       return;
     } else if (packet->getServiceType() == ServiceType::DESCRIPTION_REQUEST) {
-      auto dataCopy = data;
-
-      auto listenIpBytes = _interface->getListenIpBytes();
-      auto listenPortBytes = _interface->getListenPortBytes();
-      //if(dataCopy.at(8) != 0 || dataCopy.at(9) != 0 || dataCopy.at(10) != 0 || dataCopy.at(11) != 0)
-      //{
-      //Always send non-broadcast request
-      dataCopy.at(8) = listenIpBytes.at(0);
-      dataCopy.at(9) = listenIpBytes.at(1);
-      dataCopy.at(10) = listenIpBytes.at(2);
-      dataCopy.at(11) = listenIpBytes.at(3);
-      //}
-      //if(dataCopy.at(12) != 0 || dataCopy.at(13) != 0)
-      //{
-      dataCopy.at(12) = listenPortBytes.at(0);
-      dataCopy.at(13) = listenPortBytes.at(1);
-      //}
-
-      std::vector<uint8_t> rawResponsePacket;
-      _interface->getResponse(ServiceType::DESCRIPTION_RESPONSE, dataCopy, rawResponsePacket);
-      if (rawResponsePacket.empty()) return;
-      sendPacket(senderIp, senderPort, std::make_shared<KnxIpPacket>(rawResponsePacket), true);
+      auto &descriptionResponse = getDescriptionResponse(time);
+      if (descriptionResponse.empty()) return;
+      sendPacket(senderIp, senderPort, descriptionResponse);
       return;
-    }
-
-    /*if (senderIp != _lastSenderIp || (senderPort != _senderConfigPort && senderPort != _senderDataPort)) {
-      _out.printWarning("Warning: Not processing packet, because the client is not connected: " + BaseLib::HelperFunctions::getHexString(data));
+    } else if (packet->getServiceType() == ServiceType::SEARCH_REQUEST) {
+      _searchRequests++;
+      auto &descriptionResponse = getDescriptionResponse(time);
+      if (descriptionResponse.size() <= 6) return;
+
+      //SEARCH_RESPONSE: Our control endpoint followed by the DIBs of the gateway's DESCRIPTION_RESPONSE (section 3.8.2 7.6)
+      uint16_t length = 14 + descriptionResponse.size() - 6;
+      std::vector<uint8_t> searchResponse{6, 0x10, 2, 2, (uint8_t)(length >> 8), (uint8_t)(length & 0xFF), 8, 1, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], (uint8_t)(_port >> 8), (uint8_t)(_port & 0xFF)};
+      searchResponse.insert(searchResponse.end(), descriptionResponse.begin() + 6, descriptionResponse.end());
+
+      //Respond to the discovery endpoint in the request. It is empty when the client is behind a NAT router.
+      std::string responseIp = senderIp;
+      uint16_t responsePort = senderPort;
+      if (data.size() >= 14 && (data.at(8) != 0 || data.at(9) != 0 || data.at(10) != 0 || data.at(11) != 0) && (data.at(12) != 0 || data.at(13) != 0)) {
+        responseIp = std::to_string(data.at(8)) + "." + std::to_string(data.at(9)) + "." + std::to_string(data.at(10)) + "." + std::to_string(data.at(11));
+        responsePort = (((uint16_t)data.at(12)) << 8) | data.at(13);
+      }
+      sendPacket(responseIp, responsePort, searchResponse);
       return;
-    }*/
+    }
 
     if (packet->getServiceType() == ServiceType::CONNECTIONSTATE_REQUEST) {
       auto packetData = packet->getConnectionStateRequest();
       if (!packetData) return;
 
       auto status = (uint8_t)KnxIpErrorCodes::E_NO_ERROR;
-      if (packetData->channelId != _channelId && packetData->channelId != _managementChannelId) status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_ID;
-      else _lastPacketReceived = time;
+      uint16_t controlPort = senderPort;
+      {
+        std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+        auto client = getClient(packetData->channelId);
+        if (!client || client->ip != senderIp) status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_ID;
+        else {
+          client->lastPacketReceived = time;
+          controlPort = client->controlPort;
+        }
+      }
 
       std::vector<uint8_t> rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 8, 0, 8, packetData->channelId, status};
-      sendPacket(senderIp, _senderConfigPort, std::make_shared<KnxIpPacket>(rawResponsePacket));
+      sendPacket(senderIp, controlPort, rawResponsePacket);
     } else if (packet->getServiceType() == ServiceType::DISCONNECT_REQUEST) {
       auto packetData = packet->getDisconnectRequest();
       if (!packetData) return;
 
       auto status = (uint8_t)KnxIpErrorCodes::E_NO_ERROR;
-      if (packetData->channelId != _channelId && packetData->channelId != _managementChannelId) status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_ID;
+      bool disconnectManagement = false;
+      {
+        std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+        auto client = getClient(packetData->channelId);
+        if (!client || client->ip != senderIp) status = (uint8_t)KnxIpErrorCodes::E_CONNECTION_ID;
+        else disconnectManagement = removeClient(client);
+      }
 
       std::vector<uint8_t> rawResponsePacket = std::vector<uint8_t>{6, 0x10, 2, 0x0A, 0, 8, packetData->channelId, status};
-      sendPacket(senderIp, senderPort, std::make_shared<KnxIpPacket>(rawResponsePacket), true);
+      sendPacket(senderIp, senderPort, rawResponsePacket);
+      if (disconnectManagement && _interface->managementConnected()) _interface->disconnectManagement();
+    } else if (packet->getServiceType() == ServiceType::TUNNELING_REQUEST) {
+      auto packetData = packet->getTunnelingRequest();
+      if (!packetData || !packetData->cemi) return;
+      uint8_t clientChannelId = packetData->channelId;
+      uint8_t clientSequenceCounter = packetData->sequenceCounter;
+
+      {
+        std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+        auto client = getClient(clientChannelId);
+        if (!client || client->management || client->ip != senderIp) {
+          _out.printWarning("Warning: Dropping tunneling request of unknown channel " + std::to_string(clientChannelId) + " from " + senderIp + ".");
+          return;
+        }
+        client->lastPacketReceived = time;
 
-      if (packetData->channelId == _managementChannelId) {
-        _managementConnected = false;
-        if (_interface->managementConnected()) _interface->disconnectManagement();
-        _lastManagementSequenceCounterIn = 0;
-      } else if (packetData->channelId != _channelId) _connected = false;
+        //See section 3.8.4 2.6: Acknowledge repeated requests again, but don't process them.
+        bool repeated = clientSequenceCounter == (uint8_t)(client->sequenceCounterIn - 1);
+        if (!repeated && clientSequenceCounter != client->sequenceCounterIn) {
+          _out.printWarning("Warning: Dropping tunneling request from " + senderIp + " with unexpected sequence counter " + std::to_string(clientSequenceCounter) + ".");
+          return;
+        }
 
-      if (status == (uint8_t)KnxIpErrorCodes::E_NO_ERROR && !_managementConnected && !_connected) {
-        _lastPacketReceived = 0;
-        _lastSenderIp = "";
+        //The request is acknowledged as soon as it is queued. The L_Data.con tells the client whether it was sent.
+        sendPacket(senderIp, senderPort, std::vector<uint8_t>{6, 0x10, 4, 0x21, 0, 0x0A, 4, clientChannelId, clientSequenceCounter, (uint8_t)KnxIpErrorCodes::E_NO_ERROR});
+        if (repeated) return;
+        client->sequenceCounterIn++;
+
+        if (packetData->cemi->getMessageCode() != 0x11) { //L_Data.req
+          _out.printWarning("Warning: Dropping tunneling request from " + senderIp + " with unsupported message code " + BaseLib::HelperFunctions::getHexString(packetData->cemi->getMessageCode(), 2) + ".");
+          return;
+        }
+        _forwardedFrames.emplace(packetData->cemi.get());
       }
-    } else if (packet->getServiceType() == ServiceType::TUNNELING_REQUEST) {
-      auto packetData = packet->getTunnelingRequest();
-      if (!packetData) return;
-      auto sendPacketLock = _interface->getSendPacketLock();
-      sendPacketLock.lock();
-      packetData->channelId = _interface->getChannelId();
-      uint8_t storedSequenceCounter = packetData->sequenceCounter;
-      packetData->sequenceCounter = _interface->getSequenceCounter();
-      _interface->incrementSequenceCounter();
-      packet->clearBinaryCache();
 
-      std::vector<uint8_t> rawResponsePacket;
-      _interface->getResponse(ServiceType::TUNNELING_ACK, packet->getBinary(), rawResponsePacket);
-      if (rawResponsePacket.empty()) return;
-      auto responsePacket = std::make_shared<KnxIpPacket>(rawResponsePacket);
-      auto responsePacketData = responsePacket->getTunnelingAck();
-      if (!responsePacketData) return;
-      responsePacketData->channelId = _channelId;
-      responsePacketData->sequenceCounter = storedSequenceCounter;
-      responsePacket->clearBinaryCache();
-      sendPacket(senderIp, senderPort, responsePacket);
+      //The frame is queued like the packets of the central, so forwarded packets don't block the listen thread and are
+      //sent in order with all other packets.
+      auto cemi = packetData->cemi;
+      auto result = _interface->queuePacket(cemi, [this, clientChannelId, cemi](MainInterface::SendResult result) {
+        sendConfirmation(clientChannelId, cemi, result == MainInterface::SendResult::success);
+      });
+      if (result != MainInterface::SendResult::queued) {
+        {
+          std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+          _forwardedFrames.erase(cemi.get());
+        }
+        _out.printWarning("Warning: Could not forward packet from " + senderIp + ": " + MainInterface::getSendResultString(result));
+        sendConfirmation(clientChannelId, cemi, false);
+      }
+    } else if (packet->getServiceType() == ServiceType::TUNNELING_ACK) {
+      //Acknowledgement of a packet sent by packetReceivedCallback(). Lost packets are not repeated.
+      std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+      auto client = data.size() > 7 ? getClient(data.at(7)) : PClient();
+      if (client) client->lastPacketReceived = time;
     } else if (packet->getServiceType() == ServiceType::CONFIG_REQUEST) {
+      uint8_t managementChannelId = 0;
+      {
+        std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+        if (!_managementClient || data.size() < 9 || data.at(7) != _managementClient->channelId) return;
+        _managementClient->lastPacketReceived = time;
+        managementChannelId = _managementClient->channelId;
+      }
+
       auto sendPacketLock = _interface->getSendPacketLock();
       sendPacketLock.lock();
       auto dataCopy = data;
@@ -362,11 +550,20 @@ void KnxIpForwarder::processRawPacket(const std::string &senderIp, uint16_t send
 
       std::vector<uint8_t> rawResponsePacket;
       _interface->getResponse(ServiceType::CONFIG_ACK, dataCopy, rawResponsePacket);
+      sendPacketLock.unlock();
       if (rawResponsePacket.empty()) return;
-      rawResponsePacket.at(7) = _managementChannelId;
+      rawResponsePacket.at(7) = managementChannelId;
       rawResponsePacket.at(8) = storedSequenceCounter;
-      sendPacket(senderIp, senderPort, std::make_shared<KnxIpPacket>(rawResponsePacket));
+      sendPacket(senderIp, senderPort, rawResponsePacket);
     } else if (packet->getServiceType() == ServiceType::CONFIG_ACK) {
+      {
+        std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+        if (!_managementClient || data.size() < 9 || data.at(7) != _managementClient->channelId) return;
+        _managementClient->lastPacketReceived = time;
+      }
+
+      //There are no DEVICE_CONFIGURATION_ACKs over TCP, so the gateway doesn't expect one.
+      if (_interface->getHostProtocolCode() == 0x02) return;
       auto dataCopy = data;
       dataCopy.at(7) = _interface->getManagementChannelId();
       dataCopy.at(8) = _lastManagementSequenceCounterOut;
@@ -378,18 +575,54 @@ void KnxIpForwarder::processRawPacket(const std::string &senderIp, uint16_t send
   }
 }
 
-void KnxIpForwarder::sendPacket(const std::string &destinationIp, uint16_t destinationPort, const PKnxIpPacket &packet, bool forceSending) {
+const std::vector<uint8_t> &KnxIpForwarder::getDescriptionResponse(int64_t time) {
   try {
-    if (!forceSending && ((!_managementConnected && !_connected) || BaseLib::HelperFunctions::getTime() - _lastPacketReceived > 300000)) return;
+    bool invalidated = _descriptionInvalidated.exchange(false);
+    if (!_descriptionResponse.empty() && !invalidated && _descriptionCacheTime > 0 && time - _descriptionResponseTime < _descriptionCacheTime) {
+      _descriptionCacheHits++;
+      return _descriptionResponse;
+    }
+    _descriptionCacheMisses++;
+
+    //DESCRIPTION_REQUEST with the control endpoint of the interface, so the gateway responds to the interface
+    auto listenIpBytes = _interface->getListenIpBytes();
+    auto listenPortBytes = _interface->getListenPortBytes();
+    std::vector<uint8_t> request{6, 0x10, 2, 3, 0, 0x0E, 8, _interface->getHostProtocolCode(), listenIpBytes.at(0), listenIpBytes.at(1), listenIpBytes.at(2), listenIpBytes.at(3), listenPortBytes.at(0), listenPortBytes.at(1)};
+
+    std::vector<uint8_t> response;
+    _interface->getResponse(ServiceType::DESCRIPTION_RESPONSE, request, response);
+    if (response.size() <= 6) {
+      _descriptionRequestsFailed++;
+      if (!_descriptionResponse.empty()) _out.printWarning("Warning: Could not get description from gateway. Using the cached one.");
+      //Try again with the next request.
+      _descriptionInvalidated = true;
+      return _descriptionResponse;
+    }
+
+    _descriptionResponse = std::move(response);
+    _descriptionResponseTime = time;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return _descriptionResponse;
+}
+
+void KnxIpForwarder::sendPacket(const std::string &destinationIp, uint16_t destinationPort, const PKnxIpPacket &packet) {
+  sendPacket(destinationIp, destinationPort, packet->getBinary());
+}
+
+void KnxIpForwarder::sendPacket(const std::string &destinationIp, uint16_t destinationPort, const std::vector<uint8_t> &packet) {
+  try {
+    if (!_serverSocketDescriptor || packet.empty()) return;
 
     struct sockaddr_in addessInfo{};
     addessInfo.sin_family = AF_INET;
     addessInfo.sin_addr.s_addr = inet_addr(destinationIp.c_str());
     addessInfo.sin_port = htons(destinationPort);
 
-    auto rawPacket = packet->getBinary();
-    _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(rawPacket));
-    if (sendto(_serverSocketDescriptor->descriptor, (char *)rawPacket.data(), rawPacket.size(), 0, (struct sockaddr *)&addessInfo, sizeof(addessInfo)) == -1) {
+    if (Gd::bl->debugLevel >= 4) _out.printInfo("Info: Sending packet to " + destinationIp + ": " + BaseLib::HelperFunctions::getHexString(packet));
+    if (sendto(_serverSocketDescriptor->descriptor, (char *)packet.data(), packet.size(), 0, (struct sockaddr *)&addessInfo, sizeof(addessInfo)) == -1) {
       _out.printWarning("Warning: Error sending: " + std::string(strerror(errno)));
     }
   }
@@ -401,6 +634,90 @@ void KnxIpForwarder::sendPacket(const std::string &destinationIp, uint16_t desti
 void KnxIpForwarder::reconnectedCallback() {
   try {
     _lastManagementSequenceCounterIn = 0;
+    //The gateway might have been replaced or reconfigured.
+    _descriptionInvalidated = true;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void KnxIpForwarder::sendToTunnelingClients(Cemi &cemi, uint8_t excludedChannelId) {
+  try {
+    for (auto &clientEntry : _clients) {
+      auto &client = clientEntry.second;
+      if (client->management || client->channelId == excludedChannelId) continue;
+      _sendBuffer.clear();
+      KnxIpPacket::appendTunnelingRequest(_sendBuffer, client->channelId, client->sequenceCounterOut++, cemi);
+      sendPacket(client->ip, client->dataPort, _sendBuffer);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void KnxIpForwarder::sendConfirmation(uint8_t channelId, const PCemi &cemi, bool success) {
+  try {
+    std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+    _forwardedFrames.erase(cemi.get());
+    auto client = getClient(channelId);
+    if (!client) return;
+
+    //Copy the frame, it might still be used by the interface.
+    Cemi confirmation(cemi->getBinary());
+    confirmation.setMessageCode(0x2E); //L_Data.con
+    confirmation.setConfirmationError(!success);
+    _sendBuffer.clear();
+    KnxIpPacket::appendTunnelingRequest(_sendBuffer, client->channelId, client->sequenceCounterOut++, confirmation);
+    sendPacket(client->ip, client->dataPort, _sendBuffer);
+
+    if (!success) return;
+    //The other clients receive the frame as L_Data.ind as they would from a bus with several tunnels.
+    confirmation.setMessageCode(0x29);
+    sendToTunnelingClients(confirmation, channelId);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void KnxIpForwarder::packetSentCallback(const PCemi &cemi) {
+  try {
+    std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+    if (_clients.empty() || _forwardedFrames.find(cemi.get()) != _forwardedFrames.end()) return;
+
+    //Copy the frame, it is still used by the interface.
+    Cemi indication(cemi->getBinary());
+    indication.setMessageCode(0x29); //L_Data.ind
+    if (indication.getSourceAddress() == 0) indication.setSourceAddress(_interface->getPhysicalAddress());
+    sendToTunnelingClients(indication, 0);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void KnxIpForwarder::sendToMulticastGroup(const PCemi &cemi) {
+  try {
+    if (!cemi->isGroupAddressed() || (_multicastExportFilter && !_multicastExportFilter->contains(cemi->getDestinationAddress()))) {
+      _multicastPacketsFiltered++;
+      return;
+    }
+
+    auto hopCount = cemi->getHopCount();
+    if (hopCount == 0 || cemi->isRepetition()) {
+      _multicastPacketsNotRouted++;
+      return;
+    }
+
+    //Copy the frame, it is still used by the central.
+    Cemi frame(cemi->getBinary());
+    if (hopCount < 7) frame.setHopCount(hopCount - 1);
+    _multicastBuffer.clear();
+    KnxIpPacket::appendRoutingIndication(_multicastBuffer, frame);
+    sendPacket(_multicastGroup, _multicastPort, _multicastBuffer);
+    _multicastPacketsSent++;
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -411,17 +728,26 @@ void KnxIpForwarder::packetReceivedCallback(const PKnxIpPacket &packet) {
   try {
     if (packet->getServiceType() == ServiceType::TUNNELING_REQUEST) {
       auto packetData = packet->getTunnelingRequest();
-      if (!packetData) return;
-      packetData->channelId = _channelId;
-      packetData->sequenceCounter = _sequenceCounterOut++;
-      packet->clearBinaryCache();
-      sendPacket(_lastSenderIp, _senderDataPort, packet);
+      if (!packetData || !packetData->cemi) return;
+      auto &cemi = packetData->cemi;
+
+      if (!_multicastGroup.empty() && cemi->getMessageCode() == 0x29) sendToMulticastGroup(cemi);
+
+      std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+      if (_clients.empty()) return;
+
+      //Confirmations are sent by sendConfirmation() for frames of clients and by packetSentCallback() for frames of
+      //Homegear. Depending on the confirmation policy and the tunnel used, the interface doesn't pass them here.
+      if (cemi->getMessageCode() == 0x2E) return; //L_Data.con
+      sendToTunnelingClients(*cemi, 0);
     } else if (packet->getServiceType() == ServiceType::CONFIG_REQUEST) {
+      std::lock_guard<std::mutex> clientsGuard(_clientsMutex);
+      if (!_managementClient) return;
       auto data = packet->getBinary();
-      data.at(7) = _managementChannelId;
+      data.at(7) = _managementClient->channelId;
       _lastManagementSequenceCounterOut = data.at(8);
-      data.at(8) = _managementSequenceCounterOut++;
-      sendPacket(_lastSenderIp, _senderDataPort, std::make_shared<KnxIpPacket>(data));
+      data.at(8) = _managementClient->sequenceCounterOut++;
+      sendPacket(_managementClient->ip, _managementClient->dataPort, data);
     }
   }
   catch (const std::exception &ex) {
@@ -7,19 +7,45 @@
 
 #include <homegear-base/BaseLib.h>
 #include "KnxIpPacket.h"
+#include "GroupAddressFilter.h"
 
 namespace Knx {
 
 class MainInterface;
 
+/**
+ * KNXnet/IP tunneling server forwarding the packets of several clients to the tunnel of one interface. Every client gets its
+ * own channel with its own sequence counters and heartbeat. Packets received from the bus are sent to every connected
+ * tunneling client. Only one client can open a device management connection at a time.
+ *
+ * Optionally all group telegrams received from the bus are also sent to a multicast group as ROUTING_INDICATION, so any
+ * number of listeners can receive them without a connection.
+ */
 class KnxIpForwarder {
  public:
-  KnxIpForwarder(std::string listenIp, uint16_t port, std::shared_ptr<MainInterface> interface);
+  KnxIpForwarder(std::string listenIp, uint16_t port, std::shared_ptr<MainInterface> interface, const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings);
   ~KnxIpForwarder();
 
   void startListening();
   void stopListening();
+
+  BaseLib::PVariable getStatistics();
  protected:
+  struct Client {
+    std::string ip;
+    uint16_t controlPort = 0;
+    uint16_t dataPort = 0;
+    uint8_t channelId = 0;
+    bool management = false;
+    uint8_t sequenceCounterIn = 0; //The sequence counter expected in the next request from the client
+    uint8_t sequenceCounterOut = 0;
+    int64_t lastPacketReceived = 0;
+  };
+  typedef std::shared_ptr<Client> PClient;
+
+  //Clients not sending any packet (normally CONNECTIONSTATE_REQUEST) within this time are disconnected. See section 3.8.2 5.4.
+  static constexpr int64_t _clientTimeout = 120000;
+
   BaseLib::Output _out;
   std::shared_ptr<BaseLib::FileDescriptor> _serverSocketDescriptor;
 
@@ -31,16 +57,41 @@ class KnxIpForwarder {
   std::thread _listenThread;
   std::atomic_bool _stopThreads{false};
 
-  std::atomic_bool _connected{false};
-  std::atomic_bool _managementConnected{false};
-  int64_t _lastPacketReceived = 0;
-  std::string _lastSenderIp;
-  uint16_t _senderConfigPort = 0;
-  uint16_t _senderDataPort = 0;
-  uint8_t _channelId = 0;
-  uint8_t _managementChannelId = 0;
-  uint8_t _sequenceCounterOut = 0;
-  uint8_t _managementSequenceCounterOut = 0;
+  //{{{ Clients, protected by _clientsMutex
+  std::mutex _clientsMutex;
+  uint32_t _maxClients = 8;
+  std::map<uint8_t, PClient> _clients; //By channel ID
+  uint8_t _lastChannelId = 0;
+  PClient _managementClient;
+  std::unordered_set<const Cemi *> _forwardedFrames; //Frames of clients in the send queue. They are confirmed by sendConfirmation().
+  std::vector<uint8_t> _sendBuffer; //Reused when sending the same packet to all clients
+  //}}}
+  int64_t _lastClientCheck = 0;
+
+  //{{{ Cached DESCRIPTION_RESPONSE of the gateway. Only used by the listen thread.
+  int64_t _descriptionCacheTime = 300000; //In milliseconds, 0 disables the cache
+  std::vector<uint8_t> _descriptionResponse;
+  std::atomic<int64_t> _descriptionResponseTime{0};
+  std::atomic_bool _descriptionInvalidated{false}; //Set on reconnect
+  //}}}
+
+  //{{{ Multicast fan-out
+  std::string _multicastGroup; //Empty when disabled
+  uint16_t _multicastPort = 3671;
+  std::unique_ptr<GroupAddressFilter> _multicastExportFilter; //nullptr exports all group addresses
+  std::vector<uint8_t> _multicastBuffer; //Only used by packetReceivedCallback()
+  //}}}
+
+  //{{{ Statistics
+  std::atomic<uint64_t> _descriptionCacheHits{0};
+  std::atomic<uint64_t> _descriptionCacheMisses{0};
+  std::atomic<uint64_t> _descriptionRequestsFailed{0};
+  std::atomic<uint64_t> _searchRequests{0};
+  std::atomic<uint64_t> _multicastPacketsSent{0};
+  std::atomic<uint64_t> _multicastPacketsFiltered{0};
+  std::atomic<uint64_t> _multicastPacketsNotRouted{0};
+  //}}}
+
   std::atomic_uchar _lastManagementSequenceCounterIn{0};
   std::atomic_uchar _lastManagementSequenceCounterOut{0};
 
@@ -49,8 +100,53 @@ class KnxIpForwarder {
   void reconnectedCallback();
   void listen();
   std::shared_ptr<BaseLib::FileDescriptor> getSocketDescriptor();
+
+  //{{{ _clientsMutex needs to be locked when calling these methods.
+  PClient getClient(uint8_t channelId);
+  uint8_t getFreeChannelId();
+  /**
+   * @return Returns true when the management client was removed. The caller needs to disconnect the management connection
+   * of the interface after unlocking _clientsMutex then.
+   *
+   * @param client Taken by value, because callers may pass a reference to the entry in _clients, which is erased here.
+   */
+  bool removeClient(PClient client);
+  void sendToTunnelingClients(Cemi &cemi, uint8_t excludedChannelId);
+  //}}}
+
+  /**
+   * Disconnects clients without heartbeat.
+   */
+  void checkClients(int64_t time);
+
+  /**
+   * Returns the DESCRIPTION_RESPONSE of the gateway. It is requested from the gateway when the cache is empty, expired or
+   * the interface reconnected. If the gateway doesn't respond, the last response is returned.
+   *
+   * @return Returns an empty vector when no description is available.
+   */
+  const std::vector<uint8_t> &getDescriptionResponse(int64_t time);
+
+  /**
+   * Sends the L_Data.con of a forwarded frame to the client. Called when the interface sent the frame.
+   */
+  void sendConfirmation(uint8_t channelId, const PCemi &cemi, bool success);
+
+  /**
+   * Called by the interface's send thread for every frame sent. Frames sent by Homegear are passed to the clients as
+   * L_Data.ind.
+   */
+  void packetSentCallback(const PCemi &cemi);
+
+  /**
+   * Sends an L_Data.ind to the multicast group, if it passes the export filter. Like a KNX router, the hop count is
+   * decremented and frames with a hop count of 0 or repeated frames are not sent, so loops through KNXnet/IP routers
+   * on the same group end.
+   */
+  void sendToMulticastGroup(const PCemi &cemi);
   void processRawPacket(const std::string &senderIp, uint16_t senderPort, const std::vector<uint8_t> &data);
-  void sendPacket(const std::string &destinationIp, uint16_t destinationPort, const PKnxIpPacket &packet, bool forceSending = false);
+  void sendPacket(const std::string &destinationIp, uint16_t destinationPort, const PKnxIpPacket &packet);
+  void sendPacket(const std::string &destinationIp, uint16_t destinationPort, const std::vector<uint8_t> &packet);
 };
 
 }
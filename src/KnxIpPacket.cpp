@@ -108,124 +108,113 @@ const std::array<std::string, 0x30> KnxIpPacket::_errorCodes
 KnxIpPacket::KnxIpPacket() {
 }
 
-KnxIpPacket::KnxIpPacket(const std::vector<uint8_t> &binaryPacket) {
-  if (binaryPacket.size() < 8) throw InvalidKnxIpPacketException("Packet too small.");
+KnxIpPacket::KnxIpPacket(const uint8_t *binaryPacket, size_t size) {
+  if (size < 8) throw InvalidKnxIpPacketException("Packet too small.");
   // "This constant with value 06h shall identify the KNXnet/IP header as defined in protocol version 1.0."
-  if (binaryPacket.at(0) != 0x06) throw InvalidKnxIpPacketException("Invalid header size.");
+  if (binaryPacket[0] != 0x06) throw InvalidKnxIpPacketException("Invalid header size.");
   // "This constant with value 10h shall identify the KNXnet/IP protocol version 1.0."
-  if (binaryPacket.at(1) != 0x10) throw InvalidKnxIpPacketException("Invalid protocol version.");
-  _serviceType = (ServiceType)((((uint16_t)binaryPacket.at(2)) << 8) | binaryPacket.at(3));
-  _length = (((uint16_t)binaryPacket.at(4)) << 8) | binaryPacket.at(5);
-  if (binaryPacket.size() != _length) throw InvalidKnxIpPacketException("Invalid packet length.");
+  if (binaryPacket[1] != 0x10) throw InvalidKnxIpPacketException("Invalid protocol version.");
+  _serviceType = (ServiceType)readUInt16(binaryPacket + 2);
+  _length = readUInt16(binaryPacket + 4);
+  if (size != _length) throw InvalidKnxIpPacketException("Invalid packet length.");
   if (_serviceType == ServiceType::TUNNELING_REQUEST) {
-    if (binaryPacket.size() < 10) throw InvalidKnxIpPacketException("Packet too small.");
-    if (binaryPacket.at(6) != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
-    _tunnelingRequest = std::make_shared<TunnelingRequest>();
-    _tunnelingRequest->channelId = binaryPacket.at(7);
-    _tunnelingRequest->sequenceCounter = binaryPacket.at(8);
+    if (size < 10) throw InvalidKnxIpPacketException("Packet too small.");
+    if (binaryPacket[6] != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
+    _tunnelingRequest.channelId = binaryPacket[7];
+    _tunnelingRequest.sequenceCounter = binaryPacket[8];
     //Byte 9 is reserved
-    if (binaryPacket.size() >= 10) {
-      std::vector<uint8_t> cemi(binaryPacket.begin() + 10, binaryPacket.end());
-      _tunnelingRequest->cemi = std::make_shared<Cemi>(cemi);
-    } else _tunnelingRequest->cemi = std::make_shared<Cemi>();
+    _tunnelingRequest.cemi = std::make_shared<Cemi>(binaryPacket + 10, size - 10);
   } else if (_serviceType == ServiceType::TUNNELING_ACK) {
-    if (binaryPacket.size() < 10) throw InvalidKnxIpPacketException("Packet too small.");
-    if (binaryPacket.at(6) != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
-    _tunnelingAck = std::make_shared<TunnelingAck>();
-    _tunnelingAck->channelId = binaryPacket.at(7);
-    _tunnelingAck->sequenceCounter = binaryPacket.at(8);
-    _tunnelingAck->status = (KnxIpErrorCodes)binaryPacket.at(9);
+    if (size < 10) throw InvalidKnxIpPacketException("Packet too small.");
+    if (binaryPacket[6] != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
+    _tunnelingAck.channelId = binaryPacket[7];
+    _tunnelingAck.sequenceCounter = binaryPacket[8];
+    _tunnelingAck.status = (KnxIpErrorCodes)binaryPacket[9];
+  } else if (_serviceType == ServiceType::ROUTING_INDICATION) {
+    //Routing packets have no connection header (section 3.8.5 of the KNX Standard)
+    _routingIndication.cemi = std::make_shared<Cemi>(binaryPacket + 6, size - 6);
+  } else if (_serviceType == ServiceType::ROUTING_LOST_MESSAGE) {
+    if (size < 10) throw InvalidKnxIpPacketException("Packet too small.");
+    if (binaryPacket[6] != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
+    _routingLostMessage.deviceState = binaryPacket[7];
+    _routingLostMessage.lostMessages = readUInt16(binaryPacket + 8);
+  } else if (_serviceType == ServiceType::ROUTING_BUSY) {
+    if (size < 12) throw InvalidKnxIpPacketException("Packet too small.");
+    if (binaryPacket[6] != 6) throw InvalidKnxIpPacketException("Invalid structure length.");
+    _routingBusy.deviceState = binaryPacket[7];
+    _routingBusy.waitTime = readUInt16(binaryPacket + 8);
+    _routingBusy.controlField = readUInt16(binaryPacket + 10);
   } else if (_serviceType == ServiceType::CONNECT_REQUEST) {
-    if (binaryPacket.size() < 24) throw InvalidKnxIpPacketException("Packet too small.");
-    _connectRequest = std::make_shared<ConnectRequest>();
-    _connectRequest->controlHostProtocolCode = binaryPacket.at(7);
-    std::array<uint32_t, 4> ipBytes = {binaryPacket.at(8), binaryPacket.at(9), binaryPacket.at(10), binaryPacket.at(11)};
-    _connectRequest->controlEndpointIp = (ipBytes[0] << 24) | (ipBytes[1] << 16) | (ipBytes[2] << 8) | ipBytes[3];
-    _connectRequest->controlEndpointIpString = std::to_string(ipBytes[0]).append(".").append(std::to_string(ipBytes[1])).append(".").append(std::to_string(ipBytes[2])).append(".").append(std::to_string(ipBytes[3]));
-    _connectRequest->controlEndpointPort = (((uint16_t)binaryPacket.at(12)) << 8) | binaryPacket.at(13);
-    _connectRequest->dataHostProtocolCode = binaryPacket.at(15);
-    ipBytes = {binaryPacket.at(16), binaryPacket.at(17), binaryPacket.at(18), binaryPacket.at(19)};
-    _connectRequest->dataEndpointIp = (ipBytes[0] << 24) | (ipBytes[1] << 16) | (ipBytes[2] << 8) | ipBytes[3];
-    _connectRequest->dataEndpointIpString = std::to_string(ipBytes[0]).append(".").append(std::to_string(ipBytes[1])).append(".").append(std::to_string(ipBytes[2])).append(".").append(std::to_string(ipBytes[3]));
-    _connectRequest->dataEndpointPort = (((uint16_t)binaryPacket.at(20)) << 8) | binaryPacket.at(21);
-    _connectRequest->connectionTypeCode = binaryPacket.at(23);
-    if (binaryPacket.size() > 24) {
-      _connectRequest->knxLayer = binaryPacket.at(24);
+    if (size < 24) throw InvalidKnxIpPacketException("Packet too small.");
+    _connectRequest.controlHostProtocolCode = binaryPacket[7];
+    _connectRequest.controlEndpointIp = readIp(binaryPacket + 8);
+    _connectRequest.controlEndpointPort = readUInt16(binaryPacket + 12);
+    _connectRequest.dataHostProtocolCode = binaryPacket[15];
+    _connectRequest.dataEndpointIp = readIp(binaryPacket + 16);
+    _connectRequest.dataEndpointPort = readUInt16(binaryPacket + 20);
+    _connectRequest.connectionTypeCode = binaryPacket[23];
+    if (size > 24) {
+      _connectRequest.knxLayer = binaryPacket[24];
     }
   } else if (_serviceType == ServiceType::CONNECT_RESPONSE) {
-    _connectResponse = std::make_shared<ConnectResponse>();
-    if (binaryPacket.size() < 8) throw InvalidKnxIpPacketException("Packet too small.");
-    _connectResponse->channelId = binaryPacket.at(6);
-    _connectResponse->status = (KnxIpErrorCodes)binaryPacket.at(7);
-    if (_connectResponse->status == KnxIpErrorCodes::E_NO_ERROR) {
-      if (binaryPacket.size() < 18) throw InvalidKnxIpPacketException("Packet too small.");
-      _connectResponse->hostProtocolCode = binaryPacket.at(9); //1 = IPv4 UDP, 2 = IPv4 TCP
-      std::array<uint32_t, 4> ipBytes = {binaryPacket.at(10), binaryPacket.at(11), binaryPacket.at(12), binaryPacket.at(13)};
-      _connectResponse->dataEndpointIp = (ipBytes[0] << 24) | (ipBytes[1] << 16) | (ipBytes[2] << 8) | ipBytes[3];
-      _connectResponse->dataEndpointIpString = std::to_string(ipBytes[0]).append(".").append(std::to_string(ipBytes[1])).append(".").append(std::to_string(ipBytes[2])).append(".").append(std::to_string(ipBytes[3]));
-      _connectResponse->dataEndpointPort = (((uint16_t)binaryPacket.at(14)) << 8) | binaryPacket.at(15);
-      _connectResponse->connectionTypeCode = binaryPacket.at(17);
-      if (binaryPacket.size() > 19) {
-        _connectResponse->knxAddress = (((uint16_t)binaryPacket.at(18)) << 8) | binaryPacket.at(19);
+    _connectResponse.channelId = binaryPacket[6];
+    _connectResponse.status = (KnxIpErrorCodes)binaryPacket[7];
+    if (_connectResponse.status == KnxIpErrorCodes::E_NO_ERROR) {
+      if (size < 18) throw InvalidKnxIpPacketException("Packet too small.");
+      _connectResponse.hostProtocolCode = binaryPacket[9]; //1 = IPv4 UDP, 2 = IPv4 TCP
+      _connectResponse.dataEndpointIp = readIp(binaryPacket + 10);
+      _connectResponse.dataEndpointPort = readUInt16(binaryPacket + 14);
+      _connectResponse.connectionTypeCode = binaryPacket[17];
+      if (size > 19) {
+        _connectResponse.knxAddress = readUInt16(binaryPacket + 18);
       }
     }
   } else if (_serviceType == ServiceType::DISCONNECT_REQUEST) {
-    if (binaryPacket.size() < 16) throw InvalidKnxIpPacketException("Packet too small.");
-    _disconnectRequest = std::make_shared<DisconnectRequest>();
-    _disconnectRequest->channelId = binaryPacket.at(6);
-    _disconnectRequest->hostProtocolCode = binaryPacket.at(9); //1 = IPv4 UDP, 2 = IPv4 TCP
-    std::array<uint32_t, 4> ipBytes = {binaryPacket.at(10), binaryPacket.at(11), binaryPacket.at(12), binaryPacket.at(13)};
-    _disconnectRequest->controlEndpointIp = (ipBytes[0] << 24) | (ipBytes[1] << 16) | (ipBytes[2] << 8) | ipBytes[3];
-    _disconnectRequest->controlEndpointIpString = std::to_string(ipBytes[0]).append(".").append(std::to_string(ipBytes[1])).append(".").append(std::to_string(ipBytes[2])).append(".").append(std::to_string(ipBytes[3]));
-    _disconnectRequest->controlEndpointPort = (((uint16_t)binaryPacket.at(14)) << 8) | binaryPacket.at(15);
+    if (size < 16) throw InvalidKnxIpPacketException("Packet too small.");
+    _disconnectRequest.channelId = binaryPacket[6];
+    _disconnectRequest.hostProtocolCode = binaryPacket[9]; //1 = IPv4 UDP, 2 = IPv4 TCP
+    _disconnectRequest.controlEndpointIp = readIp(binaryPacket + 10);
+    _disconnectRequest.controlEndpointPort = readUInt16(binaryPacket + 14);
   } else if (_serviceType == ServiceType::DISCONNECT_RESPONSE) {
-    if (binaryPacket.size() < 8) throw InvalidKnxIpPacketException("Packet too small.");
-    _disconnectResponse = std::make_shared<DisconnectResponse>();
-    _disconnectResponse->channelId = binaryPacket.at(6);
-    _disconnectResponse->status = (KnxIpErrorCodes)binaryPacket.at(7);
+    _disconnectResponse.channelId = binaryPacket[6];
+    _disconnectResponse.status = (KnxIpErrorCodes)binaryPacket[7];
   } else if (_serviceType == ServiceType::CONNECTIONSTATE_REQUEST) {
-    if (binaryPacket.size() < 16) throw InvalidKnxIpPacketException("Packet too small.");
-    _connectionStateRequest = std::make_shared<ConnectionStateRequest>();
-    _connectionStateRequest->channelId = binaryPacket.at(6);
-    _connectionStateRequest->hostProtocolCode = binaryPacket.at(9); //1 = IPv4 UDP, 2 = IPv4 TCP
-    std::array<uint32_t, 4> ipBytes = {binaryPacket.at(10), binaryPacket.at(11), binaryPacket.at(12), binaryPacket.at(13)};
-    _connectionStateRequest->controlEndpointIp = (ipBytes[0] << 24) | (ipBytes[1] << 16) | (ipBytes[2] << 8) | ipBytes[3];
-    _connectionStateRequest->controlEndpointIpString = std::to_string(ipBytes[0]).append(".").append(std::to_string(ipBytes[1])).append(".").append(std::to_string(ipBytes[2])).append(".").append(std::to_string(ipBytes[3]));
-    _connectionStateRequest->controlEndpointPort = (((uint16_t)binaryPacket.at(14)) << 8) | binaryPacket.at(15);
+    if (size < 16) throw InvalidKnxIpPacketException("Packet too small.");
+    _connectionStateRequest.channelId = binaryPacket[6];
+    _connectionStateRequest.hostProtocolCode = binaryPacket[9]; //1 = IPv4 UDP, 2 = IPv4 TCP
+    _connectionStateRequest.controlEndpointIp = readIp(binaryPacket + 10);
+    _connectionStateRequest.controlEndpointPort = readUInt16(binaryPacket + 14);
   } else if (_serviceType == ServiceType::CONNECTIONSTATE_RESPONSE) {
-    if (binaryPacket.size() < 8) throw InvalidKnxIpPacketException("Packet too small.");
-    _connectionStateResponse = std::make_shared<ConnectionStateResponse>();
-    _connectionStateResponse->channelId = binaryPacket.at(6);
-    _connectionStateResponse->status = (KnxIpErrorCodes)binaryPacket.at(7);
+    _connectionStateResponse.channelId = binaryPacket[6];
+    _connectionStateResponse.status = (KnxIpErrorCodes)binaryPacket[7];
   } else if (_serviceType == ServiceType::CONFIG_REQUEST) {
-    if (binaryPacket.size() < 10) throw InvalidKnxIpPacketException("Packet too small.");
-    if (binaryPacket.at(6) != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
-    _configRequest = std::make_shared<ConfigRequest>();
-    _configRequest->channelId = binaryPacket.at(7);
-    _configRequest->sequenceCounter = binaryPacket.at(8);
+    if (size < 10) throw InvalidKnxIpPacketException("Packet too small.");
+    if (binaryPacket[6] != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
+    _configRequest.channelId = binaryPacket[7];
+    _configRequest.sequenceCounter = binaryPacket[8];
     //Byte 9 is reserved
-    if (binaryPacket.size() >= 10) {
-      std::vector<uint8_t> cemi(binaryPacket.begin() + 10, binaryPacket.end());
-      _configRequest->cemi = std::make_shared<Cemi>(cemi);
-    } else _configRequest->cemi = std::make_shared<Cemi>();
-  } else if (_serviceType == ServiceType::TUNNELING_ACK) {
-    if (binaryPacket.size() < 10) throw InvalidKnxIpPacketException("Packet too small.");
-    if (binaryPacket.at(6) != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
-    _configAck = std::make_shared<ConfigAck>();
-    _configAck->channelId = binaryPacket.at(7);
-    _configAck->sequenceCounter = binaryPacket.at(8);
-    _configAck->status = (KnxIpErrorCodes)binaryPacket.at(9);
+    _configRequest.cemi = std::make_shared<Cemi>(binaryPacket + 10, size - 10);
+  } else if (_serviceType == ServiceType::CONFIG_ACK) {
+    if (size < 10) throw InvalidKnxIpPacketException("Packet too small.");
+    if (binaryPacket[6] != 4) throw InvalidKnxIpPacketException("Invalid structure length.");
+    _configAck.channelId = binaryPacket[7];
+    _configAck.sequenceCounter = binaryPacket[8];
+    _configAck.status = (KnxIpErrorCodes)binaryPacket[9];
   }
 
-  _rawPacket = binaryPacket;
+  _rawPacket.assign(binaryPacket, binaryPacket + size);
 }
 
 KnxIpPacket::KnxIpPacket(uint8_t channelId, uint8_t sequenceCounter, const PCemi &cemi) : _serviceType(ServiceType::TUNNELING_REQUEST) {
-  _tunnelingRequest = std::make_shared<TunnelingRequest>();
-  _tunnelingRequest->channelId = channelId;
-  _tunnelingRequest->sequenceCounter = sequenceCounter;
-  _tunnelingRequest->cemi = cemi;
-  if (!_tunnelingRequest->cemi) _tunnelingRequest->cemi = std::make_shared<Cemi>();
+  _tunnelingRequest.channelId = channelId;
+  _tunnelingRequest.sequenceCounter = sequenceCounter;
+  _tunnelingRequest.cemi = cemi;
+  if (!_tunnelingRequest.cemi) _tunnelingRequest.cemi = std::make_shared<Cemi>();
+}
+
+KnxIpPacket::KnxIpPacket(const PCemi &cemi) : _serviceType(ServiceType::ROUTING_INDICATION) {
+  _routingIndication.cemi = cemi;
+  if (!_routingIndication.cemi) _routingIndication.cemi = std::make_shared<Cemi>();
 }
 
 BaseLib::PVariable KnxIpPacket::toVariable() {
@@ -233,8 +222,10 @@ BaseLib::PVariable KnxIpPacket::toVariable() {
   packetStruct->structValue->emplace("rawPacket", std::make_shared<BaseLib::Variable>(BaseLib::HelperFunctions::getHexString(_rawPacket)));
   packetStruct->structValue->emplace("serviceType", std::make_shared<BaseLib::Variable>(getServiceIdentifierString()));
 
-  if (_tunnelingRequest && _tunnelingRequest->cemi->getMessageCode() == 0x29) {
-    packetStruct->structValue->emplace("cemi", _tunnelingRequest->cemi->toVariable());
+  if (_serviceType == ServiceType::TUNNELING_REQUEST && _tunnelingRequest.cemi->getMessageCode() == 0x29) {
+    packetStruct->structValue->emplace("cemi", _tunnelingRequest.cemi->toVariable());
+  } else if (_serviceType == ServiceType::ROUTING_INDICATION && _routingIndication.cemi->getMessageCode() == 0x29) {
+    packetStruct->structValue->emplace("cemi", _routingIndication.cemi->toVariable());
   }
 
   return packetStruct;
@@ -245,8 +236,12 @@ std::string KnxIpPacket::getErrorString(KnxIpErrorCodes code) {
   return _errorCodes.at((uint8_t)code);
 }
 
-std::string KnxIpPacket::getServiceIdentifierString() {
-  switch (_serviceType) {
+std::string KnxIpPacket::getIpString(uint32_t ip) {
+  return std::to_string(ip >> 24) + '.' + std::to_string((ip >> 16) & 0xFF) + '.' + std::to_string((ip >> 8) & 0xFF) + '.' + std::to_string(ip & 0xFF);
+}
+
+std::string KnxIpPacket::getServiceIdentifierString(ServiceType serviceType) {
+  switch (serviceType) {
     case ServiceType::UNSET:return "UNSET";
     case ServiceType::SEARCH_REQUEST:return "SEARCH_REQUEST";
     case ServiceType::SEARCH_RESPONSE:return "SEARCH_RESPONSE";
@@ -262,6 +257,7 @@ std::string KnxIpPacket::getServiceIdentifierString() {
     case ServiceType::CONFIG_ACK:return "CONFIG_ACK";
     case ServiceType::TUNNELING_REQUEST:return "TUNNELING_REQUEST";
     case ServiceType::TUNNELING_ACK:return "TUNNELING_ACK";
+    case ServiceType::ROUTING_INDICATION:return "ROUTING_INDICATION";
     case ServiceType::ROUTING_LOST_MESSAGE:return "ROUTING_LOST_MESSAGE";
     case ServiceType::ROUTING_BUSY:return "ROUTING_BUSY";
   }
@@ -270,59 +266,73 @@ std::string KnxIpPacket::getServiceIdentifierString() {
 }
 
 std::vector<uint8_t> KnxIpPacket::getBinary() {
-  if (!_rawPacket.empty()) return _rawPacket;
-  std::vector<uint8_t> packet;
+  if (_rawPacket.empty()) appendBinary(_rawPacket);
+  return _rawPacket;
+}
 
-  if (_serviceType == ServiceType::TUNNELING_REQUEST) //Most probable service type => place at top
-  {
-    if (!_tunnelingRequest) throw InvalidKnxIpPacketException("Packet is not initialized as this service type.");
-    std::vector<uint8_t> cemi = _tunnelingRequest->cemi->getBinary();
-    uint16_t size = 10 + cemi.size();
-    packet.reserve(size);
+void KnxIpPacket::appendHeader(std::vector<uint8_t> &buffer, ServiceType serviceType) {
+  buffer.push_back(0x06); //Header size
+  buffer.push_back(0x10); //Protocol version
+  buffer.push_back((uint16_t)serviceType >> 8);
+  buffer.push_back((uint16_t)serviceType & 0xFF);
+  buffer.push_back(0); //Total length, set by setLength()
+  buffer.push_back(0);
+}
 
-    //{{{ KNXnet/IP header
-    packet.push_back(0x06); //Header size
-    packet.push_back(0x10); //Protocol version
-    packet.push_back((uint16_t)_serviceType >> 8);
-    packet.push_back((uint16_t)_serviceType & 0xFF);
-    packet.push_back((uint8_t)(size >> 8));
-    packet.push_back((uint8_t)(size & 0xFF));
-    //}}}
+void KnxIpPacket::setLength(std::vector<uint8_t> &buffer, size_t offset) {
+  size_t size = buffer.size() - offset;
+  buffer.at(offset + 4) = (uint8_t)(size >> 8);
+  buffer.at(offset + 5) = (uint8_t)(size & 0xFF);
+}
 
-    //{{{Connection header
-    packet.push_back(0x04); //Structure length
-    packet.push_back(_tunnelingRequest->channelId);
-    packet.push_back(_tunnelingRequest->sequenceCounter);
-    packet.push_back(0); //Reserved
-    //}}}
+void KnxIpPacket::appendTunnelingRequest(std::vector<uint8_t> &buffer, uint8_t channelId, uint8_t sequenceCounter, Cemi &cemi) {
+  size_t offset = buffer.size();
 
-    //{{{ Body
-    if (!cemi.empty()) packet.insert(packet.end(), cemi.begin(), cemi.end());
-    //}}}
-  } else if (_serviceType == ServiceType::TUNNELING_ACK) {
-    if (!_tunnelingAck) throw InvalidKnxIpPacketException("Packet is not initialized as this service type.");
-    uint16_t size = 10;
-    packet.reserve(size);
+  appendHeader(buffer, ServiceType::TUNNELING_REQUEST);
 
-    //{{{ KNXnet/IP header
-    packet.push_back(0x06); //Header size
-    packet.push_back(0x10); //Protocol version
-    packet.push_back((uint16_t)_serviceType >> 8);
-    packet.push_back((uint16_t)_serviceType & 0xFF);
-    packet.push_back((uint8_t)(size >> 8));
-    packet.push_back((uint8_t)(size & 0xFF));
-    //}}}
+  //{{{Connection header
+  buffer.push_back(0x04); //Structure length
+  buffer.push_back(channelId);
+  buffer.push_back(sequenceCounter);
+  buffer.push_back(0); //Reserved
+  //}}}
+
+  cemi.appendBinary(buffer);
+
+  setLength(buffer, offset);
+}
+
+void KnxIpPacket::appendRoutingIndication(std::vector<uint8_t> &buffer, Cemi &cemi) {
+  size_t offset = buffer.size();
+  appendHeader(buffer, ServiceType::ROUTING_INDICATION);
+  cemi.appendBinary(buffer);
+  setLength(buffer, offset);
+}
+
+void KnxIpPacket::appendBinary(std::vector<uint8_t> &buffer) {
+  if (!_rawPacket.empty()) {
+    buffer.insert(buffer.end(), _rawPacket.begin(), _rawPacket.end());
+    return;
+  }
+
+  if (_serviceType == ServiceType::TUNNELING_REQUEST) //Most probable service type => place at top
+  {
+    appendTunnelingRequest(buffer, _tunnelingRequest.channelId, _tunnelingRequest.sequenceCounter, *_tunnelingRequest.cemi);
+  } else if (_serviceType == ServiceType::TUNNELING_ACK) {
+    size_t offset = buffer.size();
+    appendHeader(buffer, _serviceType);
 
     //{{{ Connection header
-    packet.push_back(0x04); //Structure length
-    packet.push_back(_tunnelingAck->channelId);
-    packet.push_back(_tunnelingAck->sequenceCounter);
-    packet.push_back((uint8_t)KnxIpErrorCodes::E_NO_ERROR);
+    buffer.push_back(0x04); //Structure length
+    buffer.push_back(_tunnelingAck.channelId);
+    buffer.push_back(_tunnelingAck.sequenceCounter);
+    buffer.push_back((uint8_t)KnxIpErrorCodes::E_NO_ERROR);
     //}}}
-  }
 
-  _rawPacket = std::move(packet);
-  return _rawPacket;
+    setLength(buffer, offset);
+  } else if (_serviceType == ServiceType::ROUTING_INDICATION) {
+    appendRoutingIndication(buffer, *_routingIndication.cemi);
+  }
 }
 
 void KnxIpPacket::clearBinaryCache() {
@@ -36,6 +36,7 @@ enum class ServiceType : uint16_t {
   TUNNELING_REQUEST = 0x0420,
   TUNNELING_ACK = 0x0421,
 
+  ROUTING_INDICATION = 0x0530,
   ROUTING_LOST_MESSAGE = 0x0531,
   ROUTING_BUSY = 0x0532
 };
@@ -59,17 +60,19 @@ enum class KnxIpErrorCodes : uint8_t {
  *
  * The general specification of the KNX IP communication is found in section 3.2.6 of the KNX Standard. The frame format
  * and the core packets are described in section 3.8.2 chapter 7, the tunneling packets in section 3.8.4.
+ *
+ * Packets are parsed directly from the receive buffer. The structure of the service type is stored inside of the object, so
+ * parsing only allocates the raw packet and the cEMI. The getters for the structures return nullptr when the packet has a
+ * different service type.
  */
 class KnxIpPacket : public BaseLib::Systems::Packet {
  public:
   struct ConnectRequest {
     uint8_t controlHostProtocolCode;
     uint32_t controlEndpointIp;
-    std::string controlEndpointIpString;
     uint16_t controlEndpointPort;
     uint8_t dataHostProtocolCode;
     uint32_t dataEndpointIp;
-    std::string dataEndpointIpString;
     uint16_t dataEndpointPort;
     uint8_t connectionTypeCode;
     uint8_t knxLayer;
@@ -80,7 +83,6 @@ class KnxIpPacket : public BaseLib::Systems::Packet {
     KnxIpErrorCodes status;
     uint8_t hostProtocolCode;
     uint32_t dataEndpointIp;
-    std::string dataEndpointIpString;
     uint16_t dataEndpointPort;
     uint8_t connectionTypeCode;
     uint16_t knxAddress;
@@ -90,7 +92,6 @@ class KnxIpPacket : public BaseLib::Systems::Packet {
     uint8_t channelId;
     uint8_t hostProtocolCode;
     uint32_t controlEndpointIp;
-    std::string controlEndpointIpString;
     uint16_t controlEndpointPort;
   };
 
@@ -103,7 +104,6 @@ class KnxIpPacket : public BaseLib::Systems::Packet {
     uint8_t channelId;
     uint8_t hostProtocolCode;
     uint32_t controlEndpointIp;
-    std::string controlEndpointIpString;
     uint16_t controlEndpointPort;
   };
 
@@ -136,50 +136,107 @@ class KnxIpPacket : public BaseLib::Systems::Packet {
     KnxIpErrorCodes status;
   };
 
+  struct RoutingIndication {
+    PCemi cemi;
+  };
+
+  struct RoutingLostMessage {
+    uint8_t deviceState;
+    uint16_t lostMessages;
+  };
+
+  struct RoutingBusy {
+    uint8_t deviceState;
+    uint16_t waitTime; //In milliseconds
+    uint16_t controlField;
+  };
+
   KnxIpPacket();
-  explicit KnxIpPacket(const std::vector<uint8_t> &binaryPacket);
+  explicit KnxIpPacket(const std::vector<uint8_t> &binaryPacket) : KnxIpPacket(binaryPacket.data(), binaryPacket.size()) {}
+  KnxIpPacket(const uint8_t *binaryPacket, size_t size);
   KnxIpPacket(uint8_t channelId, uint8_t sequenceCounter, const PCemi &cemi);
+
+  /**
+   * Creates a ROUTING_INDICATION.
+   */
+  explicit KnxIpPacket(const PCemi &cemi);
   virtual ~KnxIpPacket() = default;
 
   BaseLib::PVariable toVariable() override;
 
   ServiceType getServiceType() { return _serviceType; }
-  std::string getServiceIdentifierString();
+  std::string getServiceIdentifierString() { return getServiceIdentifierString(_serviceType); }
+  static std::string getServiceIdentifierString(ServiceType serviceType);
 
   std::vector<uint8_t> getBinary();
+
+  /**
+   * Appends the binary packet to "buffer". Use this with a reused buffer to avoid allocations.
+   */
+  void appendBinary(std::vector<uint8_t> &buffer);
+
+  /**
+   * Appends a TUNNELING_REQUEST to "buffer" without creating a KnxIpPacket.
+   */
+  static void appendTunnelingRequest(std::vector<uint8_t> &buffer, uint8_t channelId, uint8_t sequenceCounter, Cemi &cemi);
+
+  /**
+   * Appends a ROUTING_INDICATION to "buffer" without creating a KnxIpPacket.
+   */
+  static void appendRoutingIndication(std::vector<uint8_t> &buffer, Cemi &cemi);
   void clearBinaryCache();
   static std::string getErrorString(KnxIpErrorCodes code);
+  static std::string getIpString(uint32_t ip);
 
-  std::shared_ptr<ConnectRequest> getConnectRequest() { return _connectRequest; }
-  std::shared_ptr<ConnectResponse> getConnectResponse() { return _connectResponse; }
-  std::shared_ptr<ConnectionStateRequest> getConnectionStateRequest() { return _connectionStateRequest; }
-  std::shared_ptr<ConnectionStateResponse> getConnectionStateResponse() { return _connectionStateResponse; }
-  std::shared_ptr<DisconnectRequest> getDisconnectRequest() { return _disconnectRequest; }
-  std::shared_ptr<DisconnectResponse> getDisconnectResponse() { return _disconnectResponse; }
+  ConnectRequest *getConnectRequest() { return _serviceType == ServiceType::CONNECT_REQUEST ? &_connectRequest : nullptr; }
+  ConnectResponse *getConnectResponse() { return _serviceType == ServiceType::CONNECT_RESPONSE ? &_connectResponse : nullptr; }
+  ConnectionStateRequest *getConnectionStateRequest() { return _serviceType == ServiceType::CONNECTIONSTATE_REQUEST ? &_connectionStateRequest : nullptr; }
+  ConnectionStateResponse *getConnectionStateResponse() { return _serviceType == ServiceType::CONNECTIONSTATE_RESPONSE ? &_connectionStateResponse : nullptr; }
+  DisconnectRequest *getDisconnectRequest() { return _serviceType == ServiceType::DISCONNECT_REQUEST ? &_disconnectRequest : nullptr; }
+  DisconnectResponse *getDisconnectResponse() { return _serviceType == ServiceType::DISCONNECT_RESPONSE ? &_disconnectResponse : nullptr; }
 
-  std::shared_ptr<ConfigRequest> getConfigRequest() { return _configRequest; }
-  std::shared_ptr<ConfigAck> getConfigAck() { return _configAck; }
+  ConfigRequest *getConfigRequest() { return _serviceType == ServiceType::CONFIG_REQUEST ? &_configRequest : nullptr; }
+  ConfigAck *getConfigAck() { return _serviceType == ServiceType::CONFIG_ACK ? &_configAck : nullptr; }
 
-  std::shared_ptr<TunnelingRequest> getTunnelingRequest() { return _tunnelingRequest; }
-  std::shared_ptr<TunnelingAck> getTunnelingAck() { return _tunnelingAck; }
+  TunnelingRequest *getTunnelingRequest() { return _serviceType == ServiceType::TUNNELING_REQUEST ? &_tunnelingRequest : nullptr; }
+  TunnelingAck *getTunnelingAck() { return _serviceType == ServiceType::TUNNELING_ACK ? &_tunnelingAck : nullptr; }
+
+  RoutingIndication *getRoutingIndication() { return _serviceType == ServiceType::ROUTING_INDICATION ? &_routingIndication : nullptr; }
+  RoutingLostMessage *getRoutingLostMessage() { return _serviceType == ServiceType::ROUTING_LOST_MESSAGE ? &_routingLostMessage : nullptr; }
+  RoutingBusy *getRoutingBusy() { return _serviceType == ServiceType::ROUTING_BUSY ? &_routingBusy : nullptr; }
  protected:
   std::vector<uint8_t> _rawPacket;
   static const std::array<std::string, 0x30> _errorCodes;
   ServiceType _serviceType = ServiceType::UNSET;
   size_t _length = 0;
 
-  std::shared_ptr<ConnectRequest> _connectRequest;
-  std::shared_ptr<ConnectResponse> _connectResponse;
-  std::shared_ptr<ConnectionStateRequest> _connectionStateRequest;
-  std::shared_ptr<ConnectionStateResponse> _connectionStateResponse;
-  std::shared_ptr<DisconnectRequest> _disconnectRequest;
-  std::shared_ptr<DisconnectResponse> _disconnectResponse;
-
-  std::shared_ptr<ConfigRequest> _configRequest;
-  std::shared_ptr<ConfigAck> _configAck;
-
-  std::shared_ptr<TunnelingRequest> _tunnelingRequest;
-  std::shared_ptr<TunnelingAck> _tunnelingAck;
+  //{{{ Only the structure matching "_serviceType" is valid
+  ConnectRequest _connectRequest{};
+  ConnectResponse _connectResponse{};
+  ConnectionStateRequest _connectionStateRequest{};
+  ConnectionStateResponse _connectionStateResponse{};
+  DisconnectRequest _disconnectRequest{};
+  DisconnectResponse _disconnectResponse{};
+
+  ConfigRequest _configRequest{};
+  ConfigAck _configAck{};
+
+  TunnelingRequest _tunnelingRequest{};
+  TunnelingAck _tunnelingAck{};
+
+  RoutingIndication _routingIndication{};
+  RoutingLostMessage _routingLostMessage{};
+  RoutingBusy _routingBusy{};
+  //}}}
+
+  static uint32_t readIp(const uint8_t *data) { return (((uint32_t)data[0]) << 24) | (((uint32_t)data[1]) << 16) | (((uint32_t)data[2]) << 8) | data[3]; }
+  static uint16_t readUInt16(const uint8_t *data) { return (((uint16_t)data[0]) << 8) | data[1]; }
+  static void appendHeader(std::vector<uint8_t> &buffer, ServiceType serviceType);
+
+  /**
+   * Sets the total length in the header of the packet starting at "offset" to the number of bytes following it.
+   */
+  static void setLength(std::vector<uint8_t> &buffer, size_t offset);
 };
 
 typedef std::shared_ptr<KnxIpPacket> PKnxIpPacket;
@@ -42,9 +42,7 @@ KnxPeer::~KnxPeer() {
 
 void KnxPeer::init() {
   try {
-    _readVariables = false;
     _stopWorkerThread = false;
-    _dptConverter.reset(new DptConverter(Gd::bl));
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -53,68 +51,139 @@ void KnxPeer::init() {
 
 void KnxPeer::dispose() {
   if (_disposing) return;
+  size_t queued = 0;
+  flushParameters(queued);
   Peer::dispose();
 }
 
+void KnxPeer::queueParameterSave(BaseLib::Systems::RpcConfigurationParameter &parameter, int32_t channel, const std::string &name, const std::vector<uint8_t> &data) {
+  try {
+    if (parameter.databaseId == 0) {
+      std::vector<uint8_t> value = data;
+      saveParameter(0, ParameterGroup::Type::Enum::variables, channel, name, value);
+      return;
+    }
+
+    std::lock_guard<std::mutex> parameterSavesGuard(_parameterSavesMutex);
+    _parameterSaves[parameter.databaseId] = data;
+    _parameterSavesQueued++;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+size_t KnxPeer::flushParameters(size_t &queued) {
+  queued = 0;
+  try {
+    std::unordered_map<uint64_t, std::vector<uint8_t>> parameterSaves;
+    {
+      std::lock_guard<std::mutex> parameterSavesGuard(_parameterSavesMutex);
+      parameterSaves.swap(_parameterSaves);
+      queued = _parameterSavesQueued.exchange(0);
+    }
+
+    for (auto &parameterSave : parameterSaves) {
+      saveParameter(parameterSave.first, parameterSave.second);
+    }
+    return parameterSaves.size();
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return 0;
+}
+
 void KnxPeer::worker() {
   try {
     for (auto &interface : Gd::physicalInterfaces) {
       if (!interface.second->isOpen()) return;
     }
 
-    if (_readVariables) {
-      _readVariables = false;
-      for (Functions::iterator i = _rpcDevice->functions.begin(); i != _rpcDevice->functions.end(); ++i) {
-        PParameterGroup parameterGroup = getParameterSet(i->first, ParameterGroup::Type::variables);
-        if (!parameterGroup) continue;
-
-        for (Parameters::iterator j = parameterGroup->parameters.begin(); j != parameterGroup->parameters.end(); ++j) {
-          if (_stopWorkerThread) return;
-          if (j->second->service) continue;
-          if (!j->second->readable) {
-            //{{{ Process "read on init" devices
-            if (j->second->readOnInit) {
-              //When the "read on init" flag is set, Homegear writes the last known value to the device on start up. This only is allowed when no read flag is set, because in the latter case the value is read from another device.
-              auto channelIterator = valuesCentral.find(i->first);
-              if (channelIterator != valuesCentral.end()) {
-                auto variableIterator = channelIterator->second.find(j->second->id);
-                if (variableIterator != channelIterator->second.end()) {
-                  auto parameter = variableIterator->second;
-                  auto parameterData = variableIterator->second.getBinaryData();
-                  bool fitsInFirstByte = false;
-                  if (!parameter.rpcParameter->casts.empty()) {
-                    ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(parameter.rpcParameter->casts.at(0));
-                    if (!cast) {
-                      Gd::out.printError("Error: No DPT conversion defined for parameter " + parameter.rpcParameter->id + ". Can't send value.");
-                      continue;
-                    }
-                    fitsInFirstByte = _dptConverter->fitsInFirstByte(cast->type);
-                  }
+    if (!serviceMessages->getUnreach()) serviceMessages->checkUnreach(_rpcDevice->timeout, getLastPacketReceived());
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
 
-                  if (Gd::bl->debugLevel >= 4)
-                    Gd::out.printInfo(
-                        "Info: Writing " + j->second->id + " to peer " + std::to_string(_peerID) + " on channel " + std::to_string(i->first) + ", because \"read on init\" flag is set and there is no other device to read the value from.");
-                  auto cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, j->second->physical->address, fitsInFirstByte, parameterData);
+bool KnxPeer::usesInterface(const std::string &interfaceId) {
+  return _rpcDevice && (_rpcDevice->interface.empty() || _rpcDevice->interface == interfaceId);
+}
 
-                  sendPacket(cemi);
+bool KnxPeer::getStartupPackets(std::vector<PCemi> &writes, std::vector<PCemi> &reads) {
+  try {
+    if (!_rpcDevice) return false;
+
+    for (Functions::iterator i = _rpcDevice->functions.begin(); i != _rpcDevice->functions.end(); ++i) {
+      PParameterGroup parameterGroup = getParameterSet(i->first, ParameterGroup::Type::variables);
+      if (!parameterGroup) continue;
+
+      for (Parameters::iterator j = parameterGroup->parameters.begin(); j != parameterGroup->parameters.end(); ++j) {
+        if (j->second->service || !j->second->physical) continue;
+        if (!j->second->readable) {
+          //{{{ Process "read on init" devices
+          if (j->second->readOnInit) {
+            //When the "read on init" flag is set, Homegear writes the last known value to the device on start up. This only is allowed when no read flag is set, because in the latter case the value is read from another device.
+            auto channelIterator = valuesCentral.find(i->first);
+            if (channelIterator != valuesCentral.end()) {
+              auto variableIterator = channelIterator->second.find(j->second->id);
+              if (variableIterator != channelIterator->second.end() && variableIterator->second.rpcParameter) {
+                auto &parameter = variableIterator->second;
+                auto parameterData = parameter.getBinaryData();
+                bool fitsInFirstByte = false;
+                if (!parameter.rpcParameter->casts.empty()) {
+                  ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(parameter.rpcParameter->casts.at(0));
+                  if (!cast) {
+                    Gd::out.printError("Error: No DPT conversion defined for parameter " + parameter.rpcParameter->id + ". Can't send value.");
+                    continue;
+                  }
+                  fitsInFirstByte = Gd::dptConverter->fitsInFirstByte(cast->type);
                 }
+
+                if (Gd::bl->debugLevel >= 4)
+                  Gd::out.printInfo(
+                      "Info: Writing " + j->second->id + " to peer " + std::to_string(_peerID) + " on channel " + std::to_string(i->first) + ", because \"read on init\" flag is set and there is no other device to read the value from.");
+                auto cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, j->second->physical->address, fitsInFirstByte, parameterData);
+                cemi->setPriority(Cemi::Priority::low);
+                writes.push_back(cemi);
               }
             }
-            //}}}
-
-            continue;
           }
-          if (Gd::bl->debugLevel >= 4) Gd::out.printInfo("Info: Reading " + j->second->id + " of peer " + std::to_string(_peerID) + " on channel " + std::to_string(i->first));
-          getValueFromDevice(j->second, i->first, false);
+          //}}}
+
+          continue;
         }
+        if (Gd::bl->debugLevel >= 5) Gd::out.printDebug("Debug: Reading " + j->second->id + " of peer " + std::to_string(_peerID) + " on channel " + std::to_string(i->first));
+        auto cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueRead, 0, j->second->physical->address);
+        cemi->setPriority(Cemi::Priority::low);
+        reads.push_back(cemi);
       }
     }
+    return true;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
 
-    if (!serviceMessages->getUnreach()) serviceMessages->checkUnreach(_rpcDevice->timeout, getLastPacketReceived());
+bool KnxPeer::getGroupAddressType(uint16_t groupAddress, DptConverter::Dpt &dpt, BaseLib::Role &role) {
+  try {
+    auto decodePlan = std::atomic_load(&_decodePlan);
+    if (!decodePlan) return false;
+    auto parametersIterator = decodePlan->parametersByGroupAddress.find(groupAddress);
+    if (parametersIterator == decodePlan->parametersByGroupAddress.end() || parametersIterator->second.empty()) return false;
+    auto &parameterInfo = parametersIterator->second.front();
+    if (parameterInfo.dpt.main == 0) return false;
+    dpt = parameterInfo.dpt;
+    if (parameterInfo.configParameter) role = parameterInfo.configParameter->mainRole();
+    return true;
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
+  return false;
 }
 
 void KnxPeer::homegearStarted() {
@@ -130,6 +199,8 @@ void KnxPeer::homegearShuttingDown() {
   try {
     Peer::homegearShuttingDown();
     _stopWorkerThread = true;
+    size_t queued = 0;
+    flushParameters(queued);
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -204,6 +275,57 @@ std::string KnxPeer::handleCliCommand(std::string command) {
   return "Error executing command. See log file for more details.\n";
 }
 
+KnxPeer::MemoryUsage KnxPeer::getMemoryUsage() {
+  MemoryUsage memoryUsage;
+  try {
+    //Approximate overhead of a node in a std::map or std::unordered_map (pointers and bucket entry)
+    const size_t nodeOverhead = 4 * sizeof(void *);
+
+    if (_rpcDevice) {
+      for (auto &function : _rpcDevice->functions) {
+        for (auto &parameter : function.second->variables->parameters) {
+          memoryUsage.parameterCount++;
+          memoryUsage.parameters += nodeOverhead + sizeof(Parameter) + parameter.first.capacity() + parameter.second->id.capacity();
+        }
+      }
+    }
+
+    for (auto *parameterGroup : {&valuesCentral, &configCentral}) {
+      for (auto &channel : *parameterGroup) {
+        memoryUsage.values += nodeOverhead + sizeof(channel);
+        for (auto &parameter : channel.second) {
+          memoryUsage.valueCount++;
+          memoryUsage.values += nodeOverhead + sizeof(parameter) + parameter.first.capacity() + parameter.second.getBinaryData().size();
+        }
+      }
+    }
+
+    auto decodePlan = std::atomic_load(&_decodePlan);
+    if (decodePlan) {
+      memoryUsage.maps += sizeof(DecodePlan) + decodePlan->eventSource.capacity();
+      for (auto &groupAddress : decodePlan->parametersByGroupAddress) {
+        memoryUsage.maps += nodeOverhead + sizeof(groupAddress) + groupAddress.second.capacity() * sizeof(ParametersByGroupAddressInfo);
+        for (auto &info : groupAddress.second) {
+          memoryUsage.maps += info.address.capacity() + info.groupedParameters.capacity() * sizeof(GroupedParameterInfo);
+          //Shared pointer control block, vector and key
+          if (info.valueKeys) memoryUsage.maps += 2 * sizeof(void *) + sizeof(std::vector<std::string>) + info.valueKeys->capacity() * sizeof(std::string);
+        }
+      }
+    }
+
+    for (auto &channel : _groupedParameters) {
+      memoryUsage.maps += nodeOverhead + sizeof(channel);
+      for (auto &groupedParameters : channel.second) {
+        memoryUsage.maps += nodeOverhead + sizeof(groupedParameters) + groupedParameters.first.capacity() + groupedParameters.second.parameters.capacity() * sizeof(PParameter);
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return memoryUsage;
+}
+
 std::string KnxPeer::printConfig() {
   try {
     std::ostringstream stringStream;
@@ -258,8 +380,8 @@ std::string KnxPeer::printConfig() {
           }
 
           std::vector<uint8_t> groupedParameterData = BaseLib::BitReaderWriter::getPosition(parameterData, j->second.rpcParameter->physical->address, j->second.rpcParameter->physical->bitSize);
-          value = _dptConverter->getVariable(parameterCast->type, groupedParameterData, j->second.mainRole());
-        } else value = _dptConverter->getVariable(parameterCast->type, parameterData, j->second.mainRole());
+          value = Gd::dptConverter->getVariable(parameterCast->type, groupedParameterData, j->second.mainRole());
+        } else value = Gd::dptConverter->getVariable(parameterCast->type, parameterData, j->second.mainRole());
 
         if (!value) {
           stringStream << std::endl;
@@ -332,8 +454,6 @@ bool KnxPeer::load(BaseLib::Systems::ICentral *central) {
 
     initParametersByGroupAddress();
 
-    _readVariables = true;
-
     return true;
   }
   catch (const std::exception &ex) {
@@ -342,10 +462,62 @@ bool KnxPeer::load(BaseLib::Systems::ICentral *central) {
   return false;
 }
 
+KnxPeer::EventFilter KnxPeer::getEventFilter(const DptConverter::Dpt &dpt) {
+  EventFilter eventFilter;
+  try {
+    auto getSetting = [&](const std::string &name) {
+      auto setting = Gd::family->getFamilySetting(name + "Dpt" + std::to_string(dpt.main));
+      if (!setting || setting->stringValue.empty()) setting = Gd::family->getFamilySetting(name);
+      if (setting && setting->stringValue.empty()) setting.reset();
+      return setting;
+    };
+
+    auto setting = getSetting("eventSuppressUnchanged");
+    if (setting) eventFilter.suppressUnchanged = setting->stringValue == "true" || setting->integerValue != 0;
+    setting = getSetting("eventDeadband");
+    if (setting) eventFilter.deadband = BaseLib::Math::getDouble(setting->stringValue);
+    setting = getSetting("eventRelativeDeadband");
+    if (setting) eventFilter.relativeDeadband = BaseLib::Math::getDouble(setting->stringValue);
+    setting = getSetting("eventMinInterval");
+    if (setting && setting->integerValue > 0) eventFilter.minInterval = setting->integerValue;
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return eventFilter;
+}
+
 void KnxPeer::initParametersByGroupAddress() {
   try {
     if (!_rpcDevice) return;
-    _parametersByGroupAddress.clear();
+    auto decodePlan = std::make_shared<DecodePlan>();
+    decodePlan->eventSource = "device-" + std::to_string(_peerID);
+    _groupedParameters.clear();
+
+    auto getConfigParameter = [&](int32_t channel, const std::string &id) -> BaseLib::Systems::RpcConfigurationParameter * {
+      auto channelIterator = valuesCentral.find(channel);
+      if (channelIterator == valuesCentral.end()) return nullptr;
+      auto parameterIterator = channelIterator->second.find(id);
+      if (parameterIterator == channelIterator->second.end()) return nullptr;
+      return &parameterIterator->second;
+    };
+
+    auto addParameter = [&](int32_t channel, const PParameter &parameter) {
+      ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(parameter->casts.at(0));
+      if (!cast) return;
+      ParametersByGroupAddressInfo info;
+      info.channel = channel;
+      info.cast = cast;
+      info.dpt = DptConverter::parseDpt(cast->type);
+      info.parameter = parameter;
+      info.configParameter = getConfigParameter(channel, parameter->id);
+      info.address = _serialNumber + ":" + std::to_string(channel);
+      info.valueKeys = std::make_shared<std::vector<std::string>>(1, parameter->id);
+      info.eventFilter = getEventFilter(info.dpt);
+      if (info.eventFilter.enabled()) info.eventFilterState = std::make_shared<EventFilterState>();
+      decodePlan->parametersByGroupAddress[parameter->physical->address].push_back(std::move(info));
+    };
+
     for (Functions::iterator i = _rpcDevice->functions.begin(); i != _rpcDevice->functions.end(); ++i) {
       if (i->second->channel == 0) continue;
       for (Parameters::iterator j = i->second->variables->parameters.begin(); j != i->second->variables->parameters.end(); ++j) {
@@ -357,56 +529,116 @@ void KnxPeer::initParametersByGroupAddress() {
           std::string extension = j->first.substr(pos);
           if (extension == ".RAW") {
             _groupedParameters[i->first][baseName].rawParameter = j->second;
-
-            ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(j->second->casts.at(0));
-            if (!cast) continue;
-            ParametersByGroupAddressInfo info;
-            info.channel = i->first;
-            info.cast = cast;
-            info.parameter = j->second;
-            _parametersByGroupAddress[j->second->physical->address].push_back(info);
+            addParameter(i->first, j->second);
           } else if (extension == ".SUBMIT") {
             _groupedParameters[i->first][baseName].submitParameter = j->second;
           } else {
-            ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(j->second->casts.at(0));
-            if (!cast) continue;
-            ParametersByGroupAddressInfo info;
-            info.channel = i->first;
-            info.cast = cast;
-            info.parameter = j->second;
-            _parametersByGroupAddress[j->second->physical->address].push_back(info);
+            _groupedParameters[i->first][baseName].parameters.push_back(j->second);
+            addParameter(i->first, j->second);
           }
         } else {
           if (j->second->physical->operationType != BaseLib::DeviceDescription::IPhysical::OperationType::command) continue;
-          ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(j->second->casts.at(0));
-          if (!cast) continue;
-          ParametersByGroupAddressInfo info;
-          info.channel = i->first;
-          info.cast = cast;
-          info.parameter = j->second;
-          _parametersByGroupAddress[j->second->physical->address].push_back(info);
+          addParameter(i->first, j->second);
+        }
+      }
+    }
+
+    //{{{ Resolve the parameters contained in ".RAW" parameters
+    for (auto &groupAddressEntry : decodePlan->parametersByGroupAddress) {
+      for (auto &info : groupAddressEntry.second) {
+        const std::string &id = info.parameter->id;
+        if (id.size() <= 4 || id.compare(id.size() - 4, 4, ".RAW") != 0) continue;
+        auto groupedParametersChannelIterator = _groupedParameters.find(info.channel);
+        if (groupedParametersChannelIterator == _groupedParameters.end()) continue;
+        auto groupedParametersIterator = groupedParametersChannelIterator->second.find(id.substr(0, id.size() - 4));
+        if (groupedParametersIterator == groupedParametersChannelIterator->second.end()) continue;
+
+        for (auto &parameter : groupedParametersIterator->second.parameters) {
+          if (parameter->casts.empty() || parameter->physical->bitSize < 1) continue;
+          ParameterCast::PGeneric groupedCast = std::dynamic_pointer_cast<ParameterCast::Generic>(parameter->casts.at(0));
+          if (!groupedCast) continue;
+          GroupedParameterInfo groupedInfo;
+          groupedInfo.parameter = parameter;
+          groupedInfo.configParameter = getConfigParameter(info.channel, parameter->id);
+          if (!groupedInfo.configParameter) continue;
+          groupedInfo.dpt = DptConverter::parseDpt(groupedCast->type);
+          groupedInfo.bitPosition = parameter->physical->address;
+          groupedInfo.bitSize = parameter->physical->bitSize;
+          info.groupedParameters.push_back(std::move(groupedInfo));
         }
       }
     }
+    //}}}
+
+    std::atomic_store(&_decodePlan, decodePlan);
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
-void KnxPeer::sendPacket(const PCemi &packet) {
+MainInterface::SendResult KnxPeer::sendPacket(const PCemi &packet) {
   try {
     if (_rpcDevice->interface.empty()) {
+      auto result = MainInterface::SendResult::queued;
       for (auto &interface : Gd::physicalInterfaces) {
-        interface.second->sendPacket(packet);
+        auto interfaceResult = interface.second->queuePacket(packet);
+        if (result == MainInterface::SendResult::queued) result = interfaceResult;
       }
+      return result;
     } else {
       auto interfaceIterator = Gd::physicalInterfaces.find(_rpcDevice->interface);
       if (interfaceIterator == Gd::physicalInterfaces.end()) {
         Gd::out.printError("Error: Communication interface \"" + _rpcDevice->interface + "\" required by peer " + std::to_string(_peerID) + " was not found. Could not send packet.");
-        return;
+        return MainInterface::SendResult::notConnected;
       }
-      interfaceIterator->second->sendPacket(packet);
+      return interfaceIterator->second->queuePacket(packet);
+    }
+  }
+  catch (const std::exception &ex) {
+    Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return MainInterface::SendResult::sendError;
+}
+
+void KnxPeer::addEvent(std::map<int32_t, PendingEvent> &events, int32_t channel, const std::string &address, const std::shared_ptr<std::vector<std::string>> &valueKeys, const std::shared_ptr<std::vector<PVariable>> &values) {
+  auto eventIterator = events.find(channel);
+  if (eventIterator == events.end()) {
+    events.emplace(channel, PendingEvent{address, valueKeys, values});
+    return;
+  }
+
+  auto &event = eventIterator->second;
+  for (size_t i = 0; i < valueKeys->size() && i < values->size(); i++) {
+    auto keyIterator = std::find(event.valueKeys->begin(), event.valueKeys->end(), valueKeys->at(i));
+    if (keyIterator != event.valueKeys->end()) {
+      //"values" might be shared with an event already raised, so replace the vector instead of modifying it.
+      auto newValues = std::make_shared<std::vector<PVariable>>(*event.values);
+      newValues->at(std::distance(event.valueKeys->begin(), keyIterator)) = values->at(i);
+      event.values = std::move(newValues);
+    } else {
+      event.valueKeys = std::make_shared<std::vector<std::string>>(*event.valueKeys);
+      event.valueKeys->push_back(valueKeys->at(i));
+      event.values = std::make_shared<std::vector<PVariable>>(*event.values);
+      event.values->push_back(values->at(i));
+    }
+  }
+}
+
+void KnxPeer::flushEvents() {
+  try {
+    std::map<int32_t, PendingEvent> events;
+    std::string eventSource;
+    {
+      std::lock_guard<std::mutex> pendingEventsGuard(_pendingEventsMutex);
+      if (_pendingEvents.empty()) return;
+      events.swap(_pendingEvents);
+      eventSource = _pendingEventsSource;
+    }
+
+    for (auto &event : events) {
+      raiseEvent(eventSource, _peerID, event.first, event.second.valueKeys, event.second.values);
+      raiseRPCEvent(eventSource, _peerID, event.first, event.second.address, event.second.valueKeys, event.second.values);
     }
   }
   catch (const std::exception &ex) {
@@ -414,7 +646,7 @@ void KnxPeer::sendPacket(const PCemi &packet) {
   }
 }
 
-void KnxPeer::packetReceived(PCemi &packet) {
+void KnxPeer::packetReceived(const PCemi &packet, TelegramDecoder &decoder, bool batchEvents) {
   try {
     if (_disposing || !_rpcDevice) return;
     setLastPacketReceived();
@@ -422,8 +654,10 @@ void KnxPeer::packetReceived(PCemi &packet) {
     if (_bl->debugLevel >= 4)
       Gd::out.printInfo("Info: Packet received by peer " + std::to_string(_peerID) + ". Payload: " + BaseLib::HelperFunctions::getHexString(packet->getPayload()));
 
-    auto parametersIterator = _parametersByGroupAddress.find(packet->getDestinationAddress());
-    if (parametersIterator == _parametersByGroupAddress.end()) {
+    auto decodePlan = std::atomic_load(&_decodePlan);
+    if (!decodePlan) return;
+    auto parametersIterator = decodePlan->parametersByGroupAddress.find(packet->getDestinationAddress());
+    if (parametersIterator == decodePlan->parametersByGroupAddress.end()) {
       if (_bl->debugLevel >= 4)
         Gd::out.printInfo("Info: No parameter was found for group address: " + packet->getFormattedDestinationAddress() + " by peer: " + std::to_string(_peerID));
       return;
@@ -434,123 +668,155 @@ void KnxPeer::packetReceived(PCemi &packet) {
     }
 
     if (packet->getOperation() == Cemi::Operation::groupValueWrite || packet->getOperation() == Cemi::Operation::groupValueResponse) {
-      for (auto &parameterIterator : parametersIterator->second) {
-        BaseLib::Systems::RpcConfigurationParameter &parameter = valuesCentral[parameterIterator.channel][parameterIterator.parameter->id];
-        if (!parameter.rpcParameter) {
+      //Any value on the group address answers pending reads.
+      auto pendingRead = takePendingRead(packet->getDestinationAddress());
+      std::map<int32_t, PendingEvent> events;
+      std::vector<uint8_t> &parameterData = packet->getPayload();
+      for (auto &parameterInfo : parametersIterator->second) {
+        if (!parameterInfo.configParameter || !parameterInfo.configParameter->rpcParameter) {
           if (_bl->debugLevel >= 4)
             Gd::out.printInfo("Info: No RPC parameter was found for group address: " + packet->getFormattedDestinationAddress() + " by peer: " + std::to_string(_peerID));
 
-          return;
+          break;
         }
+        BaseLib::Systems::RpcConfigurationParameter &parameter = *parameterInfo.configParameter;
 
-        std::vector<uint8_t> parameterData = packet->getPayload();
-        parameter.setBinaryData(parameterData);
-        if (parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-        else saveParameter(0, ParameterGroup::Type::Enum::variables, parameterIterator.channel, parameterIterator.parameter->id, parameterData);
+        bool unchanged = parameter.equals(parameterData);
+        if (!unchanged) {
+          parameter.setBinaryData(parameterData);
+          queueParameterSave(parameter, parameterInfo.channel, parameterInfo.parameter->id, parameterData);
+        }
         if (_bl->debugLevel >= 4)
-          Gd::out.printInfo("Info: " + parameterIterator.parameter->id + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(parameterIterator.channel) + " was set to 0x"
+          Gd::out.printInfo("Info: " + parameterInfo.parameter->id + " of peer " + std::to_string(_peerID) + " with serial number " + parameterInfo.address + " was set to 0x"
                                 + BaseLib::HelperFunctions::getHexString(parameterData) + ".");
 
-        PVariable variable = _dptConverter->getVariable(parameterIterator.cast->type, packet->getPayload(), parameter.mainRole());
-        if (!variable) return;
+        //{{{ Event filter checks not needing the converted value
+        const EventFilter &eventFilter = parameterInfo.eventFilter;
+        int64_t time = 0;
+        bool suppressEvent = false;
+        if (eventFilter.suppressUnchanged && unchanged) suppressEvent = true;
+        else if (eventFilter.minInterval > 0) {
+          time = getSteadyTime();
+          if (time - parameterInfo.eventFilterState->lastEventTime < eventFilter.minInterval) suppressEvent = true;
+        }
+
+        bool isServiceParameter = parameter.rpcParameter->service || parameter.rpcParameter->serviceInverted || parameter.hasServiceRole();
+        if (suppressEvent && !pendingRead && !isServiceParameter) {
+          //Nothing needs the converted values, so only store the grouped parameters.
+          for (auto &groupedInfo : parameterInfo.groupedParameters) {
+            BaseLib::Systems::RpcConfigurationParameter &groupedParameter = *groupedInfo.configParameter;
+            std::vector<uint8_t> groupedParameterData = BaseLib::BitReaderWriter::getPosition(parameterData, groupedInfo.bitPosition, groupedInfo.bitSize);
+            if (groupedParameter.equals(groupedParameterData)) continue;
+            groupedParameter.setBinaryData(groupedParameterData);
+            queueParameterSave(groupedParameter, parameterInfo.channel, groupedInfo.parameter->id, groupedParameterData);
+          }
+          _eventsSuppressed++;
+          continue;
+        }
+        //}}}
+
+        PVariable variable = decoder.getVariable(parameterInfo.dpt, parameter.mainRole());
+        if (!variable) break;
+        if (pendingRead) pendingRead->values.emplace(std::make_pair(parameterInfo.channel, parameterInfo.parameter->id), variable);
+
+        //{{{ Deadband
+        bool isNumeric = variable->type == BaseLib::VariableType::tFloat || variable->type == BaseLib::VariableType::tInteger || variable->type == BaseLib::VariableType::tInteger64;
+        double numericValue = 0;
+        if (isNumeric && parameterInfo.eventFilterState) {
+          numericValue = variable->type == BaseLib::VariableType::tFloat ? variable->floatValue : (variable->type == BaseLib::VariableType::tInteger64 ? (double)variable->integerValue64 : (double)variable->integerValue);
+          auto &eventFilterState = *parameterInfo.eventFilterState;
+          if (!suppressEvent && eventFilterState.hasLastValue) {
+            double difference = std::fabs(numericValue - eventFilterState.lastValue);
+            if ((eventFilter.deadband > 0 && difference < eventFilter.deadband) || (eventFilter.relativeDeadband > 0 && difference < std::fabs(eventFilterState.lastValue) * eventFilter.relativeDeadband / 100.0)) {
+              suppressEvent = true;
+            }
+          }
+        }
+        //}}}
 
         //Process service messages
-        if (parameter.rpcParameter->service || parameter.rpcParameter->serviceInverted || parameter.hasServiceRole()) {
-          if (variable->type == BaseLib::VariableType::tBoolean && parameterIterator.channel == 0) {
+        if (isServiceParameter) {
+          if (variable->type == BaseLib::VariableType::tBoolean && parameterInfo.channel == 0) {
             auto service_value = variable->booleanValue;
             if (parameter.rpcParameter->serviceInverted) service_value = !service_value;
-            serviceMessages->set(parameterIterator.parameter->id, service_value);
+            serviceMessages->set(parameterInfo.parameter->id, service_value);
           } else if (variable->type == BaseLib::VariableType::tBoolean) {
             auto service_value = variable->booleanValue;
             if (parameter.rpcParameter->serviceInverted) service_value = !service_value;
-            serviceMessages->set(parameterIterator.parameter->id, service_value, parameterIterator.channel);
+            serviceMessages->set(parameterInfo.parameter->id, service_value, parameterInfo.channel);
           } else if (variable->type == BaseLib::VariableType::tInteger || variable->type == BaseLib::VariableType::tInteger64) {
             auto service_value = variable->integerValue;
             if (parameter.rpcParameter->serviceInverted) service_value = !service_value;
-            serviceMessages->set(parameterIterator.parameter->id, service_value, parameterIterator.channel);
+            serviceMessages->set(parameterInfo.parameter->id, service_value, parameterInfo.channel);
           }
         }
 
-        std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>{parameterIterator.parameter->id});
-        std::shared_ptr<std::vector<PVariable>> values(new std::vector<PVariable>{variable});
+        //The keys are shared between events unless grouped parameters are added.
+        std::shared_ptr<std::vector<std::string>> valueKeys = parameterInfo.valueKeys;
+        auto values = std::make_shared<std::vector<PVariable>>();
+        values->reserve(parameterInfo.groupedParameters.size() + 1);
+        values->push_back(variable);
+
+        for (auto &groupedInfo : parameterInfo.groupedParameters) {
+          BaseLib::Systems::RpcConfigurationParameter &groupedParameter = *groupedInfo.configParameter;
+          std::vector<uint8_t> groupedParameterData;
+          PVariable groupedVariable = decoder.getVariable(groupedInfo.dpt, groupedParameter.mainRole(), groupedInfo.bitPosition, groupedInfo.bitSize, groupedParameterData);
+          if (!groupedVariable) continue;
+          if (pendingRead) pendingRead->values.emplace(std::make_pair(parameterInfo.channel, groupedInfo.parameter->id), groupedVariable);
+
+          if (groupedParameter.equals(groupedParameterData)) continue;
+          groupedParameter.setBinaryData(groupedParameterData);
+          queueParameterSave(groupedParameter, parameterInfo.channel, groupedInfo.parameter->id, groupedParameterData);
+          if (_bl->debugLevel >= 4)
+            Gd::out.printInfo("Info: " + groupedInfo.parameter->id + " of peer " + std::to_string(_peerID) + " with serial number " + parameterInfo.address + " was set to 0x"
+                                  + BaseLib::HelperFunctions::getHexString(groupedParameterData) + ".");
 
-        std::string::size_type pos = parameterIterator.parameter->id.find('.');
-        if (pos != std::string::npos) {
-          std::string baseName = parameterIterator.parameter->id.substr(0, pos);
-          auto channelIterator = valuesCentral.find(parameterIterator.channel);
-          if (channelIterator != valuesCentral.end()) {
-            auto groupedParametersChannelIterator = _groupedParameters.find(parameterIterator.channel);
-            if (groupedParametersChannelIterator != _groupedParameters.end()) {
-              auto groupedParametersIterator = groupedParametersChannelIterator->second.find(baseName);
-              if (groupedParametersIterator != groupedParametersChannelIterator->second.end()) {
-                for (std::vector<PParameter>::iterator i = groupedParametersIterator->second.parameters.begin(); i != groupedParametersIterator->second.parameters.end(); ++i) {
-                  auto groupedParameterIterator = channelIterator->second.find((*i)->id);
-                  if (groupedParameterIterator != channelIterator->second.end()) {
-                    BaseLib::Systems::RpcConfigurationParameter &groupedParameter = groupedParameterIterator->second;
-
-                    if ((*i)->casts.empty() || (*i)->physical->bitSize < 1) continue;
-                    ParameterCast::PGeneric groupedCast = std::dynamic_pointer_cast<ParameterCast::Generic>((*i)->casts.at(0));
-                    if (!groupedCast) continue;
-
-                    std::vector<uint8_t> groupedParameterData = BaseLib::BitReaderWriter::getPosition(parameter.getBinaryData(), (*i)->physical->address, (*i)->physical->bitSize);
-
-                    PVariable groupedVariable = _dptConverter->getVariable(groupedCast->type, groupedParameterData, groupedParameter.mainRole());
-                    if (!groupedVariable) continue;
-                    if (_getValueFromDeviceInfo.requested && parameterIterator.channel == _getValueFromDeviceInfo.channel && (*i)->id == _getValueFromDeviceInfo.variableName) {
-                      _getValueFromDeviceInfo.requested = false;
-                      _getValueFromDeviceInfo.value = groupedVariable;
-                      {
-                        std::lock_guard<std::mutex> lock(_getValueFromDeviceInfo.mutex);
-                        _getValueFromDeviceInfo.mutexReady = true;
-                      }
-                      _getValueFromDeviceInfo.conditionVariable.notify_one();
-                    }
-
-                    if (groupedParameter.equals(groupedParameterData)) continue;
-                    groupedParameter.setBinaryData(groupedParameterData);
-                    if (groupedParameter.databaseId > 0) saveParameter(groupedParameter.databaseId, groupedParameterData);
-                    else saveParameter(0, ParameterGroup::Type::Enum::variables, parameterIterator.channel, (*i)->id, groupedParameterData);
-                    if (_bl->debugLevel >= 4)
-                      Gd::out.printInfo("Info: " + (*i)->id + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(parameterIterator.channel) + " was set to 0x"
-                                            + BaseLib::HelperFunctions::getHexString(groupedParameterData) + ".");
-
-                    valueKeys->push_back((*i)->id);
-                    values->push_back(groupedVariable);
-                  }
-                }
-              }
-            }
-          }
+          if (valueKeys == parameterInfo.valueKeys) valueKeys = std::make_shared<std::vector<std::string>>(*parameterInfo.valueKeys);
+          valueKeys->push_back(groupedInfo.parameter->id);
+          values->push_back(groupedVariable);
         }
 
-        if (_getValueFromDeviceInfo.requested && parameterIterator.channel == _getValueFromDeviceInfo.channel && parameterIterator.parameter->id == _getValueFromDeviceInfo.variableName) {
-          _getValueFromDeviceInfo.requested = false;
-          _getValueFromDeviceInfo.value = variable;
-          {
-            std::lock_guard<std::mutex> lock(_getValueFromDeviceInfo.mutex);
-            _getValueFromDeviceInfo.mutexReady = true;
-          }
-          _getValueFromDeviceInfo.conditionVariable.notify_one();
+        if (suppressEvent) {
+          _eventsSuppressed++;
+          continue;
         }
+        if (parameterInfo.eventFilterState) {
+          auto &eventFilterState = *parameterInfo.eventFilterState;
+          eventFilterState.lastEventTime = time != 0 ? time : getSteadyTime();
+          eventFilterState.hasLastValue = isNumeric;
+          eventFilterState.lastValue = numericValue;
+        }
+        _eventsRaised++;
+
+        addEvent(events, parameterInfo.channel, parameterInfo.address, valueKeys, values);
+      }
+      if (pendingRead) completePendingRead(pendingRead);
 
-        std::string eventSource = "device-" + std::to_string(_peerID);
-        std::string address(_serialNumber + ":" + std::to_string(parameterIterator.channel));
-        raiseEvent(eventSource, _peerID, parameterIterator.channel, valueKeys, values);
-        raiseRPCEvent(eventSource, _peerID, parameterIterator.channel, address, valueKeys, values);
+      if (batchEvents) {
+        std::lock_guard<std::mutex> pendingEventsGuard(_pendingEventsMutex);
+        _pendingEventsSource = decodePlan->eventSource;
+        for (auto &event : events) {
+          addEvent(_pendingEvents, event.first, event.second.address, event.second.valueKeys, event.second.values);
+        }
+      } else {
+        for (auto &event : events) {
+          raiseEvent(decodePlan->eventSource, _peerID, event.first, event.second.valueKeys, event.second.values);
+          raiseRPCEvent(decodePlan->eventSource, _peerID, event.first, event.second.address, event.second.valueKeys, event.second.values);
+        }
       }
     } else if (packet->getOperation() == Cemi::Operation::groupValueRead) {
       //Homegear only answers to a read request when there is no readable device connected to the group variable (i. e. no linked device has the read flag set).
 
       if (parametersIterator->second.empty()) return;
-      int32_t channel = parametersIterator->second.front().channel;
-      std::string parameterId = parametersIterator->second.front().parameter->id;
-      BaseLib::Systems::RpcConfigurationParameter &parameter = valuesCentral[channel][parameterId];
-      if (!parameter.rpcParameter) {
+      auto &parameterInfo = parametersIterator->second.front();
+      const std::string &parameterId = parameterInfo.parameter->id;
+      if (!parameterInfo.configParameter || !parameterInfo.configParameter->rpcParameter) {
         if (_bl->debugLevel >= 4)
           Gd::out.printInfo("Info: No RPC parameter was found for group address: " + packet->getFormattedDestinationAddress() + " by peer: " + std::to_string(_peerID));
 
         return;
       }
+      BaseLib::Systems::RpcConfigurationParameter &parameter = *parameterInfo.configParameter;
 
       if (parameter.rpcParameter->readable) {
         Gd::out.printDebug("Debug: Ignoring groupValueRead, because parameter is readable.");
@@ -565,12 +831,12 @@ void KnxPeer::packetReceived(PCemi &packet) {
           Gd::out.printError("Error: No DPT conversion defined for parameter " + parameter.rpcParameter->id + ". Can't send response.");
           return;
         }
-        fitsInFirstByte = _dptConverter->fitsInFirstByte(cast->type);
+        fitsInFirstByte = Gd::dptConverter->fitsInFirstByte(cast->type);
       }
 
       if (_bl->debugLevel >= 4)
         Gd::out.printInfo(
-            "Info: " + parameterId + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(channel) + " was requested. Current value is 0x" + BaseLib::HelperFunctions::getHexString(parameterData)
+            "Info: " + parameterId + " of peer " + std::to_string(_peerID) + " with serial number " + parameterInfo.address + " was requested. Current value is 0x" + BaseLib::HelperFunctions::getHexString(parameterData)
                 + ".");
 
       auto responsePacket = std::make_shared<Cemi>(Cemi::Operation::groupValueResponse, 0, parameter.rpcParameter->physical->address, fitsInFirstByte, parameterData);
@@ -582,7 +848,32 @@ void KnxPeer::packetReceived(PCemi &packet) {
   }
 }
 
+int64_t KnxPeer::getSteadyTime() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+KnxPeer::PPendingRead KnxPeer::takePendingRead(uint16_t groupAddress) {
+  std::lock_guard<std::mutex> pendingReadsGuard(_pendingReadsMutex);
+  auto pendingReadIterator = _pendingReads.find(groupAddress);
+  if (pendingReadIterator == _pendingReads.end()) return PPendingRead();
+  auto pendingRead = std::move(pendingReadIterator->second);
+  _pendingReads.erase(pendingReadIterator);
+  return pendingRead;
+}
+
+void KnxPeer::completePendingRead(const PPendingRead &pendingRead) {
+  {
+    std::lock_guard<std::mutex> lock(pendingRead->mutex);
+    pendingRead->received = true;
+  }
+  pendingRead->conditionVariable.notify_all();
+}
+
 PVariable KnxPeer::getValueFromDevice(PParameter &parameter, int32_t channel, bool asynchronous) {
+  return readValueFromDevice(parameter, channel, Cemi::Priority::normal, asynchronous);
+}
+
+PVariable KnxPeer::readValueFromDevice(PParameter &parameter, int32_t channel, Cemi::Priority priority, bool asynchronous) {
   try {
     if (!parameter) return Variable::createError(-32500, "parameter is nullptr.");
     std::unordered_map<uint32_t, std::unordered_map<std::string, Systems::RpcConfigurationParameter>>::iterator channelIterator = valuesCentral.find(channel);
@@ -594,22 +885,51 @@ PVariable KnxPeer::getValueFromDevice(PParameter &parameter, int32_t channel, bo
     ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(valuesIterator->second.rpcParameter->casts.at(0));
     if (!cast) return Variable::createError(-7, "No DPT conversion defined.");
 
-    std::lock_guard<std::mutex> getValueFromDeviceGuard(_getValueFromDeviceMutex);
+    uint16_t groupAddress = valuesIterator->second.rpcParameter->physical->address;
+    PPendingRead pendingRead;
+    bool sendRequest = false;
+    {
+      std::lock_guard<std::mutex> pendingReadsGuard(_pendingReadsMutex);
+      auto &entry = _pendingReads[groupAddress];
+      //Entries without response are only removed by synchronous callers, so replace stale ones.
+      if (!entry || getSteadyTime() - entry->time >= _readTimeout) {
+        entry = std::make_shared<PendingRead>();
+        entry->time = getSteadyTime();
+        sendRequest = true;
+      }
+      pendingRead = entry;
+    }
 
-    _getValueFromDeviceInfo.channel = channel;
-    _getValueFromDeviceInfo.variableName = parameter->id;
-    _getValueFromDeviceInfo.requested = true;
-    std::unique_lock<std::mutex> lock(_getValueFromDeviceInfo.mutex);
-    _getValueFromDeviceInfo.mutexReady = false;
+    if (sendRequest) {
+      auto packet = std::make_shared<Cemi>(Cemi::Operation::groupValueRead, 0, groupAddress);
+      packet->setPriority(priority);
+      auto result = sendPacket(packet);
+      if (result != MainInterface::SendResult::queued) {
+        {
+          std::lock_guard<std::mutex> pendingReadsGuard(_pendingReadsMutex);
+          auto pendingReadIterator = _pendingReads.find(groupAddress);
+          if (pendingReadIterator != _pendingReads.end() && pendingReadIterator->second == pendingRead) _pendingReads.erase(pendingReadIterator);
+        }
+        completePendingRead(pendingRead); //Wakes up coalesced callers, which then return "void".
+        return Variable::createError(-11, MainInterface::getSendResultString(result));
+      }
+    }
 
-    auto packet = std::make_shared<Cemi>(Cemi::Operation::groupValueRead, 0, valuesIterator->second.rpcParameter->physical->address);
-    sendPacket(packet);
+    if (asynchronous) return std::make_shared<Variable>(VariableType::tVoid);
 
-    if (!_getValueFromDeviceInfo.conditionVariable.wait_for(lock, std::chrono::milliseconds(1000), [&] { return _getValueFromDeviceInfo.mutexReady; })) {
+    std::unique_lock<std::mutex> lock(pendingRead->mutex);
+    auto timeout = std::chrono::milliseconds(std::max((int64_t)0, pendingRead->time + _readTimeout - getSteadyTime()));
+    if (!pendingRead->conditionVariable.wait_for(lock, timeout, [&] { return pendingRead->received; })) {
+      lock.unlock();
+      std::lock_guard<std::mutex> pendingReadsGuard(_pendingReadsMutex);
+      auto pendingReadIterator = _pendingReads.find(groupAddress);
+      if (pendingReadIterator != _pendingReads.end() && pendingReadIterator->second == pendingRead) _pendingReads.erase(pendingReadIterator);
       return std::make_shared<Variable>(VariableType::tVoid);
     }
 
-    return _getValueFromDeviceInfo.value;
+    auto valueIterator = pendingRead->values.find(std::make_pair(channel, parameter->id));
+    if (valueIterator == pendingRead->values.end()) return std::make_shared<Variable>(VariableType::tVoid);
+    return valueIterator->second;
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -670,7 +990,7 @@ bool KnxPeer::convertFromPacketHook(BaseLib::Systems::RpcConfigurationParameter
     if (parameter.rpcParameter->casts.empty()) return false;
     ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(parameter.rpcParameter->casts.at(0));
     if (!cast) return false;
-    result = _dptConverter->getVariable(cast->type, data, parameter.mainRole());
+    result = Gd::dptConverter->getVariable(cast->type, data, parameter.mainRole());
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -684,7 +1004,7 @@ bool KnxPeer::convertToPacketHook(BaseLib::Systems::RpcConfigurationParameter &p
     if (parameter.rpcParameter->casts.empty()) return false;
     ParameterCast::PGeneric cast = std::dynamic_pointer_cast<ParameterCast::Generic>(parameter.rpcParameter->casts.at(0));
     if (!cast) return false;
-    result = _dptConverter->getDpt(cast->type, data, parameter.mainRole());
+    result = Gd::dptConverter->getDpt(cast->type, data, parameter.mainRole());
   }
   catch (const std::exception &ex) {
     Gd::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -783,14 +1103,14 @@ PVariable KnxPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
             return Variable::createError(-7, "No DPT conversion defined.");
           }
         } else {
-          parameterData = _dptConverter->getDpt(cast->type, value, parameter.mainRole());
+          parameterData = Gd::dptConverter->getDpt(cast->type, value, parameter.mainRole());
           parameter.setBinaryData(parameterData);
-          fitsInFirstByte = _dptConverter->fitsInFirstByte(cast->type);
+          fitsInFirstByte = Gd::dptConverter->fitsInFirstByte(cast->type);
           parameterConverted = true;
 
           if (rpcParameter->readable) {
             valueKeys->push_back(valueKey);
-            values->push_back(_dptConverter->getVariable(cast->type, parameterData, parameter.mainRole()));
+            values->push_back(Gd::dptConverter->getVariable(cast->type, parameterData, parameter.mainRole()));
           }
         }
       }
@@ -808,8 +1128,7 @@ PVariable KnxPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
     }
 
     if (rpcParameter->physical->operationType == IPhysical::OperationType::Enum::store) {
-      if (parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-      else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, valueKey, parameterData);
+      queueParameterSave(parameter, channel, valueKey, parameterData);
       if (_bl->debugLevel >= 4)
         Gd::out.printInfo("Info: " + valueKey + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(channel) + " was set to 0x" + BaseLib::HelperFunctions::getHexString(parameterData) + ".");
 
@@ -833,14 +1152,13 @@ PVariable KnxPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
         std::vector<uint8_t> rawParameterData = rawParameter.getBinaryData();
         BaseLib::BitReaderWriter::setPositionBE(rpcParameter->physical->address, rpcParameter->physical->bitSize, rawParameterData, parameterData);
         rawParameter.setBinaryData(rawParameterData);
-        if (rawParameter.databaseId > 0) saveParameter(rawParameter.databaseId, rawParameterData);
-        else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, rawParameterName, rawParameterData);
+        queueParameterSave(rawParameter, channel, rawParameterName, rawParameterData);
         if (_bl->debugLevel >= 4)
           Gd::out.printInfo(
               "Info: " + rawParameterName + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(channel) + " was set to 0x" + BaseLib::HelperFunctions::getHexString(rawParameterData) + ".");
 
         valueKeys->push_back(rawParameterName);
-        values->push_back(_dptConverter->getVariable(rawCast->type, rawParameterData, rawParameter.mainRole()));
+        values->push_back(Gd::dptConverter->getVariable(rawCast->type, rawParameterData, rawParameter.mainRole()));
       }
 
       if (!valueKeys->empty()) {
@@ -852,8 +1170,7 @@ PVariable KnxPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
     } else if (rpcParameter->physical->operationType != IPhysical::OperationType::Enum::command) return Variable::createError(-6, "Parameter is not settable.");
     if (rpcParameter->setPackets.empty() && !rpcParameter->writeable) return Variable::createError(-6, "parameter is read only");
 
-    if (parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-    else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, valueKey, parameterData);
+    queueParameterSave(parameter, channel, valueKey, parameterData);
     if (_bl->debugLevel >= 4)
       Gd::out.printInfo("Info: " + valueKey + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(channel) + " was set to 0x" + BaseLib::HelperFunctions::getHexString(parameterData) + ".");
 
@@ -878,14 +1195,13 @@ PVariable KnxPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
         std::vector<uint8_t> groupedParameterData = BaseLib::BitReaderWriter::getPosition(parameterData, groupedRpcParameter->physical->address, groupedRpcParameter->physical->bitSize);
         if (groupedParameter.equals(groupedParameterData)) continue;
         groupedParameter.setBinaryData(groupedParameterData);
-        if (groupedParameter.databaseId > 0) saveParameter(groupedParameter.databaseId, groupedParameterData);
-        else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, loopIterator->id, groupedParameterData);
+        queueParameterSave(groupedParameter, channel, loopIterator->id, groupedParameterData);
         if (_bl->debugLevel >= 4)
           Gd::out.printInfo(
               "Info: " + loopIterator->id + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(channel) + " was set to 0x" + BaseLib::HelperFunctions::getHexString(groupedParameterData) + ".");
 
         valueKeys->push_back(loopIterator->id);
-        values->push_back(_dptConverter->getVariable(groupedCast->type, groupedParameterData, groupedParameter.mainRole()));
+        values->push_back(Gd::dptConverter->getVariable(groupedCast->type, groupedParameterData, groupedParameter.mainRole()));
       }
     }
 
@@ -903,10 +1219,11 @@ PVariable KnxPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
       if (!rawCast) return Variable::createError(-10, rawParameterName + " hast no cast of type generic defined.");
 
       std::vector<uint8_t> rawParameterData = rawParameter.getBinaryData();
-      cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, rpcParameter->physical->address, _dptConverter->fitsInFirstByte(rawCast->type), rawParameterData);
+      cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, rpcParameter->physical->address, Gd::dptConverter->fitsInFirstByte(rawCast->type), rawParameterData);
     } else cemi = std::make_shared<Cemi>(Cemi::Operation::groupValueWrite, 0, rpcParameter->physical->address, fitsInFirstByte, parameterData);
 
-    sendPacket(cemi);
+    auto sendResult = sendPacket(cemi);
+    if (sendResult == MainInterface::SendResult::queueFull) return Variable::createError(-11, MainInterface::getSendResultString(sendResult));
 
     if (!valueKeys->empty()) {
       std::string address(_serialNumber + ":" + std::to_string(channel));
@@ -16,11 +16,21 @@ using namespace BaseLib::DeviceDescription;
 
 namespace Knx {
 class KnxCentral;
-class Cemi;
-typedef std::shared_ptr<Cemi> PCemi;
 
 class KnxPeer : public BaseLib::Systems::Peer, public BaseLib::Rpc::IWebserverEventSink {
  public:
+  /**
+   * Estimated heap usage in bytes. Container overhead is approximated, so the values are meant for sizing, not exact.
+   */
+  struct MemoryUsage {
+    size_t parameterCount = 0;
+    size_t parameters = 0; //Parameter descriptions of the peer's device description
+    size_t valueCount = 0;
+    size_t values = 0; //valuesCentral and configCentral
+    size_t maps = 0; //Decode plan and grouped parameters
+    size_t converter = 0; //The DPT converter is shared by all peers, so this is always 0.
+  };
+
   KnxPeer(uint32_t parentID, IPeerEventSink *eventHandler);
   KnxPeer(int32_t id, int32_t address, std::string serialNumber, uint32_t parentID, IPeerEventSink *eventHandler);
   ~KnxPeer() override;
@@ -33,9 +43,60 @@ class KnxPeer : public BaseLib::Systems::Peer, public BaseLib::Rpc::IWebserverEv
   //End features
 
   void worker();
-  void interfaceReconnected() { _readVariables = true; }
+
+  /**
+   * @return Returns true when the peer sends its packets to the interface.
+   */
+  bool usesInterface(const std::string &interfaceId);
+
+  /**
+   * Returns the packets needed to acquire the state of the peer's variables after start up or a reconnect: reads for
+   * readable variables and writes of the last known value for "read on init" variables.
+   *
+   * @return Returns false when the peer has no device description.
+   */
+  bool getStartupPackets(std::vector<PCemi> &writes, std::vector<PCemi> &reads);
+
+  /**
+   * Returns the datapoint type and role of the first parameter assigned to a group address.
+   *
+   * @return Returns false when the peer has no parameter for the group address.
+   */
+  bool getGroupAddressType(uint16_t groupAddress, DptConverter::Dpt &dpt, BaseLib::Role &role);
+
+  /**
+   * Writes all values queued by queueParameterSave() to the database.
+   *
+   * @param queued Returns the number of values queued since the last call.
+   * @return Returns the number of values written. The difference to "queued" is the number of writes saved by
+   * coalescing.
+   */
+  size_t flushParameters(size_t &queued);
+
+  uint64_t getEventsRaised() { return _eventsRaised; }
+  uint64_t getEventsSuppressed() { return _eventsSuppressed; }
+
+  /**
+   * Queues the packet on the peer's communication interface or on all interfaces if none is set.
+   *
+   * @return Returns "queued" when the packet was accepted by all interfaces or the first error otherwise.
+   */
+  MainInterface::SendResult sendPacket(const PCemi &packet);
   std::string handleCliCommand(std::string command) override;
-  void packetReceived(PCemi &packet);
+  /**
+   * Processes a GroupValueWrite, GroupValueResponse or GroupValueRead to one of the peer's group addresses.
+   *
+   * @param decoder Shared by all peers receiving the packet, so every type is only decoded once.
+   * @param batchEvents When true, events are collected until the central calls flushEvents(). Otherwise one event per
+   * channel is raised for the packet.
+   */
+  void packetReceived(const PCemi &packet, TelegramDecoder &decoder, bool batchEvents);
+
+  /**
+   * Raises the events collected by packetReceived(). Values changed several times since the last call are only raised
+   * once with the latest value.
+   */
+  void flushEvents();
 
   bool load(BaseLib::Systems::ICentral *central) override;
   void savePeers() override {}
@@ -48,7 +109,11 @@ class KnxPeer : public BaseLib::Systems::Peer, public BaseLib::Rpc::IWebserverEv
   std::string getFormattedAddress();
 
   std::string printConfig();
+  MemoryUsage getMemoryUsage();
 
+  /**
+   * Builds the decode plan used by packetReceived(). Needs to be called again when valuesCentral or the peer ID change.
+   */
   void initParametersByGroupAddress();
   std::vector<uint16_t> getGroupAddresses();
 
@@ -68,10 +133,55 @@ class KnxPeer : public BaseLib::Systems::Peer, public BaseLib::Rpc::IWebserverEv
   PVariable setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel, std::string valueKey, PVariable value, bool wait) override;
   //End RPC methods
  protected:
+  struct GroupedParameterInfo {
+    PParameter parameter;
+    BaseLib::Systems::RpcConfigurationParameter *configParameter = nullptr; //Points into valuesCentral
+    DptConverter::Dpt dpt; //DPT of the parameter's cast
+    uint32_t bitPosition = 0;
+    uint32_t bitSize = 0;
+  };
+
+  /**
+   * Conditions under which no event is raised for a received value. The value is stored either way.
+   */
+  struct EventFilter {
+    bool suppressUnchanged = false; //Compares the raw value, so no conversion is necessary
+    double deadband = 0; //Absolute difference to the last raised value
+    double relativeDeadband = 0; //Difference to the last raised value in percent
+    int64_t minInterval = 0; //Minimum time between two events in milliseconds
+
+    bool enabled() const { return suppressUnchanged || deadband > 0 || relativeDeadband > 0 || minInterval > 0; }
+  };
+
+  /**
+   * Packets to the same group address are always processed by the same dispatcher thread, so no locking is needed.
+   */
+  struct EventFilterState {
+    int64_t lastEventTime = 0; //Steady time in milliseconds
+    bool hasLastValue = false;
+    double lastValue = 0;
+  };
+
   struct ParametersByGroupAddressInfo {
     int32_t channel = -1;
     ParameterCast::PGeneric cast;
+    DptConverter::Dpt dpt;
     PParameter parameter;
+    BaseLib::Systems::RpcConfigurationParameter *configParameter = nullptr; //Points into valuesCentral
+    std::string address; //"SERIAL:CHANNEL" as used in RPC events
+    std::shared_ptr<std::vector<std::string>> valueKeys; //Event keys when there are no grouped parameters. Never modified.
+    std::vector<GroupedParameterInfo> groupedParameters; //Parameters contained in a ".RAW" parameter
+    EventFilter eventFilter;
+    std::shared_ptr<EventFilterState> eventFilterState; //Only set when the filter is enabled
+  };
+
+  /**
+   * Everything packetReceived() needs to process a packet, resolved once by initParametersByGroupAddress(). Immutable
+   * once published except for the event filter states. It is replaced as a whole, so it can be used without locking.
+   */
+  struct DecodePlan {
+    std::string eventSource;
+    std::unordered_map<uint16_t, std::vector<ParametersByGroupAddressInfo>> parametersByGroupAddress;
   };
 
   struct GroupedParametersInfo {
@@ -81,25 +191,74 @@ class KnxPeer : public BaseLib::Systems::Peer, public BaseLib::Rpc::IWebserverEv
   };
 
   std::atomic_bool _stopWorkerThread;
-  std::atomic_bool _readVariables;
-  std::shared_ptr<DptConverter> _dptConverter;
-  std::map<uint16_t, std::vector<ParametersByGroupAddressInfo>> _parametersByGroupAddress;
+  std::shared_ptr<DecodePlan> _decodePlan;
   std::map<int32_t, std::map<std::string, GroupedParametersInfo>> _groupedParameters;
 
+  //{{{ Write-behind buffer for variables
+  std::mutex _parameterSavesMutex;
+  std::unordered_map<uint64_t, std::vector<uint8_t>> _parameterSaves; //Latest value by database ID
+  std::atomic<size_t> _parameterSavesQueued{0};
+  //}}}
+
+  //{{{ Event batching
+  struct PendingEvent {
+    std::string address; //"SERIAL:CHANNEL"
+    std::shared_ptr<std::vector<std::string>> valueKeys; //Shared with the decode plan until a key is added
+    std::shared_ptr<std::vector<PVariable>> values;
+  };
+
+  std::mutex _pendingEventsMutex;
+  std::string _pendingEventsSource;
+  std::map<int32_t, PendingEvent> _pendingEvents; //By channel
+
+  /**
+   * Adds values to the event of a channel. Values of keys already in the event are replaced.
+   */
+  static void addEvent(std::map<int32_t, PendingEvent> &events, int32_t channel, const std::string &address, const std::shared_ptr<std::vector<std::string>> &valueKeys, const std::shared_ptr<std::vector<PVariable>> &values);
+  //}}}
+
+  //{{{ Event filter statistics
+  std::atomic<uint64_t> _eventsRaised{0};
+  std::atomic<uint64_t> _eventsSuppressed{0};
+
+  /**
+   * Reads the event filter of a datapoint type from the family settings. Settings with the suffix "Dpt" followed by the
+   * main type (e. g. "eventDeadbandDpt9") take precedence over the general ones.
+   */
+  static EventFilter getEventFilter(const DptConverter::Dpt &dpt);
+
+  /**
+   * Queues a variable for saving. Only the latest value of every variable is kept until the central calls
+   * flushParameters(). Variables without database ID are saved immediately, so the ID is created.
+   */
+  void queueParameterSave(BaseLib::Systems::RpcConfigurationParameter &parameter, int32_t channel, const std::string &name, const std::vector<uint8_t> &data);
+  //}}}
+
   //{{{ getValueFromDevice
-  struct GetValueFromDeviceInfo {
-    bool requested = false;
+  /**
+   * A GroupValueRead waiting for its response. All reads of the same group address share one entry, so only one
+   * request is sent to the bus.
+   */
+  struct PendingRead {
+    int64_t time = 0; //Steady time in milliseconds when the request was sent
     std::mutex mutex;
     std::condition_variable conditionVariable;
-    bool mutexReady = false;
-
-    int32_t channel = -1;
-    std::string variableName;
-    PVariable value;
+    bool received = false;
+    std::map<std::pair<int32_t, std::string>, PVariable> values; //By channel and parameter ID. Only read once "received" is set.
   };
+  typedef std::shared_ptr<PendingRead> PPendingRead;
+
+  static constexpr int64_t _readTimeout = 1000;
+  std::mutex _pendingReadsMutex;
+  std::unordered_map<uint16_t, PPendingRead> _pendingReads; //By group address
+
+  static int64_t getSteadyTime();
 
-  std::mutex _getValueFromDeviceMutex;
-  GetValueFromDeviceInfo _getValueFromDeviceInfo;
+  /**
+   * Removes and returns the pending read of a group address. Returns nullptr if there is none.
+   */
+  PPendingRead takePendingRead(uint16_t groupAddress);
+  static void completePendingRead(const PPendingRead &pendingRead);
   //}}}
 
   void loadVariables(BaseLib::Systems::ICentral *central, std::shared_ptr<BaseLib::Database::DataTable> &rows) override;
@@ -111,9 +270,17 @@ class KnxPeer : public BaseLib::Systems::Peer, public BaseLib::Rpc::IWebserverEv
    */
   PVariable getValueFromDevice(PParameter &parameter, int32_t channel, bool asynchronous) override;
 
-  PParameterGroup getParameterSet(int32_t channel, ParameterGroup::Type::Enum type) override;
+  /**
+   * Sends a GroupValueRead and waits for the response. Any number of reads can be pending at the same time. Reads of a
+   * group address that already has a pending read don't send another request but wait for the same response.
+   *
+   * @param priority The KNX priority of the read request. Bulk reads should use "low" so they don't delay writes.
+   * @param asynchronous When true, the method returns immediately after sending the request. The value is delivered as a
+   * normal event when the response is received.
+   */
+  PVariable readValueFromDevice(PParameter &parameter, int32_t channel, Cemi::Priority priority, bool asynchronous);
 
-  void sendPacket(const PCemi &packet);
+  PParameterGroup getParameterSet(int32_t channel, ParameterGroup::Type::Enum type) override;
 
   // {{{ Hooks
   /**
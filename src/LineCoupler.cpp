@@ -0,0 +1,179 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "LineCoupler.h"
+#include "Gd.h"
+
+namespace Knx {
+
+LineCoupler::LineCoupler() {
+  _out.init(Gd::bl);
+  _out.setPrefix(Gd::out.getPrefix() + "Line coupler: ");
+}
+
+LineCoupler::~LineCoupler() {
+  stop();
+}
+
+void LineCoupler::addRoute(const std::string &sourceId, const std::string &targetId, std::unique_ptr<GroupAddressFilter> filter) {
+  try {
+    auto targetIterator = Gd::physicalInterfaces.find(targetId);
+    if (sourceId == targetId || targetIterator == Gd::physicalInterfaces.end() || Gd::physicalInterfaces.find(sourceId) == Gd::physicalInterfaces.end()) {
+      _out.printError("Error: Can't route from \"" + sourceId + "\" to \"" + targetId + "\". Please check \"routeTo\" in knx.conf.");
+      return;
+    }
+
+    auto route = std::make_unique<Route>();
+    route->sourceId = sourceId;
+    route->targetId = targetId;
+    route->target = targetIterator->second;
+    route->filter = std::move(filter);
+    _out.printInfo("Info: Routing " + (route->filter ? std::to_string(route->filter->count()) : std::string("all")) + " group addresses from " + sourceId + " to " + targetId + ".");
+    _routes[sourceId].emplace_back(std::move(route));
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void LineCoupler::start() {
+  try {
+    stop();
+    for (auto &routes : _routes) {
+      auto interfaceIterator = Gd::physicalInterfaces.find(routes.first);
+      if (interfaceIterator == Gd::physicalInterfaces.end()) continue;
+      _eventHandlers[routes.first] = interfaceIterator->second->addEventHandler((BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink *)this);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void LineCoupler::stop() {
+  try {
+    for (auto &eventHandler : _eventHandlers) {
+      auto interfaceIterator = Gd::physicalInterfaces.find(eventHandler.first);
+      if (interfaceIterator != Gd::physicalInterfaces.end()) interfaceIterator->second->removeEventHandler(eventHandler.second);
+    }
+    _eventHandlers.clear();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool LineCoupler::isOwnAddress(uint16_t address) {
+  for (auto &interface : Gd::physicalInterfaces) {
+    if (interface.second->isOwnAddress(address)) return true;
+  }
+  return false;
+}
+
+bool LineCoupler::wasRoutedRecently(Route &route, Cemi &telegram, bool repetition, int64_t time) {
+  std::lock_guard<std::mutex> recentTelegramsGuard(route.recentTelegramsMutex);
+  if (repetition) {
+    for (auto &recentTelegram : route.recentTelegrams) {
+      if (time - recentTelegram.time <= _repetitionTimeout && recentTelegram.destinationAddress == telegram.getDestinationAddress() && recentTelegram.sourceAddress == telegram.getSourceAddress()
+          && recentTelegram.payload == telegram.getPayload()) {
+        return true;
+      }
+    }
+  }
+
+  //The original telegram was not received, so the repetition is routed like an original.
+  auto &recentTelegram = route.recentTelegrams[route.recentTelegramsIndex];
+  route.recentTelegramsIndex = (route.recentTelegramsIndex + 1) % route.recentTelegrams.size();
+  recentTelegram.sourceAddress = telegram.getSourceAddress();
+  recentTelegram.destinationAddress = telegram.getDestinationAddress();
+  recentTelegram.payload = telegram.getPayload();
+  recentTelegram.time = time;
+  return false;
+}
+
+bool LineCoupler::onPacketReceived(std::string &senderId, std::shared_ptr<BaseLib::Systems::Packet> packet) {
+  try {
+    auto routesIterator = _routes.find(senderId);
+    if (routesIterator == _routes.end()) return false;
+    auto cemi = std::dynamic_pointer_cast<Cemi>(packet);
+    if (!cemi || cemi->getMessageCode() != 0x29) return false;
+
+    //Individual addresses are not assigned per line, so there is no way to decide where to route them.
+    if (!cemi->isGroupAddressed()) {
+      _individualTelegrams++;
+      return false;
+    }
+
+    //Sent by one of our interfaces, so probably routed by us before and looped back through another coupler.
+    if (isOwnAddress(cemi->getSourceAddress())) {
+      _loopsPrevented++;
+      return false;
+    }
+
+    auto hopCount = cemi->getHopCount();
+    if (hopCount == 0) {
+      _hopCountExceeded++;
+      return false;
+    }
+
+    auto time = BaseLib::HelperFunctions::getTime();
+    bool repetition = cemi->isRepetition();
+    for (auto &route : routesIterator->second) {
+      if (route->filter && !route->filter->contains(cemi->getDestinationAddress())) {
+        route->telegramsFiltered++;
+        continue;
+      }
+
+      if (wasRoutedRecently(*route, *cemi, repetition, time)) {
+        route->repetitionsDropped++;
+        continue;
+      }
+
+      //Every interface sets its own source address while sending, so every route needs its own copy.
+      auto telegram = std::make_shared<Cemi>(cemi->getBinary());
+      telegram->setMessageCode(0x11); //L_Data.req
+      if (hopCount < 7) telegram->setHopCount(hopCount - 1);
+      auto result = route->target->queuePacket(telegram);
+      if (result == MainInterface::SendResult::queued) route->telegramsRouted++;
+      else {
+        route->sendErrors++;
+        if (Gd::bl->debugLevel >= 4) _out.printInfo("Info: Could not route telegram to " + cemi->getFormattedDestinationAddress() + " to " + route->targetId + ": " + MainInterface::getSendResultString(result));
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  //The central needs to process the packet as well.
+  return false;
+}
+
+BaseLib::PVariable LineCoupler::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    auto routesArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    for (auto &routes : _routes) {
+      for (auto &route : routes.second) {
+        auto routeStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        routeStruct->structValue->emplace("source", std::make_shared<BaseLib::Variable>(route->sourceId));
+        routeStruct->structValue->emplace("target", std::make_shared<BaseLib::Variable>(route->targetId));
+        routeStruct->structValue->emplace("groupAddresses", std::make_shared<BaseLib::Variable>(route->filter ? (int64_t)route->filter->count() : (int64_t)65536));
+        routeStruct->structValue->emplace("telegramsRouted", std::make_shared<BaseLib::Variable>((int64_t)route->telegramsRouted));
+        routeStruct->structValue->emplace("telegramsFiltered", std::make_shared<BaseLib::Variable>((int64_t)route->telegramsFiltered));
+        routeStruct->structValue->emplace("repetitionsDropped", std::make_shared<BaseLib::Variable>((int64_t)route->repetitionsDropped));
+        routeStruct->structValue->emplace("sendErrors", std::make_shared<BaseLib::Variable>((int64_t)route->sendErrors));
+        routesArray->arrayValue->push_back(routeStruct);
+      }
+    }
+    statistics->structValue->emplace("routes", routesArray);
+    statistics->structValue->emplace("loopsPrevented", std::make_shared<BaseLib::Variable>((int64_t)_loopsPrevented));
+    statistics->structValue->emplace("hopCountExceeded", std::make_shared<BaseLib::Variable>((int64_t)_hopCountExceeded));
+    statistics->structValue->emplace("individualTelegrams", std::make_shared<BaseLib::Variable>((int64_t)_individualTelegrams));
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
@@ -0,0 +1,87 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef LINECOUPLER_H_
+#define LINECOUPLER_H_
+
+#include "Cemi.h"
+#include "GroupAddressFilter.h"
+#include "PhysicalInterfaces/MainInterface.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Knx {
+
+/**
+ * Routes group telegrams between communication interfaces like a KNX line coupler. Every route has a direction and its own
+ * filter table. Telegrams are queued on the target interface directly from the receive thread of the source interface.
+ *
+ * Loops are prevented like by a hardware coupler: The hop count is decremented and telegrams with a hop count of 0 are not
+ * routed. Telegrams sent by one of our interfaces are never routed again. Repetitions of a telegram that was already
+ * routed are dropped.
+ */
+class LineCoupler : public BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink {
+ public:
+  LineCoupler();
+  ~LineCoupler() override;
+
+  /**
+   * Adds a route. Must be called before start().
+   *
+   * @param filter Group addresses to route. Routes all group addresses when nullptr.
+   */
+  void addRoute(const std::string &sourceId, const std::string &targetId, std::unique_ptr<GroupAddressFilter> filter);
+  bool hasRoutes() { return !_routes.empty(); }
+
+  void start();
+  void stop();
+
+  bool onPacketReceived(std::string &senderId, std::shared_ptr<BaseLib::Systems::Packet> packet) override;
+
+  BaseLib::PVariable getStatistics();
+ private:
+  struct RecentTelegram {
+    uint16_t sourceAddress = 0;
+    uint16_t destinationAddress = 0;
+    std::vector<uint8_t> payload;
+    int64_t time = 0;
+  };
+
+  struct Route {
+    std::string sourceId;
+    std::string targetId;
+    std::shared_ptr<MainInterface> target;
+    std::unique_ptr<GroupAddressFilter> filter;
+
+    std::mutex recentTelegramsMutex;
+    std::array<RecentTelegram, 16> recentTelegrams;
+    size_t recentTelegramsIndex = 0;
+
+    std::atomic<uint64_t> telegramsRouted{0};
+    std::atomic<uint64_t> telegramsFiltered{0};
+    std::atomic<uint64_t> repetitionsDropped{0};
+    std::atomic<uint64_t> sendErrors{0};
+  };
+
+  static constexpr int64_t _repetitionTimeout = 1000; //In milliseconds
+
+  BaseLib::Output _out;
+  //Not modified after start()
+  std::unordered_map<std::string, std::vector<std::unique_ptr<Route>>> _routes; //By source interface ID
+  std::map<std::string, BaseLib::PEventHandler> _eventHandlers;
+
+  std::atomic<uint64_t> _loopsPrevented{0};
+  std::atomic<uint64_t> _hopCountExceeded{0};
+  std::atomic<uint64_t> _individualTelegrams{0};
+
+  static bool isOwnAddress(uint16_t address);
+
+  /**
+   * Returns true when the same telegram was routed within the last second, so a repetition doesn't need to be routed.
+   * Otherwise the telegram is remembered.
+   */
+  static bool wasRoutedRecently(Route &route, Cemi &telegram, bool repetition, int64_t time);
+};
+
+}
+
+#endif
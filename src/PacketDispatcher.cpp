@@ -0,0 +1,172 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "PacketDispatcher.h"
+#include "Gd.h"
+
+namespace Knx {
+
+PacketDispatcher::PacketDispatcher(uint32_t shardCount, uint32_t maxQueueSize, Callback callback) {
+  _out.init(Gd::bl);
+  _out.setPrefix(Gd::out.getPrefix() + "Packet dispatcher: ");
+
+  if (shardCount < 1) shardCount = 1;
+  _maxQueueSize = maxQueueSize < 1 ? 1 : maxQueueSize;
+  _callback = std::move(callback);
+  _shards.reserve(shardCount);
+  for (uint32_t i = 0; i < shardCount; i++) {
+    _shards.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+PacketDispatcher::~PacketDispatcher() {
+  stop();
+}
+
+int64_t PacketDispatcher::getSteadyTime() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PacketDispatcher::updateMaximum(std::atomic<int64_t> &maximum, int64_t value) {
+  int64_t currentMaximum = maximum;
+  while (value > currentMaximum && !maximum.compare_exchange_weak(currentMaximum, value));
+}
+
+void PacketDispatcher::start() {
+  try {
+    stop();
+    _stop = false;
+    for (auto &shard : _shards) {
+      Gd::bl->threadManager.start(shard->thread, true, Gd::bl->settings.workerThreadPriority(), Gd::bl->settings.workerThreadPolicy(), &PacketDispatcher::worker, this, shard.get());
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void PacketDispatcher::stop() {
+  try {
+    _stop = true;
+    for (auto &shard : _shards) {
+      {
+        std::lock_guard<std::mutex> queueGuard(shard->queueMutex);
+        shard->queue.clear();
+        shard->queueSize = 0;
+      }
+      shard->queueConditionVariable.notify_all();
+      Gd::bl->threadManager.join(shard->thread);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool PacketDispatcher::enqueue(const PCemi &packet) {
+  try {
+    if (_stop || !packet) return false;
+    //Group addresses are distributed evenly, so a simple modulo is sufficient.
+    auto &shard = _shards.at(packet->getDestinationAddress() % _shards.size());
+
+    {
+      std::lock_guard<std::mutex> queueGuard(shard->queueMutex);
+      if (shard->queue.size() >= _maxQueueSize) {
+        shard->packetsDropped++;
+        shard->packetsDroppedWhileFull++;
+        //This is called on the reactor thread, so only log the transition to avoid flooding the log under overload.
+        if (!shard->full) {
+          shard->full = true;
+          _out.printError("Error: Queue is full. Dropping packets until there is space again. First dropped packet was sent to " + Cemi::getFormattedGroupAddress(packet->getDestinationAddress()) + ".");
+        }
+        return false;
+      }
+      if (shard->full) {
+        shard->full = false;
+        _out.printWarning("Warning: Queue is accepting packets again. " + std::to_string(shard->packetsDroppedWhileFull) + " packets were dropped.");
+        shard->packetsDroppedWhileFull = 0;
+      }
+      shard->queue.emplace_back(QueueEntry{packet, getSteadyTime()});
+      shard->queueSize = shard->queue.size();
+      if (shard->queueSize > shard->maxQueueSize) shard->maxQueueSize = shard->queueSize.load();
+    }
+    shard->queueConditionVariable.notify_one();
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void PacketDispatcher::worker(Shard *shard) {
+  while (!_stop) {
+    try {
+      QueueEntry entry;
+
+      {
+        std::unique_lock<std::mutex> queueGuard(shard->queueMutex);
+        shard->queueConditionVariable.wait_for(queueGuard, std::chrono::milliseconds(1000), [&] { return !shard->queue.empty() || _stop; });
+        if (_stop) return;
+        if (shard->queue.empty()) continue;
+        entry = std::move(shard->queue.front());
+        shard->queue.pop_front();
+        shard->queueSize = shard->queue.size();
+      }
+
+      auto startTime = getSteadyTime();
+      auto waitTime = startTime - entry.time;
+      shard->waitTimeSum += waitTime;
+      updateMaximum(shard->maxWaitTime, waitTime);
+
+      if (_callback) _callback(entry.packet);
+
+      auto processingTime = getSteadyTime() - startTime;
+      shard->processingTimeSum += processingTime;
+      updateMaximum(shard->maxProcessingTime, processingTime);
+      shard->packetsProcessed++;
+    }
+    catch (const std::exception &ex) {
+      _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+}
+
+BaseLib::PVariable PacketDispatcher::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    auto shardsArray = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    shardsArray->arrayValue->reserve(_shards.size());
+    int64_t queueSize = 0;
+    int64_t packetsProcessed = 0;
+    int64_t packetsDropped = 0;
+    for (auto &shard : _shards) {
+      auto shardStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      int64_t shardPacketsProcessed = shard->packetsProcessed;
+      shardStruct->structValue->emplace("queueSize", std::make_shared<BaseLib::Variable>((int32_t)shard->queueSize));
+      shardStruct->structValue->emplace("maxQueueSize", std::make_shared<BaseLib::Variable>((int32_t)shard->maxQueueSize));
+      shardStruct->structValue->emplace("packetsProcessed", std::make_shared<BaseLib::Variable>(shardPacketsProcessed));
+      shardStruct->structValue->emplace("packetsDropped", std::make_shared<BaseLib::Variable>((int64_t)shard->packetsDropped));
+      shardStruct->structValue->emplace("averageWaitTime", std::make_shared<BaseLib::Variable>(shardPacketsProcessed > 0 ? shard->waitTimeSum / shardPacketsProcessed : (int64_t)0));
+      shardStruct->structValue->emplace("maxWaitTime", std::make_shared<BaseLib::Variable>((int64_t)shard->maxWaitTime));
+      shardStruct->structValue->emplace("averageProcessingTime", std::make_shared<BaseLib::Variable>(shardPacketsProcessed > 0 ? shard->processingTimeSum / shardPacketsProcessed : (int64_t)0));
+      shardStruct->structValue->emplace("maxProcessingTime", std::make_shared<BaseLib::Variable>((int64_t)shard->maxProcessingTime));
+      shardsArray->arrayValue->push_back(shardStruct);
+
+      queueSize += shard->queueSize;
+      packetsProcessed += shardPacketsProcessed;
+      packetsDropped += shard->packetsDropped;
+    }
+    statistics->structValue->emplace("queueSize", std::make_shared<BaseLib::Variable>(queueSize));
+    statistics->structValue->emplace("queueMaxSize", std::make_shared<BaseLib::Variable>((int64_t)_maxQueueSize));
+    statistics->structValue->emplace("packetsProcessed", std::make_shared<BaseLib::Variable>(packetsProcessed));
+    statistics->structValue->emplace("packetsDropped", std::make_shared<BaseLib::Variable>(packetsDropped));
+    statistics->structValue->emplace("shards", shardsArray); //Times in microseconds
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
@@ -0,0 +1,77 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef PACKETDISPATCHER_H_
+#define PACKETDISPATCHER_H_
+
+#include "Cemi.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Knx {
+
+/**
+ * Moves the processing of received packets off the reactor thread. Packets are distributed over a fixed number of shards
+ * by destination address. Every shard has its own queue and worker thread, so packets to the same group address are
+ * always processed in the order they were received, while slow processing of one group address (e. g. a database write)
+ * doesn't delay the others or the ACKs to the gateway.
+ */
+class PacketDispatcher {
+ public:
+  typedef std::function<void(const PCemi &packet)> Callback;
+
+  /**
+   * @param shardCount The number of queues and worker threads.
+   * @param maxQueueSize The maximum number of packets per queue. When a queue is full, new packets are dropped.
+   * @param callback Called on the worker threads for every packet.
+   */
+  PacketDispatcher(uint32_t shardCount, uint32_t maxQueueSize, Callback callback);
+  virtual ~PacketDispatcher();
+
+  void start();
+  void stop();
+
+  /**
+   * Queues a packet. Never blocks.
+   *
+   * @return Returns false when the queue is full or the dispatcher is stopped.
+   */
+  bool enqueue(const PCemi &packet);
+
+  BaseLib::PVariable getStatistics();
+ private:
+  struct QueueEntry {
+    PCemi packet;
+    int64_t time = 0; //Steady time in microseconds
+  };
+
+  struct Shard {
+    std::thread thread;
+    std::mutex queueMutex;
+    std::condition_variable queueConditionVariable;
+    std::deque<QueueEntry> queue;
+    bool full = false; //Protected by queueMutex. Set when packets are dropped, so only the first drop is logged.
+    uint64_t packetsDroppedWhileFull = 0; //Protected by queueMutex
+    std::atomic<uint32_t> queueSize{0};
+    std::atomic<uint32_t> maxQueueSize{0}; //Highest queue size reached
+    std::atomic<uint64_t> packetsProcessed{0};
+    std::atomic<uint64_t> packetsDropped{0};
+    std::atomic<int64_t> waitTimeSum{0};
+    std::atomic<int64_t> maxWaitTime{0};
+    std::atomic<int64_t> processingTimeSum{0};
+    std::atomic<int64_t> maxProcessingTime{0};
+  };
+
+  BaseLib::Output _out;
+  std::atomic_bool _stop{true};
+  uint32_t _maxQueueSize = 1000;
+  Callback _callback;
+  std::vector<std::unique_ptr<Shard>> _shards;
+
+  static int64_t getSteadyTime();
+  static void updateMaximum(std::atomic<int64_t> &maximum, int64_t value);
+  void worker(Shard *shard);
+};
+
+}
+
+#endif
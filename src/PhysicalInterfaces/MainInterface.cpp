@@ -5,41 +5,108 @@
 #include "../Cemi.h"
 #include "../KnxIpPacket.h"
 
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+
 namespace Knx {
 
+namespace {
+/**
+ * Returns the index of the send queue for the priority. Lower indexes are sent first.
+ */
+size_t getSendQueueIndex(Cemi::Priority priority) {
+  switch (priority) {
+    case Cemi::Priority::system:return 0;
+    case Cemi::Priority::urgent:return 1;
+    case Cemi::Priority::normal:return 2;
+    case Cemi::Priority::low:return 3;
+  }
+  return 2;
+}
+}
+
 MainInterface::MainInterface(const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings) : IPhysicalInterface(Gd::bl, Gd::family->getFamily(), settings) {
   _out.init(Gd::bl);
+
+  //TUNNELING_REQUEST_TIMEOUT is 1 second (section 3.8.4 of the KNX Standard). We only wait that long until we know the gateway's response time.
+  _ackRtt.minTimeout = 50;
+  _ackRtt.maxTimeout = 1000;
+  _ackRtt.initialTimeout = 1000;
+  _confirmationRtt.minTimeout = 200;
+  _confirmationRtt.maxTimeout = 3000;
+  _confirmationRtt.initialTimeout = 1000;
   _out.setPrefix(Gd::out.getPrefix() + "KNXNet/IP \"" + settings->id + "\": ");
 
   signal(SIGPIPE, SIG_IGN);
 
-  _socket = std::unique_ptr<BaseLib::UdpSocket>(new BaseLib::UdpSocket(_bl));
-
-  if (settings->listenThreadPriority == -1) {
-    settings->listenThreadPriority = 45;
-    settings->listenThreadPolicy = SCHED_FIFO;
-  }
-
   _stopped = true;
 
   auto settingsIterator = settings->all.find("physicaladdress");
   if (settingsIterator != settings->all.end()) _physicalAddress = Cemi::parsePhysicalAddress(settingsIterator->second->stringValue);
+
+  settingsIterator = settings->all.find("tunnelcount");
+  if (settingsIterator != settings->all.end()) {
+    _tunnelCountSetting = settingsIterator->second->integerValue64 < 0 ? 1 : (uint32_t)settingsIterator->second->integerValue64;
+    if (_tunnelCountSetting > 8) {
+      _out.printWarning("Warning: At most 8 tunnels are supported. Setting \"tunnelCount\" is reduced to 8.");
+      _tunnelCountSetting = 8;
+    }
+  }
+
+  _tunnels.reserve(_tunnelCountSetting == 0 ? 8 : _tunnelCountSetting);
+  for (uint32_t i = 0; i < _tunnels.capacity(); i++) {
+    auto tunnel = std::make_shared<Tunnel>();
+    tunnel->index = i;
+    _tunnels.push_back(tunnel);
+  }
+
+  settingsIterator = settings->all.find("sendqueuesize");
+  if (settingsIterator != settings->all.end() && settingsIterator->second->integerValue64 > 0) _maxSendQueueSize = settingsIterator->second->integerValue64;
+
+  settingsIterator = settings->all.find("sendqueuetimeout");
+  if (settingsIterator != settings->all.end() && settingsIterator->second->integerValue64 >= 0) _sendQueueTimeout = settingsIterator->second->integerValue64 * 1000;
+
+  settingsIterator = settings->all.find("confirmationpolicy");
+  if (settingsIterator != settings->all.end()) {
+    auto confirmationPolicy = BaseLib::HelperFunctions::toLower(settingsIterator->second->stringValue);
+    if (confirmationPolicy == "none") _confirmationPolicy = ConfirmationPolicy::none;
+    else if (confirmationPolicy == "ack") _confirmationPolicy = ConfirmationPolicy::ack;
+    else if (confirmationPolicy == "confirmation") _confirmationPolicy = ConfirmationPolicy::confirmation;
+    else _out.printWarning("Warning: Unknown value for setting \"confirmationPolicy\": " + settingsIterator->second->stringValue);
+  }
 }
 
 MainInterface::~MainInterface() {
+  removeCallbacks();
+}
+
+void MainInterface::removeCallbacks() {
   try {
+    _listening = false;
+    removeTimer(_heartbeatTimer);
+    removeTimer(_reconnectTimer);
     _stopCallbackThread = true;
-    Gd::bl->threadManager.join(_keepAliveThread);
-    Gd::bl->threadManager.join(_listenThread);
-    Gd::bl->threadManager.join(_initThread);
+    for (auto &tunnel : _tunnels) {
+      tunnel->sendQueueConditionVariable.notify_all();
+      Gd::bl->threadManager.join(tunnel->sendThread);
+    }
+    closeSocket();
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
+void MainInterface::removeTimer(std::atomic<uint64_t> &timer) {
+  uint64_t timerId = 0;
+  while ((timerId = timer.exchange(0)) != 0) {
+    Gd::reactor->removeTimer(timerId);
+  }
+}
+
 uint8_t MainInterface::getChannelId() {
-  return _channelId;
+  return _tunnels.at(0)->channelId;
 }
 
 uint8_t MainInterface::getManagementChannelId() {
@@ -47,11 +114,11 @@ uint8_t MainInterface::getManagementChannelId() {
 }
 
 uint8_t MainInterface::getSequenceCounter() {
-  return _sequenceCounter;
+  return _tunnels.at(0)->sequenceCounter;
 }
 
 void MainInterface::incrementSequenceCounter() {
-  _sequenceCounter++;
+  _tunnels.at(0)->sequenceCounter++;
 }
 
 uint8_t MainInterface::getManagementSequenceCounter() {
@@ -66,6 +133,48 @@ uint16_t MainInterface::getGatewayAddress() {
   return _gatewayAddress;
 }
 
+void MainInterface::addReconnectedCallback(std::function<void()> callback) {
+  std::lock_guard<std::mutex> reconnectedCallbacksGuard(_reconnectedCallbacksMutex);
+  _reconnectedCallbacks.emplace_back(std::move(callback));
+}
+
+void MainInterface::raiseReconnected() {
+  try {
+    std::vector<std::function<void()>> callbacks;
+    {
+      std::lock_guard<std::mutex> reconnectedCallbacksGuard(_reconnectedCallbacksMutex);
+      callbacks = _reconnectedCallbacks;
+    }
+    for (auto &callback : callbacks) {
+      if (callback) callback();
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MainInterface::addPacketSentCallback(std::function<void(const PCemi &packet)> callback) {
+  std::lock_guard<std::mutex> packetSentCallbacksGuard(_packetSentCallbacksMutex);
+  _packetSentCallbacks.emplace_back(std::move(callback));
+}
+
+void MainInterface::raisePacketSent(const PCemi &packet) {
+  try {
+    std::vector<std::function<void(const PCemi &packet)>> callbacks;
+    {
+      std::lock_guard<std::mutex> packetSentCallbacksGuard(_packetSentCallbacksMutex);
+      callbacks = _packetSentCallbacks;
+    }
+    for (auto &callback : callbacks) {
+      if (callback) callback(packet);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 uint16_t MainInterface::getPhysicalAddress() {
   return _physicalAddress;
 }
@@ -84,66 +193,424 @@ std::array<uint8_t, 2> MainInterface::getListenPortBytes() {
 
 void MainInterface::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet) {
   try {
-    if (!packet) {
+    PCemi cemi = std::dynamic_pointer_cast<Cemi>(packet);
+    if (!cemi) {
       _out.printWarning("Warning: Packet was nullptr.");
       return;
     }
-    if (!isOpen() || _stopped) {
-      _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because device is not connected or opened."));
-      return;
+    queuePacket(cemi);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+MainInterface::SendResult MainInterface::queuePacket(const PCemi &packet, const SendCallback &callback) {
+  try {
+    if (!packet) {
+      _out.printWarning("Warning: Packet was nullptr.");
+      return SendResult::sendError;
     }
+    if (!_listening) {
+      _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because device is not opened."));
+      _packetsRejected++;
+      return SendResult::notConnected;
+    }
+    //While the connection is reestablished, packets are kept in the send queue and sent once we are connected again.
     if (_managementConnected) {
       _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because a management connection is open."));
-      return;
+      _packetsRejected++;
+      return SendResult::notConnected;
     }
 
-    std::unique_lock<std::mutex> sendPacketGuard(_sendPacketMutex, std::defer_lock);
-    std::unique_lock<std::mutex> requestsGuard(_requestsMutex, std::defer_lock);
-    std::lock(sendPacketGuard, requestsGuard);
+    uint32_t tunnelCount = _connectedTunnelCount;
+    if (tunnelCount == 0) tunnelCount = 1;
+    auto &tunnel = _tunnels.at(packet->getDestinationAddress() % tunnelCount);
 
-    //{{{ Prepare requests object
-    auto request = std::make_shared<Request>();
-    uint32_t serviceType = 0x2E0420;
-    _requests[serviceType] = request;
-    requestsGuard.unlock();
-    std::unique_lock<std::mutex> lock(request->mutex);
-    //}}}
+    {
+      std::lock_guard<std::mutex> sendQueueGuard(tunnel->sendQueueMutex);
+      if (_sendQueueSize >= _maxSendQueueSize) {
+        _out.printError("Error: Send queue is full. Dropping packet to " + Cemi::getFormattedGroupAddress(packet->getDestinationAddress()) + ".");
+        _packetsRejected++;
+        return SendResult::queueFull;
+      }
+      QueueEntry entry;
+      entry.packet = packet;
+      entry.callback = callback;
+      entry.time = BaseLib::HelperFunctions::getTime();
+      tunnel->sendQueues.at(getSendQueueIndex(packet->getPriority())).push_back(std::move(entry));
+      tunnel->sendQueueSize++;
+      _sendQueueSize++;
+    }
+    tunnel->sendQueueConditionVariable.notify_one();
 
-    PCemi cemi = std::dynamic_pointer_cast<Cemi>(packet);
-    cemi->setSourceAddress(_physicalAddress);
-    PKnxIpPacket myIpPacket = std::make_shared<KnxIpPacket>(_channelId, _sequenceCounter++, cemi);
-    std::vector<uint8_t> data = myIpPacket->getBinary();
-    if (data.size() > 200) {
-      if (_bl->debugLevel >= 2) _out.printError("Error: Tried to send packet larger than 200 bytes. That is not supported.");
-      return;
+    return SendResult::queued;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return SendResult::sendError;
+}
+
+std::string MainInterface::getSendResultString(SendResult result) {
+  switch (result) {
+    case SendResult::success:return "Packet was sent.";
+    case SendResult::queued:return "Packet was queued.";
+    case SendResult::queueFull:return "Send queue of communication interface is full.";
+    case SendResult::notConnected:return "Communication interface is not connected.";
+    case SendResult::tooLarge:return "Packet is too large.";
+    case SendResult::noAck:return "No TUNNELING_ACK received.";
+    case SendResult::ackError:return "TUNNELING_ACK returned an error.";
+    case SendResult::noConfirmation:return "No L_Data.con received.";
+    case SendResult::confirmationError:return "L_Data.con returned an error.";
+    case SendResult::sendError:return "Error sending packet.";
+    case SendResult::expired:return "Packet expired before the connection to the communication interface was reestablished.";
+  }
+
+  return "";
+}
+
+void MainInterface::sendQueueWorker(PTunnel tunnel) {
+  while (!_stopCallbackThread) {
+    try {
+      //Reconnecting blocks until the gateway responds, so it can't be done on the reactor thread.
+      if (tunnel->index == 0 && _reconnectDue.exchange(false)) {
+        _reconnectScheduled = false;
+        reconnect();
+        continue;
+      }
+
+      QueueEntry entry;
+
+      {
+        std::unique_lock<std::mutex> sendQueueGuard(tunnel->sendQueueMutex);
+        tunnel->sendQueueConditionVariable.wait_for(sendQueueGuard, std::chrono::milliseconds(1000), [&] { return tunnel->sendQueueSize > 0 || _stopCallbackThread || (tunnel->index == 0 && _reconnectDue); });
+        if (_stopCallbackThread) return;
+        if (tunnel->sendQueueSize == 0 || (tunnel->index == 0 && _reconnectDue)) continue;
+        if (!isOpen() || _stopped) {
+          //Keep the packets until the connection is reestablished.
+          tunnel->sendQueueConditionVariable.wait_for(sendQueueGuard, std::chrono::milliseconds(100), [&] { return _stopCallbackThread || (tunnel->index == 0 && _reconnectDue); });
+          sendQueueGuard.unlock();
+          expireSendQueue(tunnel);
+          continue;
+        }
+        if (!tunnel->connected) {
+          //Less tunnels are open than before the reconnect. The packets can't be sent in the correct order anymore.
+          sendQueueGuard.unlock();
+          clearSendQueue(tunnel, SendResult::notConnected);
+          continue;
+        }
+
+        for (auto &queue : tunnel->sendQueues) {
+          if (queue.empty()) continue;
+          entry = std::move(queue.front());
+          queue.pop_front();
+          tunnel->sendQueueSize--;
+          _sendQueueSize--;
+          break;
+        }
+      }
+
+      if (!entry.packet) continue;
+
+      if (_sendQueueTimeout > 0 && BaseLib::HelperFunctions::getTime() - entry.time > _sendQueueTimeout) {
+        _packetsExpired++;
+        if (entry.callback) entry.callback(SendResult::expired);
+        continue;
+      }
+
+      auto result = transmitPacket(tunnel, entry.packet);
+      if (result == SendResult::success) {
+        tunnel->packetsSent++;
+        raisePacketSent(entry.packet);
+      } else tunnel->sendErrors++;
+      if (entry.callback) entry.callback(result);
     }
-    std::vector<uint8_t> response;
-    getResponse(ServiceType::TUNNELING_ACK, data, response, 200);
-    if (response.size() < 10) {
-      if (response.empty()) _out.printError("Error: No TUNNELING_ACK packet received (group address " + Cemi::getFormattedGroupAddress(cemi->getDestinationAddress()) + "): " + BaseLib::HelperFunctions::getHexString(response));
-      else _out.printError("Error: TUNNELING_ACK packet is too small: " + BaseLib::HelperFunctions::getHexString(response));
-      return;
+    catch (const std::exception &ex) {
+      _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    if (response.at(9) != (uint8_t)KnxIpErrorCodes::E_NO_ERROR) {
-      _out.printError("Error in TUNNELING_ACK (" + std::to_string(response.at(9)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(9)));
-      return;
+  }
+}
+
+void MainInterface::expireSendQueue(const PTunnel &tunnel) {
+  try {
+    if (_sendQueueTimeout <= 0) return;
+    std::vector<QueueEntry> expiredEntries;
+    auto time = BaseLib::HelperFunctions::getTime();
+
+    {
+      std::lock_guard<std::mutex> sendQueueGuard(tunnel->sendQueueMutex);
+      for (auto &queue : tunnel->sendQueues) {
+        //Entries are ordered by time
+        while (!queue.empty() && time - queue.front().time > _sendQueueTimeout) {
+          expiredEntries.push_back(std::move(queue.front()));
+          queue.pop_front();
+          tunnel->sendQueueSize--;
+          _sendQueueSize--;
+        }
+      }
     }
 
-    //{{{ Wait for 2E packet
-    if (!request->conditionVariable.wait_for(lock, std::chrono::milliseconds(1000), [&] { return request->mutexReady; })) {
-      _out.printError("Error: No data control packet received in response to packet.");
-    } else if (request->response.size() > 8) sendAck(request->response.at(8), 0);
+    if (expiredEntries.empty()) return;
+    _packetsExpired += expiredEntries.size();
+    _out.printWarning("Warning: Dropping " + std::to_string(expiredEntries.size()) + " packets from send queue, because they could not be sent within " + std::to_string(_sendQueueTimeout / 1000) + " seconds.");
+    for (auto &entry : expiredEntries) {
+      if (entry.callback) entry.callback(SendResult::expired);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MainInterface::clearSendQueue(const PTunnel &tunnel, SendResult result) {
+  try {
+    std::array<std::deque<QueueEntry>, 4> queues;
+
+    {
+      std::lock_guard<std::mutex> sendQueueGuard(tunnel->sendQueueMutex);
+      queues.swap(tunnel->sendQueues);
+      _sendQueueSize -= tunnel->sendQueueSize;
+      tunnel->sendQueueSize = 0;
+    }
+
+    for (auto &queue : queues) {
+      for (auto &entry : queue) {
+        if (entry.callback) entry.callback(result);
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
 
-    requestsGuard.lock();
-    _requests.erase(serviceType);
-    requestsGuard.unlock();
+MainInterface::SendResult MainInterface::transmitPacket(const PTunnel &tunnel, const PCemi &cemi) {
+  try {
+    if (!isOpen() || _stopped || _managementConnected || !tunnel->connected) return SendResult::notConnected;
+
+    std::lock_guard<std::mutex> sendPacketGuard(tunnel->sendPacketMutex);
+
+    //Only the primary tunnel uses the configured physical address. The other tunnels need their own addresses, so we can identify our own packets.
+    cemi->setSourceAddress(tunnel->index == 0 ? _physicalAddress.load() : tunnel->address.load());
+    uint8_t channelId = tunnel->channelId;
+    uint8_t sequenceCounter = tunnel->sequenceCounter++;
+    auto &data = tunnel->sendBuffer;
+    data.clear();
+    KnxIpPacket::appendTunnelingRequest(data, channelId, sequenceCounter, *cemi);
+    if (data.size() > 200) {
+      if (_bl->debugLevel >= 2) _out.printError("Error: Tried to send packet larger than 200 bytes. That is not supported.");
+      return SendResult::tooLarge;
+    }
+
+    //{{{ Prepare requests object
+    //The L_Data.con is identified by channel and group address.
+    RequestKey confirmationKey{ServiceType::TUNNELING_REQUEST, channelId, cemi->getDestinationAddress()};
+    auto request = std::make_shared<Request>();
+    request->name = "L_DATA_CON";
+    if (_confirmationPolicy == ConfirmationPolicy::confirmation && !addRequest(confirmationKey, request, 1000)) return SendResult::noConfirmation;
+    std::unique_lock<std::mutex> lock(request->mutex, std::defer_lock);
     //}}}
 
+    auto result = SendResult::success;
+    if (_confirmationPolicy == ConfirmationPolicy::none) {
+      try {
+        if (_bl->debugLevel >= 4) _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(data));
+        writeSocket(data);
+      }
+      catch (const C1Net::Exception &ex) {
+        _out.printError("Error sending packet to gateway: " + std::string(ex.what()));
+        result = SendResult::sendError;
+      }
+    } else {
+      std::vector<uint8_t> response;
+      bool ackReceived = false;
+      int64_t ackTime = 0; //In microseconds
+      if (_hostProtocolCode == 0x02) {
+        //There are no TUNNELING_ACKs over TCP (section 3.8.4 of the KNX Standard). TCP guarantees delivery.
+        try {
+          if (_bl->debugLevel >= 4) _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(data));
+          writeSocket(data);
+          response = std::vector<uint8_t>{0x06, 0x10, 0x04, 0x21, 0x00, 0x0A, 0x04, channelId, 0, (uint8_t)KnxIpErrorCodes::E_NO_ERROR};
+          ackReceived = true;
+          ackTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+        }
+        catch (const C1Net::Exception &ex) {
+          _out.printError("Error sending packet to gateway: " + std::string(ex.what()));
+          connectionLost();
+        }
+      } else {
+        //{{{ Send packet and repeat it once with the same sequence counter if it is not acknowledged (section 3.8.4 of the KNX Standard)
+        for (int32_t i = 0; i < 2; i++) {
+          if (i == 1) {
+            _retransmissions++;
+            _out.printWarning("Warning: Repeating packet to " + Cemi::getFormattedGroupAddress(cemi->getDestinationAddress()) + ".");
+          }
+          auto responseTime = sendAndWaitForResponse(RequestKey{ServiceType::TUNNELING_ACK, channelId, sequenceCounter}, data, response, getRttTimeout(_ackRtt));
+          //Only use the response time of the first try. We don't know which try a late ACK belongs to.
+          if (i == 0 && responseTime >= 0) addRttSample(_ackRtt, responseTime);
+          if (response.size() < 10) {
+            _ackTimeouts++;
+            if (response.empty()) _out.printError("Error: No TUNNELING_ACK packet received (group address " + Cemi::getFormattedGroupAddress(cemi->getDestinationAddress()) + "): " + BaseLib::HelperFunctions::getHexString(response));
+            else _out.printError("Error: TUNNELING_ACK packet is too small: " + BaseLib::HelperFunctions::getHexString(response));
+            continue;
+          } else if (response.at(9) != (uint8_t)KnxIpErrorCodes::E_NO_ERROR) {
+            _out.printError("Error in TUNNELING_ACK (" + std::to_string(response.at(9)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(9)));
+            continue;
+          }
+          ackReceived = true;
+          ackTime = BaseLib::HelperFunctions::getTimeMicroseconds();
+          break;
+        }
+        //}}}
+      }
+      if (!ackReceived) {
+        result = response.size() < 10 ? SendResult::noAck : SendResult::ackError;
+        if (_hostProtocolCode != 0x02) {
+          //The connection is considered broken after the repetition failed.
+          _out.printError("Error: Packet was not acknowledged after repetition. Reconnecting...");
+          _connectionFailures++;
+          sendDisconnectRequest(channelId);
+          connectionLost();
+        }
+      } else if (_confirmationPolicy == ConfirmationPolicy::confirmation) {
+        //{{{ Wait for 2E packet
+        lock.lock();
+        bool received = request->conditionVariable.wait_for(lock, std::chrono::milliseconds(getRttTimeout(_confirmationRtt)), [&] { return request->mutexReady; });
+        //The confirmation timeout starts after the ACK, so measure from there. Otherwise the ACK wait and retransmissions
+        //would inflate the estimate. The L_Data.con can arrive before the ACK is processed.
+        auto responseTime = std::max((int64_t)0, (received ? request->responseTime : BaseLib::HelperFunctions::getTimeMicroseconds()) - ackTime);
+        addRequestStatistics(request->name, responseTime, !received);
+        if (received) addRttSample(_confirmationRtt, responseTime);
+        else _confirmationTimeouts++;
+        if (!received) {
+          _out.printError("Error: No data control packet received in response to packet.");
+          result = SendResult::noConfirmation;
+        } else if (request->response.size() > 8) {
+          if (_hostProtocolCode != 0x02) sendAck(channelId, request->response.at(8), 0);
+          //Confirm flag (bit 0 of control field 1) is set on errors
+          if (request->response.size() > 12 && request->response.size() > 12u + request->response.at(11) && (request->response.at(12 + request->response.at(11)) & 0x01)) {
+            _out.printError("Error: L_Data.con with error flag received in response to packet to " + Cemi::getFormattedGroupAddress(cemi->getDestinationAddress()) + ".");
+            result = SendResult::confirmationError;
+          }
+        }
+        //}}}
+      }
+    }
+
+    if (lock.owns_lock()) lock.unlock();
+    if (_confirmationPolicy == ConfirmationPolicy::confirmation) removeRequest(confirmationKey);
+
     _lastPacketSent = BaseLib::HelperFunctions::getTime();
+    return result;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return SendResult::sendError;
+}
+
+BaseLib::PVariable MainInterface::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    statistics->structValue->emplace("connected", std::make_shared<BaseLib::Variable>(isOpen() && !_stopped));
+    statistics->structValue->emplace("packetsRejected", std::make_shared<BaseLib::Variable>((int64_t)_packetsRejected));
+    statistics->structValue->emplace("packetsExpired", std::make_shared<BaseLib::Variable>((int64_t)_packetsExpired));
+    statistics->structValue->emplace("sendQueueSize", std::make_shared<BaseLib::Variable>((int32_t)_sendQueueSize));
+    statistics->structValue->emplace("sendQueueMaxSize", std::make_shared<BaseLib::Variable>(_maxSendQueueSize));
+    statistics->structValue->emplace("tunnelCount", std::make_shared<BaseLib::Variable>((int32_t)_connectedTunnelCount));
+
+    uint64_t packetsSent = 0;
+    uint64_t sendErrors = 0;
+    std::array<int32_t, 4> queueSizes{};
+    auto tunnels = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tArray);
+    for (auto &tunnel : _tunnels) {
+      packetsSent += tunnel->packetsSent;
+      sendErrors += tunnel->sendErrors;
+      if (!tunnel->connected) continue;
+
+      auto tunnelStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+      tunnelStruct->structValue->emplace("channelId", std::make_shared<BaseLib::Variable>((int32_t)tunnel->channelId));
+      tunnelStruct->structValue->emplace("address", std::make_shared<BaseLib::Variable>(Cemi::getFormattedPhysicalAddress(tunnel->address)));
+      tunnelStruct->structValue->emplace("packetsSent", std::make_shared<BaseLib::Variable>((int64_t)tunnel->packetsSent));
+      tunnelStruct->structValue->emplace("sendErrors", std::make_shared<BaseLib::Variable>((int64_t)tunnel->sendErrors));
+      {
+        std::lock_guard<std::mutex> sendQueueGuard(tunnel->sendQueueMutex);
+        tunnelStruct->structValue->emplace("sendQueueSize", std::make_shared<BaseLib::Variable>(tunnel->sendQueueSize));
+        for (size_t i = 0; i < queueSizes.size(); i++) {
+          queueSizes[i] += (int32_t)tunnel->sendQueues[i].size();
+        }
+      }
+      tunnels->arrayValue->push_back(tunnelStruct);
+    }
+    statistics->structValue->emplace("packetsSent", std::make_shared<BaseLib::Variable>((int64_t)packetsSent));
+    statistics->structValue->emplace("sendErrors", std::make_shared<BaseLib::Variable>((int64_t)sendErrors));
+    statistics->structValue->emplace("tunnels", tunnels);
+
+    auto queueSizesStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    queueSizesStruct->structValue->emplace("system", std::make_shared<BaseLib::Variable>(queueSizes.at(getSendQueueIndex(Cemi::Priority::system))));
+    queueSizesStruct->structValue->emplace("urgent", std::make_shared<BaseLib::Variable>(queueSizes.at(getSendQueueIndex(Cemi::Priority::urgent))));
+    queueSizesStruct->structValue->emplace("normal", std::make_shared<BaseLib::Variable>(queueSizes.at(getSendQueueIndex(Cemi::Priority::normal))));
+    queueSizesStruct->structValue->emplace("low", std::make_shared<BaseLib::Variable>(queueSizes.at(getSendQueueIndex(Cemi::Priority::low))));
+    statistics->structValue->emplace("sendQueueSizeByPriority", queueSizesStruct);
+
+    auto requestsStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    {
+      std::lock_guard<std::mutex> requestStatisticsGuard(_requestStatisticsMutex);
+      for (auto &entry : _requestStatistics) {
+        auto requestStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+        requestStruct->structValue->emplace("count", std::make_shared<BaseLib::Variable>((int64_t)entry.second.count));
+        requestStruct->structValue->emplace("timeouts", std::make_shared<BaseLib::Variable>((int64_t)entry.second.timeouts));
+        requestStruct->structValue->emplace("averageLatency", std::make_shared<BaseLib::Variable>(entry.second.count > 0 ? (int64_t)(entry.second.latencySum / entry.second.count) : (int64_t)0));
+        requestStruct->structValue->emplace("maxLatency", std::make_shared<BaseLib::Variable>(entry.second.maxLatency));
+        requestsStruct->structValue->emplace(entry.first, requestStruct);
+      }
+    }
+    {
+      std::lock_guard<std::mutex> requestsGuard(_requestsMutex);
+      statistics->structValue->emplace("pendingRequests", std::make_shared<BaseLib::Variable>((int32_t)_requests.size()));
+    }
+    statistics->structValue->emplace("requests", requestsStruct); //Latencies in microseconds
+
+    auto healthStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    healthStruct->structValue->emplace("ackTimeout", std::make_shared<BaseLib::Variable>(getRttTimeout(_ackRtt)));
+    healthStruct->structValue->emplace("confirmationTimeout", std::make_shared<BaseLib::Variable>(getRttTimeout(_confirmationRtt)));
+    {
+      std::lock_guard<std::mutex> rttGuard(_ackRtt.mutex);
+      healthStruct->structValue->emplace("ackSrtt", std::make_shared<BaseLib::Variable>(_ackRtt.srtt));
+      healthStruct->structValue->emplace("ackRttvar", std::make_shared<BaseLib::Variable>(_ackRtt.rttvar));
+    }
+    {
+      std::lock_guard<std::mutex> rttGuard(_confirmationRtt.mutex);
+      healthStruct->structValue->emplace("confirmationSrtt", std::make_shared<BaseLib::Variable>(_confirmationRtt.srtt));
+      healthStruct->structValue->emplace("confirmationRttvar", std::make_shared<BaseLib::Variable>(_confirmationRtt.rttvar));
+    }
+    healthStruct->structValue->emplace("ackTimeouts", std::make_shared<BaseLib::Variable>((int64_t)_ackTimeouts));
+    healthStruct->structValue->emplace("retransmissions", std::make_shared<BaseLib::Variable>((int64_t)_retransmissions));
+    healthStruct->structValue->emplace("confirmationTimeouts", std::make_shared<BaseLib::Variable>((int64_t)_confirmationTimeouts));
+    healthStruct->structValue->emplace("connectionFailures", std::make_shared<BaseLib::Variable>((int64_t)_connectionFailures));
+    healthStruct->structValue->emplace("reconnects", std::make_shared<BaseLib::Variable>((int64_t)_reconnects));
+    healthStruct->structValue->emplace("framesDropped", std::make_shared<BaseLib::Variable>((int64_t)_framesDropped));
+    statistics->structValue->emplace("health", healthStruct); //Times in milliseconds, SRTT and RTTVAR in microseconds
+
+    auto recoveryStruct = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    {
+      std::lock_guard<std::mutex> recoveryGuard(_recoveryMutex);
+      recoveryStruct->structValue->emplace("outages", std::make_shared<BaseLib::Variable>((int64_t)_recoveryCount));
+      recoveryStruct->structValue->emplace("lastRecoveryTime", std::make_shared<BaseLib::Variable>(_lastRecoveryTime));
+      recoveryStruct->structValue->emplace("maxRecoveryTime", std::make_shared<BaseLib::Variable>(_maxRecoveryTime));
+      recoveryStruct->structValue->emplace("averageRecoveryTime", std::make_shared<BaseLib::Variable>(_recoveryCount > 0 ? _recoveryTimeSum / (int64_t)_recoveryCount : (int64_t)0));
+      recoveryStruct->structValue->emplace("currentOutageTime", std::make_shared<BaseLib::Variable>(_disconnectTime > 0 ? BaseLib::HelperFunctions::getTime() - _disconnectTime : (int64_t)0));
+      recoveryStruct->structValue->emplace("reconnectDelay", std::make_shared<BaseLib::Variable>(_reconnectDelay));
+    }
+    statistics->structValue->emplace("recovery", recoveryStruct); //Times in milliseconds
+
+    return statistics;
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
 }
 
 void MainInterface::startListening() {
@@ -152,19 +619,25 @@ void MainInterface::startListening() {
     setListenAddress();
     if (_listenIp.empty()) return;
     _out.printInfo("Info: Listen IP is: " + _listenIp);
-    _socket = std::unique_ptr<BaseLib::UdpSocket>(new BaseLib::UdpSocket(_bl, _settings->host, _settings->port, _settings->listenPort));
-    _socket->setAutoConnect(true);
-    _out.printDebug("Connecting to device with hostname " + _settings->host + " on port " + _settings->port + "...");
-    _socket->open();
-    _listenPortBytes[0] = (uint8_t)((_socket->getListenPort() >> 8) & 0xFF);
-    _listenPortBytes[1] = (uint8_t)(_socket->getListenPort() & 0xFF);
+    _listening = true;
     _hostname = _settings->host;
-    _ipAddress = _socket->getClientIp();
-    _stopped = false;
-    if (_settings->listenThreadPriority > -1) Gd::bl->threadManager.start(_listenThread, true, _settings->listenThreadPriority, _settings->listenThreadPolicy, &MainInterface::listen, this);
-    else Gd::bl->threadManager.start(_listenThread, true, &MainInterface::listen, this);
+    for (auto &tunnel : _tunnels) {
+      Gd::bl->threadManager.start(tunnel->sendThread, true, &MainInterface::sendQueueWorker, this, tunnel);
+    }
+    _heartbeatTimer = Gd::reactor->addTimer(60000, [this] { heartbeat(); });
     IPhysicalInterface::startListening();
 
+    try {
+      _out.printDebug("Connecting to device with hostname " + _settings->host + " on port " + _settings->port + "...");
+      openSocket();
+      _stopped = false;
+    }
+    catch (const C1Net::Exception &ex) {
+      _out.printError("Error: Could not connect to device with hostname " + _settings->host + " on port " + _settings->port + ": " + std::string(ex.what()));
+      connectionLost();
+      return;
+    }
+
     init();
   }
   catch (const std::exception &ex) {
@@ -172,99 +645,310 @@ void MainInterface::startListening() {
   }
 }
 
+void MainInterface::connectionLost() {
+  try {
+    _stopped = true;
+    _initComplete = false;
+    if (!_listening || _reconnectScheduled.exchange(true)) return;
+
+    int32_t reconnectDelay = 0;
+    {
+      std::lock_guard<std::mutex> recoveryGuard(_recoveryMutex);
+      if (_disconnectTime == 0) _disconnectTime = BaseLib::HelperFunctions::getTime();
+      //Exponential backoff with jitter, so not all clients of a restarted gateway reconnect at the same time
+      reconnectDelay = BaseLib::HelperFunctions::getRandomNumber(_reconnectDelay / 2, _reconnectDelay);
+      _reconnectDelay = std::min(_reconnectDelay * 2, _maxReconnectDelay);
+    }
+    _out.printWarning("Warning: Connection to device closed. Trying to reconnect in " + std::to_string(reconnectDelay) + " ms...");
+
+    _reconnectTimer = Gd::reactor->addTimer(reconnectDelay, [this] {
+      auto &tunnel = _tunnels.at(0);
+      {
+        std::lock_guard<std::mutex> sendQueueGuard(tunnel->sendQueueMutex);
+        _reconnectDue = true;
+      }
+      tunnel->sendQueueConditionVariable.notify_all();
+    });
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 void MainInterface::reconnect() {
   try {
-    _socket->close();
+    _reconnects++;
+    closeSocket();
     _initComplete = false;
     _out.printDebug("Debug: Connecting to device with hostname " + _settings->host + " on port " + _settings->port + "...");
-    _socket->open();
-    _listenPortBytes[0] = (uint8_t)((_socket->getListenPort() >> 8) & 0xFF);
-    _listenPortBytes[1] = (uint8_t)(_socket->getListenPort() & 0xFF);
+    openSocket();
     _hostname = _settings->host;
-    _ipAddress = _socket->getClientIp();
     _stopped = false;
     _out.printInfo("Info: Connected to device with hostname " + _settings->host + " on port " + _settings->port + ".");
-    Gd::bl->threadManager.join(_initThread);
-    _bl->threadManager.start(_initThread, true, &MainInterface::init, this);
+    init();
+  }
+  catch (const C1Net::Exception &ex) {
+    _out.printError("Error: Could not connect to device with hostname " + _settings->host + " on port " + _settings->port + ": " + std::string(ex.what()));
+    connectionLost();
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    connectionLost();
   }
 }
 
 void MainInterface::init() {
   try {
-    _sequenceCounter = 0;
     _initComplete = false;
+    _connectedTunnelCount = 0;
 
     { // DISCONNECT_REQUEST (just to make sure)
       if (_managementConnected) disconnectManagement();
 
-      std::vector<uint8_t> disconnectPacket{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, _channelId, 0x00, 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1]};
-      _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(disconnectPacket));
-      _socket->proofwrite((char *)disconnectPacket.data(), disconnectPacket.size());
-      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+      //Wait for the DISCONNECT_RESPONSE of tunnels we know to be open, so the gateway frees them before we reconnect.
+      for (auto &tunnel : _tunnels) {
+        if (tunnel->connected) {
+          tunnel->connected = false;
+          std::vector<uint8_t> disconnectPacket{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, tunnel->channelId, 0x00};
+          appendHpai(disconnectPacket);
+          std::vector<uint8_t> response;
+          getResponse(ServiceType::DISCONNECT_RESPONSE, disconnectPacket, response, getRttTimeout(_ackRtt));
+        } else if (tunnel->index == 0) sendDisconnectRequest(tunnel->channelId);
+      }
     }
 
+    uint32_t tunnelCount = _tunnelCountSetting;
+    if (tunnelCount != 1) {
+      uint32_t slotCount = getTunnelSlotCount();
+      if (tunnelCount == 0 || slotCount < tunnelCount) tunnelCount = slotCount;
+      if (tunnelCount == 0) tunnelCount = 1;
+      else if (tunnelCount > _tunnels.size()) tunnelCount = _tunnels.size();
+    }
+
+    if (!connectTunnel(_tunnels.at(0))) {
+      connectionLost();
+      return;
+    }
+    _gatewayAddress = _tunnels.at(0)->address.load();
+    if (_physicalAddress == 0) _physicalAddress = _gatewayAddress.load();
+    _myAddress = _gatewayAddress;
+    _out.printInfo("Info: Connected. Gateway's KNX address is: " + Cemi::getFormattedPhysicalAddress(_gatewayAddress));
+
+    uint32_t connectedTunnelCount = 1;
+    for (uint32_t i = 1; i < tunnelCount; i++) {
+      if (!connectTunnel(_tunnels.at(i))) break;
+      connectedTunnelCount++;
+    }
+    if (connectedTunnelCount > 1) _out.printInfo("Info: Opened " + std::to_string(connectedTunnelCount) + " tunnels.");
+    _connectedTunnelCount = connectedTunnelCount;
+
+    //The heartbeat timer sends the first CONNECTIONSTATE_REQUEST 60 seconds from now.
+    for (auto &tunnel : _tunnels) {
+      tunnel->connectionStatePending = false;
+    }
+    _connectionStateAttempts = 0;
+    _lastConnectionState = BaseLib::HelperFunctions::getTime();
+
+    _initComplete = true;
+    _out.printInfo("Info: Init completed.");
+    connectionRecovered();
+    raiseReconnected();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    connectionLost();
+  }
+}
+
+void MainInterface::heartbeat() {
+  try {
+    if (!_listening) return;
+    int64_t delay = 60000;
+    if (_initComplete && !_stopped) {
+      bool pending = false;
+      for (auto &tunnel : _tunnels) {
+        if (tunnel->connected && tunnel->connectionStatePending) pending = true;
+      }
+      if (!pending) _connectionStateAttempts = 0;
+
+      auto time = BaseLib::HelperFunctions::getTime();
+      if (pending && _connectionStateAttempts >= 3) {
+        _out.printError("Error: No CONNECTIONSTATE_RESPONSE received. Reconnecting...");
+        _connectionFailures++;
+        connectionLost();
+      } else if (pending || time - _lastConnectionState >= 60000) {
+        if (!pending) {
+          _lastConnectionState = time;
+          for (auto &tunnel : _tunnels) {
+            if (tunnel->connected) tunnel->connectionStatePending = true;
+          }
+        }
+        _connectionStateAttempts++;
+        for (auto &tunnel : _tunnels) {
+          if (!tunnel->connected || !tunnel->connectionStatePending) continue;
+          // {{{ CONNECTIONSTATE_REQUEST (0x0207)
+          std::vector<uint8_t> data{0x06, 0x10, 0x02, 0x07, 0x00, 0x10, tunnel->channelId, 0x00};
+          appendHpai(data);
+          try {
+            if (_bl->debugLevel >= 5) _out.printDebug("Debug: Sending packet " + BaseLib::HelperFunctions::getHexString(data));
+            //An unsent request is repeated like an unanswered one.
+            if (!tryWriteSocket(data)) _framesDropped++;
+          }
+          catch (const C1Net::Exception &ex) {
+            _out.printError("Error sending packet to gateway: " + std::string(ex.what()));
+          }
+          // }}}
+        }
+        delay = 10000; //CONNECTIONSTATE_REQUEST_TIMEOUT
+      } else delay = 60000 - (time - _lastConnectionState);
+    }
+    _heartbeatTimer = Gd::reactor->addTimer(delay, [this] { heartbeat(); });
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MainInterface::connectionRecovered() {
+  try {
+    std::lock_guard<std::mutex> recoveryGuard(_recoveryMutex);
+    _reconnectDelay = _minReconnectDelay;
+    if (_disconnectTime == 0) return;
+    auto recoveryTime = BaseLib::HelperFunctions::getTime() - _disconnectTime;
+    _disconnectTime = 0;
+    _recoveryCount++;
+    _lastRecoveryTime = recoveryTime;
+    _recoveryTimeSum += recoveryTime;
+    if (recoveryTime > _maxRecoveryTime) _maxRecoveryTime = recoveryTime;
+    _out.printInfo("Info: Connection was reestablished after " + std::to_string(recoveryTime) + " ms.");
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+uint32_t MainInterface::getTunnelSlotCount() {
+  try {
+    // {{{ DESCRIPTION_REQUEST (0x0203)
+    std::vector<uint8_t> data{0x06, 0x10, 0x02, 0x03, 0x00, 0x0E};
+    appendHpai(data);
+    std::vector<uint8_t> response;
+    getResponse(ServiceType::DESCRIPTION_RESPONSE, data, response);
+    if (response.size() < 8) {
+      _out.printWarning("Warning: No DESCRIPTION_RESPONSE received. Can't determine number of available tunnels.");
+      return 0;
+    }
+    // }}}
+
+    //The response consists of description information blocks (DIBs). Tunneling info (0x07) contains one entry of 4 bytes per tunnel slot (section 3.8.4 of the KNX Standard).
+    size_t offset = 6;
+    while (offset + 2 <= response.size()) {
+      size_t length = response.at(offset);
+      uint8_t type = response.at(offset + 1);
+      if (length < 2 || offset + length > response.size()) break;
+      if (type == 0x07) {
+        uint32_t slotCount = 0;
+        for (size_t i = offset + 4; i + 3 < offset + length; i += 4) {
+          uint16_t status = (((uint16_t)response.at(i + 2)) << 8) | response.at(i + 3);
+          if (status & 0x04) slotCount++; //Usable
+        }
+        _out.printInfo("Info: Gateway supports " + std::to_string(slotCount) + " tunnels.");
+        return slotCount;
+      }
+      offset += length;
+    }
+
+    _out.printInfo("Info: Gateway does not report the number of tunnels. Using one tunnel.");
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return 0;
+}
+
+bool MainInterface::connectTunnel(const PTunnel &tunnel) {
+  try {
+    tunnel->connected = false;
+    tunnel->sequenceCounter = 0;
+
     // {{{ CONNECT_REQUEST (0x0205)
-    std::vector<uint8_t> data
-        {0x06, 0x10, 0x02, 0x05, 0x00, 0x1A, 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1], 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2],
-         _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1], 0x04, 0x04, 0x02, 0x00};
+    std::vector<uint8_t> data{0x06, 0x10, 0x02, 0x05, 0x00, 0x1A};
+    appendHpai(data); //Control endpoint
+    appendHpai(data); //Data endpoint
+    data.insert(data.end(), {0x04, 0x04, 0x02, 0x00});
     std::vector<uint8_t> response;
     getResponse(ServiceType::CONNECT_RESPONSE, data, response);
     if (response.size() < 20) {
       if (response.size() > 7 && response.at(7) != (uint8_t)KnxIpErrorCodes::E_NO_ERROR) {
-        _out.printError("Error in CONNECT_RESPONSE (" + std::to_string(response.at(7)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(7)));
-        _stopped = true;
-        return;
+        if (tunnel->index == 0) _out.printError("Error in CONNECT_RESPONSE (" + std::to_string(response.at(7)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(7)));
+        else _out.printWarning("Warning: Could not open tunnel " + std::to_string(tunnel->index + 1) + " (" + std::to_string(response.at(7)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(7)));
+        return false;
       }
       if (response.empty()) _out.printError("Error: No CONNECT_RESPONSE packet received: " + BaseLib::HelperFunctions::getHexString(response));
       else _out.printError("Error: CONNECT_RESPONSE packet is too small: " + BaseLib::HelperFunctions::getHexString(response));
-      _stopped = true;
-      return;
+      return false;
     }
     if (response.at(17) != 4) {
       _out.printError("Error: Connection is not of the requested type. Does your gateway support the tunneling protocol?");
-      _stopped = true;
-      return;
+      return false;
     }
-    _gatewayAddress = (((int32_t)(uint8_t)
-        response.at(18)) << 8) | (uint8_t)response.at(19);
-    if (_physicalAddress == 0) _physicalAddress = _gatewayAddress.load();
-    _myAddress = _gatewayAddress;
-    _channelId = response.at(6);
-    _out.printInfo("Info: Connected. Gateway's KNX address is: " + Cemi::getFormattedPhysicalAddress(_gatewayAddress));
+    tunnel->address = (((int32_t)(uint8_t)response.at(18)) << 8) | (uint8_t)response.at(19);
+    tunnel->channelId = response.at(6);
+    tunnel->connected = true;
+    if (tunnel->index != 0) _out.printInfo("Info: Opened tunnel " + std::to_string(tunnel->index + 1) + " with KNX address " + Cemi::getFormattedPhysicalAddress(tunnel->address) + ".");
     // }}}
 
-    _lastConnectionState = BaseLib::HelperFunctions::getTime();
-    if (!getConnectionState()) return;
-
-    _initComplete = true;
-    _out.printInfo("Info: Init completed.");
-    if (_reconnected) _reconnected();
+    return true;
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    _stopped = true;
   }
+  return false;
+}
+
+MainInterface::PTunnel MainInterface::getTunnelByChannelId(uint8_t channelId) {
+  for (auto &tunnel : _tunnels) {
+    if (tunnel->connected && tunnel->channelId == channelId) return tunnel;
+  }
+  return PTunnel();
+}
+
+bool MainInterface::isOwnTunnelAddress(uint16_t address) {
+  for (auto &tunnel : _tunnels) {
+    if (tunnel->index != 0 && tunnel->connected && tunnel->address == address) return true;
+  }
+  return false;
 }
 
 void MainInterface::stopListening() {
   try {
+    _listening = false;
+    removeTimer(_heartbeatTimer);
+    removeTimer(_reconnectTimer);
+    _reconnectScheduled = false;
+    _reconnectDue = false;
+
     // {{{ DISCONNECT_REQUEST (0x0209)
     if (!_stopped && _initComplete) {
-      std::vector<uint8_t> data{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, _channelId, 0x00, 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1]};
-      _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(data));
-      _socket->proofwrite((char *)data.data(), data.size());
+      for (auto &tunnel : _tunnels) {
+        if (!tunnel->connected) continue;
+        sendDisconnectRequest(tunnel->channelId);
+        tunnel->connected = false;
+      }
       _initComplete = false;
     }
     // }}}
 
     _stopCallbackThread = true;
-    Gd::bl->threadManager.join(_initThread);
-    Gd::bl->threadManager.join(_listenThread);
+    for (auto &tunnel : _tunnels) {
+      tunnel->sendQueueConditionVariable.notify_all();
+      Gd::bl->threadManager.join(tunnel->sendThread);
+    }
     _stopCallbackThread = false;
-    _socket->close();
+    for (auto &tunnel : _tunnels) {
+      clearSendQueue(tunnel, SendResult::notConnected);
+    }
+    closeSocket();
     _stopped = true;
     IPhysicalInterface::stopListening();
   }
@@ -308,37 +992,212 @@ void MainInterface::setListenAddress() {
   }
 }
 
-bool MainInterface::getConnectionState() {
-  try {
-    if (!_initComplete) return true;
-    std::vector<uint8_t> data{0x06, 0x10, 0x02, 0x07, 0x00, 0x10, _channelId, 0x00, 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1]};
-    std::vector<uint8_t> response;
-    getResponse(ServiceType::CONNECTIONSTATE_RESPONSE, data, response);
-    if (response.size() < 8) {
-      if (response.empty()) _out.printError("Error: No CONNECTIONSTATE_RES packet received: " + BaseLib::HelperFunctions::getHexString(response));
-      else _out.printError("Error: CONNECTIONSTATE_RES packet is too small: " + BaseLib::HelperFunctions::getHexString(response));
-      _stopped = true;
-      return false;
+void MainInterface::appendHpai(std::vector<uint8_t> &data) {
+  data.push_back(0x08); //Structure length
+  data.push_back(_hostProtocolCode);
+  if (_hostProtocolCode == 0x02) {
+    //Over TCP the endpoint is the connection itself. IP address and port are set to zero ("route back").
+    data.insert(data.end(), 6, 0);
+    return;
+  }
+  data.insert(data.end(), _listenIpBytes.begin(), _listenIpBytes.end());
+  data.insert(data.end(), _listenPortBytes.begin(), _listenPortBytes.end());
+}
+
+//{{{ Transport
+std::shared_ptr<BaseLib::FileDescriptor> MainInterface::connectSocket(int32_t socketType) {
+  struct addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = socketType;
+  struct addrinfo *serverInfo = nullptr;
+  int32_t result = getaddrinfo(_settings->host.c_str(), _settings->port.c_str(), &hints, &serverInfo);
+  if (result != 0 || !serverInfo) throw C1Net::Exception("Could not resolve " + _settings->host + ": " + std::string(gai_strerror(result)));
+  std::shared_ptr<struct addrinfo> serverInfoGuard(serverInfo, freeaddrinfo);
+
+  std::array<char, INET_ADDRSTRLEN> ipAddress{};
+  inet_ntop(AF_INET, &((struct sockaddr_in *)serverInfo->ai_addr)->sin_addr, ipAddress.data(), ipAddress.size());
+  _ipAddress = std::string(ipAddress.data());
+
+  auto socketDescriptor = Gd::bl->fileDescriptorManager.add(socket(AF_INET, socketType | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+  if (!socketDescriptor || socketDescriptor->descriptor == -1) throw C1Net::Exception("Could not create socket: " + std::string(strerror(errno)));
+
+  if (socketType == SOCK_DGRAM) {
+    struct sockaddr_in localAddress{};
+    localAddress.sin_family = AF_INET;
+    localAddress.sin_addr.s_addr = INADDR_ANY;
+    auto listenPort = _settings->listenPort.empty() ? 0 : BaseLib::Math::getNumber(_settings->listenPort);
+    localAddress.sin_port = htons((uint16_t)(listenPort > 0 && listenPort < 65536 ? listenPort : 0));
+    if (::bind(socketDescriptor->descriptor.load(), (struct sockaddr *)&localAddress, sizeof(localAddress)) == -1) {
+      Gd::bl->fileDescriptorManager.shutdown(socketDescriptor);
+      throw C1Net::Exception("Could not bind to port " + _settings->listenPort + ": " + std::string(strerror(errno)));
     }
-    if (response.at(7) != (uint8_t)KnxIpErrorCodes::E_NO_ERROR) {
-      _out.printError("Error in CONNECTIONSTATE_RES (" + std::to_string(response.at(7)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(7)));
-      _stopped = true;
-      return false;
+  }
+
+  //UDP sockets are connected immediately. TCP sockets wait for the handshake.
+  if (::connect(socketDescriptor->descriptor.load(), serverInfo->ai_addr, serverInfo->ai_addrlen) == -1) {
+    if (errno != EINPROGRESS) {
+      Gd::bl->fileDescriptorManager.shutdown(socketDescriptor);
+      throw C1Net::Exception("Could not connect to " + _ipAddress + ": " + std::string(strerror(errno)));
     }
-    return true;
+    pollfd pollInfo{socketDescriptor->descriptor, POLLOUT, 0};
+    int32_t error = 0;
+    socklen_t errorSize = sizeof(error);
+    if (poll(&pollInfo, 1, 5000) != 1 || getsockopt(socketDescriptor->descriptor, SOL_SOCKET, SO_ERROR, &error, &errorSize) == -1 || error != 0) {
+      Gd::bl->fileDescriptorManager.shutdown(socketDescriptor);
+      throw C1Net::Exception("Could not connect to " + _ipAddress + ": " + std::string(error != 0 ? strerror(error) : "Timeout"));
+    }
+  }
+
+  return socketDescriptor;
+}
+
+void MainInterface::registerSocket(const std::shared_ptr<BaseLib::FileDescriptor> &socketDescriptor) {
+  std::atomic_store(&_socketDescriptor, socketDescriptor);
+  if (!Gd::reactor->addFileDescriptor(socketDescriptor->descriptor, [this] { socketReadable(); })) throw C1Net::Exception("Could not add socket to event loop.");
+}
+
+void MainInterface::openSocket() {
+  closeSocket();
+  auto socketDescriptor = connectSocket(SOCK_DGRAM);
+  struct sockaddr_in localAddress{};
+  socklen_t localAddressSize = sizeof(localAddress);
+  if (getsockname(socketDescriptor->descriptor, (struct sockaddr *)&localAddress, &localAddressSize) == -1) {
+    Gd::bl->fileDescriptorManager.shutdown(socketDescriptor);
+    throw C1Net::Exception("Could not get local port: " + std::string(strerror(errno)));
+  }
+  uint16_t listenPort = ntohs(localAddress.sin_port);
+  _listenPortBytes[0] = (uint8_t)(listenPort >> 8);
+  _listenPortBytes[1] = (uint8_t)(listenPort & 0xFF);
+  registerSocket(socketDescriptor);
+}
+
+void MainInterface::closeSocket() {
+  auto socketDescriptor = std::atomic_exchange(&_socketDescriptor, std::shared_ptr<BaseLib::FileDescriptor>());
+  if (!socketDescriptor) return;
+  Gd::reactor->removeFileDescriptor(socketDescriptor->descriptor);
+  Gd::bl->fileDescriptorManager.shutdown(socketDescriptor);
+}
+
+bool MainInterface::socketIsOpen() {
+  auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+  return socketDescriptor && socketDescriptor->descriptor != -1;
+}
+
+void MainInterface::writeSocket(const std::vector<uint8_t> &data) {
+  auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+  if (!socketDescriptor || socketDescriptor->descriptor == -1) throw C1Net::ClosedException("Socket is not open.");
+  //Frames written by different threads must not interleave in TCP streams.
+  std::lock_guard<std::mutex> writeGuard(_writeMutex);
+  writeFrame(socketDescriptor->descriptor, data, 0);
+}
+
+bool MainInterface::tryWriteSocket(const std::vector<uint8_t> &data) {
+  auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+  if (!socketDescriptor || socketDescriptor->descriptor == -1) throw C1Net::ClosedException("Socket is not open.");
+  std::unique_lock<std::mutex> writeGuard(_writeMutex, std::try_to_lock);
+  if (!writeGuard.owns_lock()) return false;
+  ssize_t bytesWritten = 0;
+  do {
+    bytesWritten = send(socketDescriptor->descriptor, data.data(), data.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+  } while (bytesWritten == -1 && errno == EINTR);
+  if (bytesWritten == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+    throw C1Net::ClosedException("Error writing to socket: " + std::string(strerror(errno)));
+  }
+  //Only TCP writes partially. The rest of the frame has to follow, otherwise the stream is corrupted.
+  if ((size_t)bytesWritten < data.size()) writeFrame(socketDescriptor->descriptor, data, bytesWritten);
+  return true;
+}
+
+void MainInterface::writeFrame(int32_t descriptor, const std::vector<uint8_t> &data, size_t offset) {
+  size_t totalBytesWritten = offset;
+  while (totalBytesWritten < data.size()) {
+    auto bytesWritten = send(descriptor, data.data() + totalBytesWritten, data.size() - totalBytesWritten, MSG_NOSIGNAL);
+    if (bytesWritten == -1) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        pollfd pollInfo{descriptor, POLLOUT, 0};
+        if (poll(&pollInfo, 1, 1000) != 1) throw C1Net::TimeoutException("Timeout writing to socket.");
+        continue;
+      }
+      throw C1Net::ClosedException("Error writing to socket: " + std::string(strerror(errno)));
+    }
+    totalBytesWritten += bytesWritten;
+  }
+}
+
+bool MainInterface::readSocket(std::vector<uint8_t> &data) {
+  auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+  if (!socketDescriptor || socketDescriptor->descriptor == -1) throw C1Net::ClosedException("Socket is not open.");
+  //Receive directly into "data". It keeps its capacity, so this doesn't allocate when the buffer is reused.
+  data.resize(2048);
+  ssize_t bytesReceived = 0;
+  do {
+    bytesReceived = recv(socketDescriptor->descriptor, data.data(), data.size(), 0);
+  } while (bytesReceived == -1 && errno == EINTR);
+  if (bytesReceived == -1) {
+    data.clear();
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return false;
+    throw C1Net::ClosedException("Error reading from socket: " + std::string(strerror(errno)));
+  }
+  data.resize(bytesReceived);
+  return true;
+}
+
+void MainInterface::socketReadable() {
+  try {
+    auto &data = _receiveBuffer;
+    //Limit the number of frames processed at once, so other sockets and timers of the reactor are not delayed too long.
+    for (int32_t i = 0; i < 100; i++) {
+      data.clear();
+      if (!readSocket(data)) break;
+      if (data.empty()) continue;
+
+      if (_bl->debugLevel >= 4) _out.printInfo("Info: Packet received. Raw data: " + BaseLib::HelperFunctions::getHexString(data));
+
+      processPacket(data);
+
+      _lastPacketReceived = BaseLib::HelperFunctions::getTime();
+    }
+    return;
+  }
+  catch (const C1Net::ClosedException &ex) {
+    _out.printWarning("Warning: " + std::string(ex.what()));
+  }
+  catch (const C1Net::Exception &ex) {
+    _out.printError("Error: " + std::string(ex.what()));
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
-  _stopped = true;
-  return false;
+  //Stop polling the broken socket. It is closed by reconnect().
+  auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+  if (socketDescriptor) Gd::reactor->removeFileDescriptor(socketDescriptor->descriptor);
+  connectionLost();
 }
+//}}}
 
-void MainInterface::sendAck(uint8_t sequenceCounter, uint8_t error) {
+void MainInterface::sendAck(uint8_t channelId, uint8_t sequenceCounter, uint8_t error) {
   try {
-    std::vector<uint8_t> ack{0x06, 0x10, 0x04, 0x21, 0x00, 0x0A, 0x04, _channelId, sequenceCounter, error};
+    std::vector<uint8_t> ack{0x06, 0x10, 0x04, 0x21, 0x00, 0x0A, 0x04, channelId, sequenceCounter, error};
     if (_bl->debugLevel >= 5) _out.printDebug("Debug: Sending packet " + BaseLib::HelperFunctions::getHexString(ack));
-    _socket->proofwrite((char *)ack.data(), ack.size());
+    //Called on the reactor thread. A dropped ACK is not a problem, the gateway repeats the TUNNELING_REQUEST.
+    if (!tryWriteSocket(ack)) {
+      _framesDropped++;
+      if (_bl->debugLevel >= 5) _out.printDebug("Debug: Socket is busy. Dropping TUNNELING_ACK.");
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MainInterface::sendDisconnectRequest(uint8_t channelId) {
+  try {
+    std::vector<uint8_t> disconnectPacket{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, channelId, 0x00};
+    appendHpai(disconnectPacket);
+    _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(disconnectPacket));
+    writeSocket(disconnectPacket);
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -349,7 +1208,7 @@ void MainInterface::sendDisconnectResponse(KnxIpErrorCodes status, uint8_t chann
   try {
     std::vector<uint8_t> disconnectResponse{0x06, 0x10, 0x02, 0x0A, 0x00, 0x08, channelId, (uint8_t)status};
     if (_bl->debugLevel >= 5) _out.printDebug("Debug: Sending packet " + BaseLib::HelperFunctions::getHexString(disconnectResponse));
-    _socket->proofwrite((char *)disconnectResponse.data(), disconnectResponse.size());
+    if (!tryWriteSocket(disconnectResponse)) _framesDropped++;
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -362,15 +1221,16 @@ void MainInterface::connectManagement() {
     _managementSequenceCounter = 0;
 
     // {{{ CONNECT_REQUEST (0x0205)
-    std::vector<uint8_t> data
-        {0x06, 0x10, 0x02, 0x05, 0x00, 0x18, 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1], 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2],
-         _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1], 0x02, 0x03};
+    std::vector<uint8_t> data{0x06, 0x10, 0x02, 0x05, 0x00, 0x18};
+    appendHpai(data); //Control endpoint
+    appendHpai(data); //Data endpoint
+    data.insert(data.end(), {0x02, 0x03});
     std::vector<uint8_t> response;
     getResponse(ServiceType::CONNECT_RESPONSE, data, response);
     if (response.size() < 18) {
       if (response.size() > 7 && response.at(7) != (uint8_t)KnxIpErrorCodes::E_NO_ERROR) {
         _out.printError("Error in CONNECT_RESPONSE (" + std::to_string(response.at(7)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)response.at(7)));
-        _stopped = true;
+        connectionLost();
         return;
       }
       if (response.empty()) _out.printError("Error: No CONNECT_RESPONSE packet received: " + BaseLib::HelperFunctions::getHexString(response));
@@ -395,7 +1255,8 @@ void MainInterface::disconnectManagement() {
   try {
     // {{{ DISCONNECT_REQUEST (0x0205)
     _managementConnected = false;
-    std::vector<uint8_t> disconnectPacket{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, _managementChannelId, 0x00, 0x08, 0x01, _listenIpBytes[0], _listenIpBytes[1], _listenIpBytes[2], _listenIpBytes[3], _listenPortBytes[0], _listenPortBytes[1]};
+    std::vector<uint8_t> disconnectPacket{0x06, 0x10, 0x02, 0x09, 0x00, 0x10, _managementChannelId, 0x00};
+    appendHpai(disconnectPacket);
     std::vector<uint8_t> response;
     getResponse(ServiceType::DISCONNECT_RESPONSE, disconnectPacket, response);
     _out.printInfo("Info: Management connection closed.");
@@ -406,101 +1267,67 @@ void MainInterface::disconnectManagement() {
   }
 }
 
-void MainInterface::listen() {
-  try {
-    std::string ipAddress;
-    uint32_t receivedBytes = 0;
-    std::array<uint8_t, 2048> buffer{};
-
-    while (!_stopCallbackThread) {
-      if (_stopped || !_socket->isOpen()) {
-        if (_stopCallbackThread) return;
-        if (_stopped) _out.printWarning("Warning: Connection to device closed. Trying to reconnect...");
-        _socket->close();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-        if (_stopCallbackThread) return;
-        reconnect();
-        continue;
-      }
-      std::vector<uint8_t> data;
-      try {
-        do {
-          receivedBytes = _socket->proofread((char *)buffer.data(), buffer.size(), ipAddress);
-          if (ipAddress != _socket->getClientIp() && ipAddress != "224.0.23.12") continue;
-          if (receivedBytes > 0) {
-            data.insert(data.end(), buffer.data(), buffer.data() + receivedBytes);
-            if (data.size() > 1000000) {
-              _out.printError("Could not read: Too much data.");
-              break;
-            }
-          }
-        } while (receivedBytes == buffer.size());
-      }
-      catch (const C1Net::TimeoutException &ex) {
-        if (data.empty()) {
-          if (BaseLib::HelperFunctions::getTime() - _lastConnectionState > 60000) {
-            _lastConnectionState = BaseLib::HelperFunctions::getTime();
-            _bl->threadManager.join(_keepAliveThread);
-            _bl->threadManager.start(_keepAliveThread, false, &MainInterface::getConnectionState, this);
-          }
-          continue; //When receivedBytes is exactly 2048 bytes long, proofread will be called again, time out and the packet is received with a delay of 5 seconds. It doesn't matter as packets this big should never be received.
-        }
-      }
-      catch (const C1Net::ClosedException &ex) {
-        _stopped = true;
-        _out.printWarning("Warning: " + std::string(ex.what()));
-        std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-        continue;
-      }
-      catch (const C1Net::Exception &ex) {
-        _stopped = true;
-        _out.printError("Error: " + std::string(ex.what()));
-        std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-        continue;
-      }
-      if (data.empty() || data.size() > 1000000) continue;
-
-      if (_bl->debugLevel >= 4) _out.printInfo("Info: Packet received. Raw data: " + BaseLib::HelperFunctions::getHexString(data));
-
-      processPacket(data);
-
-      _lastPacketReceived = BaseLib::HelperFunctions::getTime();
-    }
-  }
-  catch (const std::exception &ex) {
-    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-  }
-}
-
 void MainInterface::processPacket(const std::vector<uint8_t> &data) {
   try {
     try {
       auto packet = std::make_shared<KnxIpPacket>(data);
 
-      uint8_t messageCode = 0;
-      if (packet->getServiceType() == ServiceType::TUNNELING_REQUEST) {
+      if (packet->getServiceType() == ServiceType::CONNECTIONSTATE_RESPONSE && data.size() >= 8) {
+        //Response to a CONNECTIONSTATE_REQUEST sent by heartbeat()
+        auto tunnel = getTunnelByChannelId(data.at(6));
+        if (tunnel && tunnel->connectionStatePending.exchange(false) && data.at(7) != (uint8_t)KnxIpErrorCodes::E_NO_ERROR) {
+          _out.printError("Error in CONNECTIONSTATE_RES (" + std::to_string(data.at(7)) + "): " + KnxIpPacket::getErrorString((KnxIpErrorCodes)data.at(7)));
+          connectionLost();
+          return;
+        }
+      }
+
+      //{{{ Find matching request. The most specific key comes first.
+      std::vector<RequestKey> requestKeys;
+      requestKeys.reserve(2);
+      auto serviceType = packet->getServiceType();
+      if (serviceType == ServiceType::TUNNELING_REQUEST) {
+        //Only L_Data.con (0x2E, needed in transmitPacket) is a response
         auto packetData = packet->getTunnelingRequest();
-        if (packetData) messageCode = packetData->cemi->getMessageCode();
+        if (packetData && packetData->cemi->getMessageCode() == 0x2E) requestKeys.push_back(RequestKey{serviceType, packetData->channelId, packetData->cemi->getDestinationAddress()});
+      } else if (serviceType == ServiceType::TUNNELING_ACK || serviceType == ServiceType::CONFIG_ACK) {
+        if (data.size() >= 10) requestKeys.push_back(RequestKey{serviceType, data.at(7), data.at(8)});
+        requestKeys.push_back(RequestKey{serviceType});
+      } else if (serviceType == ServiceType::CONNECTIONSTATE_RESPONSE || serviceType == ServiceType::DISCONNECT_RESPONSE) {
+        if (data.size() >= 8) requestKeys.push_back(RequestKey{serviceType, data.at(6)});
+        requestKeys.push_back(RequestKey{serviceType});
+      } else requestKeys.push_back(RequestKey{serviceType});
+
+      std::shared_ptr<Request> request;
+      {
+        std::lock_guard<std::mutex> requestsGuard(_requestsMutex);
+        for (auto &requestKey : requestKeys) {
+          auto requestIterator = _requests.find(requestKey);
+          if (requestIterator != _requests.end()) {
+            request = requestIterator->second;
+            break;
+          }
+        }
       }
-      std::unique_lock<std::mutex> requestsGuard(_requestsMutex);
-      auto requestIterator = (messageCode == 0x2E) ? _requests.find(0x2E0000 | (uint32_t)packet->getServiceType()) : _requests.find((uint32_t)packet->getServiceType()); //Check for DATA_CONTROL (0x2E, needed in sendPacket)
-      if (requestIterator != _requests.end()) {
-        std::shared_ptr<Request> request = requestIterator->second;
-        requestsGuard.unlock();
-        request->response = data;
+      if (request) {
         {
           std::lock_guard<std::mutex> lock(request->mutex);
+          request->response = data;
+          request->responseTime = BaseLib::HelperFunctions::getTimeMicroseconds();
           request->mutexReady = true;
         }
         request->conditionVariable.notify_one();
         return;
-      } else requestsGuard.unlock();
+      }
+      //}}}
 
       if (packet->getServiceType() == ServiceType::TUNNELING_REQUEST) {
         auto packetData = packet->getTunnelingRequest();
         if (packetData) {
-          sendAck(packetData->sequenceCounter, 0);
-          if (packetData->cemi->getMessageCode() == 0x29) //DATA_IND (0x29)
+          if (_hostProtocolCode != 0x02) sendAck(packetData->channelId, packetData->sequenceCounter, 0);
+          //The gateway sends all packets from the bus to every tunnel. Only process them once. Packets sent by our other tunnels are ignored.
+          if (packetData->channelId != _tunnels.at(0)->channelId) return;
+          if (packetData->cemi->getMessageCode() == 0x29 && !isOwnTunnelAddress(packetData->cemi->getSourceAddress())) //DATA_IND (0x29)
           {
             raisePacketReceived(packetData->cemi);
           }
@@ -515,9 +1342,9 @@ void MainInterface::processPacket(const std::vector<uint8_t> &data) {
             auto status = KnxIpErrorCodes::E_NO_ERROR;
             sendDisconnectResponse(status, packetData->channelId);
           } else {
-            auto status = packetData->channelId == _channelId ? KnxIpErrorCodes::E_NO_ERROR : KnxIpErrorCodes::E_CONNECTION_ID;
+            auto status = getTunnelByChannelId(packetData->channelId) ? KnxIpErrorCodes::E_NO_ERROR : KnxIpErrorCodes::E_CONNECTION_ID;
             sendDisconnectResponse(status, packetData->channelId);
-            _stopped = true;
+            connectionLost();
           }
         }
       }
@@ -538,47 +1365,163 @@ void MainInterface::processPacket(const std::vector<uint8_t> &data) {
 
 void MainInterface::getResponse(ServiceType serviceType, const std::vector<uint8_t> &requestPacket, std::vector<uint8_t> &responsePacket, int32_t timeout) {
   try {
-    static uint32_t fail_counter = 0;
-
+    responsePacket.clear();
     if (_stopped) return;
+
+    if ((serviceType == ServiceType::TUNNELING_ACK || serviceType == ServiceType::CONFIG_ACK) && _hostProtocolCode == 0x02) {
+      //No TUNNELING_ACKs and DEVICE_CONFIGURATION_ACKs are sent over TCP. Return the ACK the caller expects once the packet
+      //is written.
+      try {
+        writeSocket(requestPacket);
+        if (requestPacket.size() > 8) {
+          auto serviceTypeValue = (uint16_t)serviceType;
+          responsePacket = std::vector<uint8_t>{0x06, 0x10, (uint8_t)(serviceTypeValue >> 8), (uint8_t)(serviceTypeValue & 0xFF), 0x00, 0x0A, 0x04, requestPacket.at(7), requestPacket.at(8), (uint8_t)KnxIpErrorCodes::E_NO_ERROR};
+        }
+      }
+      catch (const C1Net::Exception &ex) {
+        _out.printError("Error sending packet to gateway: " + std::string(ex.what()));
+      }
+      return;
+    }
+
+    sendAndWaitForResponse(getRequestKey(serviceType, requestPacket), requestPacket, responsePacket, timeout);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+MainInterface::RequestKey MainInterface::getRequestKey(ServiceType responseType, const std::vector<uint8_t> &requestPacket) {
+  //See processPacket() for the keys of received responses
+  if (responseType == ServiceType::TUNNELING_ACK || responseType == ServiceType::CONFIG_ACK) {
+    //Connection header: structure length, channel ID, sequence counter
+    if (requestPacket.size() >= 9) return RequestKey{responseType, requestPacket.at(7), requestPacket.at(8)};
+  } else if (responseType == ServiceType::CONNECTIONSTATE_RESPONSE || responseType == ServiceType::DISCONNECT_RESPONSE) {
+    if (requestPacket.size() >= 7) return RequestKey{responseType, requestPacket.at(6)};
+  }
+  //CONNECT_RESPONSE and DESCRIPTION_RESPONSE can't be correlated to their request. Only one of them can be pending at a time.
+  return RequestKey{responseType};
+}
+
+bool MainInterface::addRequest(const RequestKey &requestKey, const std::shared_ptr<Request> &request, int32_t timeout) {
+  try {
+    std::unique_lock<std::mutex> requestsGuard(_requestsMutex);
+    if (!_requestsConditionVariable.wait_for(requestsGuard, std::chrono::milliseconds(timeout), [&] { return _requests.find(requestKey) == _requests.end() || _stopCallbackThread; })) {
+      _out.printError("Error: Timeout waiting for pending request with the same key (" + KnxIpPacket::getServiceIdentifierString(requestKey.serviceType) + ") to finish.");
+      return false;
+    }
+    if (_stopCallbackThread) return false;
+    request->time = BaseLib::HelperFunctions::getTimeMicroseconds();
+    _requests.emplace(requestKey, request);
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void MainInterface::removeRequest(const RequestKey &requestKey) {
+  try {
+    {
+      std::lock_guard<std::mutex> requestsGuard(_requestsMutex);
+      _requests.erase(requestKey);
+    }
+    _requestsConditionVariable.notify_all();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MainInterface::addRequestStatistics(const std::string &name, int64_t latency, bool timeout) {
+  try {
+    std::lock_guard<std::mutex> requestStatisticsGuard(_requestStatisticsMutex);
+    auto &statistics = _requestStatistics[name];
+    if (timeout) {
+      statistics.timeouts++;
+      return;
+    }
+    statistics.count++;
+    statistics.latencySum += latency;
+    if (latency > statistics.maxLatency) statistics.maxLatency = latency;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+int64_t MainInterface::sendAndWaitForResponse(const RequestKey &requestKey, const std::vector<uint8_t> &requestPacket, std::vector<uint8_t> &responsePacket, int32_t timeout) {
+  try {
     responsePacket.clear();
+    if (_stopped) return -1;
 
-    std::unique_lock<std::mutex> getResponseGuard(_getResponseMutex, std::defer_lock);
-    std::unique_lock<std::mutex> requestsGuard(_requestsMutex, std::defer_lock);
-    std::lock(getResponseGuard, requestsGuard);
     auto request = std::make_shared<Request>();
-    _requests[(uint32_t)serviceType] = request;
-    requestsGuard.unlock();
+    request->name = KnxIpPacket::getServiceIdentifierString(requestKey.serviceType);
+    if (!addRequest(requestKey, request, timeout)) return -1;
     std::unique_lock<std::mutex> lock(request->mutex);
 
     try {
       _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(requestPacket));
-      _socket->proofwrite((char *)requestPacket.data(), requestPacket.size());
+      writeSocket(requestPacket);
     }
     catch (const C1Net::Exception &ex) {
       _out.printError("Error sending packet to gateway: " + std::string(ex.what()));
-      return;
+      lock.unlock();
+      removeRequest(requestKey);
+      return -1;
     }
 
+    int64_t responseTime = -1;
     if (!request->conditionVariable.wait_for(lock, std::chrono::milliseconds(timeout), [&] { return request->mutexReady || _stopCallbackThread; })) {
       _out.printError("Error: No response received to packet: " + BaseLib::HelperFunctions::getHexString(requestPacket));
-      fail_counter++;
-      if (fail_counter == 100) {
-        fail_counter = 0;
-        _stopped = true; //Force reconnect
+      addRequestStatistics(request->name, 0, true);
+      if (++_consecutiveTimeouts >= 100) {
+        _consecutiveTimeouts = 0;
+        connectionLost(); //Force reconnect
       }
-    } else {
-      fail_counter = 0;
+    } else if (request->mutexReady) {
+      responseTime = BaseLib::HelperFunctions::getTimeMicroseconds() - request->time;
+      addRequestStatistics(request->name, responseTime, false);
+      _consecutiveTimeouts = 0;
     }
     responsePacket = request->response;
+    lock.unlock();
 
-    requestsGuard.lock();
-    _requests.erase((uint32_t)serviceType);
-    requestsGuard.unlock();
+    removeRequest(requestKey);
+    return responseTime;
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
+  return -1;
+}
+
+void MainInterface::addRttSample(RttEstimator &estimator, int64_t responseTime) {
+  try {
+    //Same algorithm as TCP uses (RFC 6298)
+    std::lock_guard<std::mutex> rttGuard(estimator.mutex);
+    if (!estimator.initialized) {
+      estimator.srtt = responseTime;
+      estimator.rttvar = responseTime / 2;
+      estimator.initialized = true;
+      return;
+    }
+    estimator.rttvar = (3 * estimator.rttvar + std::abs(estimator.srtt - responseTime)) / 4;
+    estimator.srtt = (7 * estimator.srtt + responseTime) / 8;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+int32_t MainInterface::getRttTimeout(RttEstimator &estimator) {
+  std::lock_guard<std::mutex> rttGuard(estimator.mutex);
+  if (!estimator.initialized) return estimator.initialTimeout;
+  int64_t timeout = (estimator.srtt + 4 * estimator.rttvar) / 1000;
+  if (timeout < estimator.minTimeout) return estimator.minTimeout;
+  if (timeout > estimator.maxTimeout) return estimator.maxTimeout;
+  return (int32_t)timeout;
 }
 
 void MainInterface::sendRaw(const std::vector<uint8_t> &packet) {
@@ -586,7 +1529,7 @@ void MainInterface::sendRaw(const std::vector<uint8_t> &packet) {
     if (_stopped) return;
     try {
       _out.printInfo("Info: Sending raw packet " + BaseLib::HelperFunctions::getHexString(packet));
-      _socket->proofwrite((char *)packet.data(), packet.size());
+      writeSocket(packet);
     }
     catch (const C1Net::Exception &ex) {
       _out.printError("Error sending packet to gateway: " + std::string(ex.what()));
@@ -599,7 +1542,7 @@ void MainInterface::sendRaw(const std::vector<uint8_t> &packet) {
 }
 
 std::unique_lock<std::mutex> MainInterface::getSendPacketLock() {
-  return std::unique_lock<std::mutex>(_sendPacketMutex, std::defer_lock);
+  return std::unique_lock<std::mutex>(_tunnels.at(0)->sendPacketMutex, std::defer_lock);
 }
 
 }
@@ -7,11 +7,37 @@
 
 #include <homegear-base/BaseLib.h>
 #include "../KnxIpPacket.h"
+#include "../Cemi.h"
 
 namespace Knx {
 
 class MainInterface : public BaseLib::Systems::IPhysicalInterface {
  public:
+  enum class SendResult : int32_t {
+    success = 0,
+    queued = 1,
+    queueFull = -1,
+    notConnected = -2,
+    tooLarge = -3,
+    noAck = -4,
+    ackError = -5,
+    noConfirmation = -6,
+    confirmationError = -7,
+    sendError = -8,
+    expired = -9
+  };
+
+  /**
+   * Defines how long the sender waits before the next queued packet is sent.
+   */
+  enum class ConfirmationPolicy : int32_t {
+    none = 0, //Don't wait at all
+    ack = 1, //Wait for TUNNELING_ACK
+    confirmation = 2 //Wait for TUNNELING_ACK and L_Data.con
+  };
+
+  typedef std::function<void(SendResult result)> SendCallback;
+
   explicit MainInterface(const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings);
   ~MainInterface() override;
 
@@ -23,19 +49,57 @@ class MainInterface : public BaseLib::Systems::IPhysicalInterface {
   void incrementManagementSequenceCounter();
   uint16_t getGatewayAddress();
   uint16_t getPhysicalAddress();
+
+  /**
+   * Returns true when packets sent by this interface use this source address.
+   */
+  bool isOwnAddress(uint16_t address) { return address == _physicalAddress || isOwnTunnelAddress(address); }
   bool managementConnected();
   std::array<uint8_t, 4> getListenIpBytes();
   std::array<uint8_t, 2> getListenPortBytes();
 
-  void setReconnected(std::function<void()> value) { _reconnected.swap(value); }
+  /**
+   * Returns the host protocol code used in HPAIs: 0x01 for UDP, 0x02 for TCP.
+   */
+  uint8_t getHostProtocolCode() { return _hostProtocolCode; }
+
+  /**
+   * Adds a callback that is called after the connection to the gateway is (re)established. The central and the forwarder
+   * both need to be notified.
+   */
+  void addReconnectedCallback(std::function<void()> callback);
+
+  /**
+   * Adds a callback that is called on the send thread for every packet the send queue transmitted successfully.
+   */
+  void addPacketSentCallback(std::function<void(const PCemi &packet)> callback);
 
   void startListening() override;
   void stopListening() override;
 
-  bool isOpen() override { return _socket->isOpen() && _initComplete; }
+  bool isOpen() override { return socketIsOpen() && _initComplete; }
+
+  /**
+   * Returns the number of tunnels currently open to the gateway.
+   */
+  uint32_t getTunnelCount() { return _connectedTunnelCount; }
 
   void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet) override;
 
+  /**
+   * Adds a packet to the send queue. The packets are sent by a dedicated thread per tunnel ordered by their KNX priority.
+   * When more than one tunnel is open, packets are distributed by group address, so the order of packets to the same
+   * group address is kept.
+   *
+   * @param packet The packet to send.
+   * @param callback Optional callback that is called from the send thread once the packet is sent or sending failed. It must not block.
+   * @return Returns "queued" on success. Returns an error when the packet was rejected. The callback is not called in that case.
+   */
+  SendResult queuePacket(const PCemi &packet, const SendCallback &callback = SendCallback());
+  static std::string getSendResultString(SendResult result);
+
+  virtual BaseLib::PVariable getStatistics();
+
   std::unique_lock<std::mutex> getSendPacketLock();
 
   void getResponse(ServiceType serviceType, const std::vector<uint8_t> &requestPacket, std::vector<uint8_t> &responsePacket, int32_t timeout = 1000);
@@ -52,10 +116,81 @@ class MainInterface : public BaseLib::Systems::IPhysicalInterface {
     std::condition_variable conditionVariable;
     bool mutexReady = false;
     std::vector<uint8_t> response;
+    std::string name; //Used for the statistics
+    int64_t time = 0; //Time the request was added in microseconds
+    int64_t responseTime = 0; //Time the response arrived in microseconds. Protected by mutex.
+  };
+
+  /**
+   * Identifies the response to a request. "channelId" and "id" are -1 when a response type can't be correlated by them.
+   * "id" is the sequence counter for ACKs and the group address for L_Data.con.
+   */
+  struct RequestKey {
+    ServiceType serviceType = ServiceType::UNSET;
+    int32_t channelId = -1;
+    int32_t id = -1;
+
+    bool operator<(const RequestKey &other) const {
+      return std::tie(serviceType, channelId, id) < std::tie(other.serviceType, other.channelId, other.id);
+    }
+  };
+
+  /**
+   * Estimates the response time of the gateway to derive timeouts from it. "srtt" and "rttvar" are in microseconds, the
+   * timeouts in milliseconds.
+   */
+  struct RttEstimator {
+    std::mutex mutex;
+    bool initialized = false;
+    int64_t srtt = 0;
+    int64_t rttvar = 0;
+    int32_t minTimeout = 0;
+    int32_t maxTimeout = 0;
+    int32_t initialTimeout = 0;
+  };
+
+  struct RequestStatistics {
+    uint64_t count = 0;
+    uint64_t timeouts = 0;
+    int64_t latencySum = 0;
+    int64_t maxLatency = 0;
+  };
+
+  struct QueueEntry {
+    PCemi packet;
+    SendCallback callback;
+    int64_t time = 0; //Time the packet was queued in milliseconds
+  };
+
+  /**
+   * One tunneling connection to the gateway. Tunnel 0 is the primary tunnel. It is used for incoming packets, the
+   * forwarder and connection management. The other tunnels are only used to send packets.
+   */
+  struct Tunnel {
+    uint32_t index = 0;
+    std::atomic_uchar channelId{0};
+    std::atomic_uchar sequenceCounter{0};
+    std::atomic_int address{0}; //Individual address assigned by the gateway
+    std::atomic_bool connected{false};
+    std::atomic_bool connectionStatePending{false}; //True while a CONNECTIONSTATE_REQUEST is unanswered
+
+    std::mutex sendPacketMutex;
+    std::vector<uint8_t> sendBuffer; //Reused by the send thread to build packets without allocating
+    std::mutex sendQueueMutex;
+    std::condition_variable sendQueueConditionVariable;
+    std::array<std::deque<QueueEntry>, 4> sendQueues; //Ordered by send order: system, urgent, normal, low
+    uint32_t sendQueueSize = 0;
+    std::thread sendThread;
+    std::atomic<uint64_t> packetsSent{0};
+    std::atomic<uint64_t> sendErrors{0};
   };
+  typedef std::shared_ptr<Tunnel> PTunnel;
 
   BaseLib::Output _out;
-  std::function<void()> _reconnected;
+  std::mutex _reconnectedCallbacksMutex;
+  std::vector<std::function<void()>> _reconnectedCallbacks;
+  std::mutex _packetSentCallbacksMutex;
+  std::vector<std::function<void(const PCemi &packet)>> _packetSentCallbacks;
   std::atomic_bool _initComplete{false};
   std::string _port;
   std::string _listenIp;
@@ -64,32 +199,198 @@ class MainInterface : public BaseLib::Systems::IPhysicalInterface {
   std::atomic_uchar _managementChannelId;
   std::atomic_int _gatewayAddress{0};
   std::atomic_int _physicalAddress{0};
-  std::atomic_uchar _channelId{0};
-  std::unique_ptr<BaseLib::UdpSocket> _socket;
+  std::shared_ptr<BaseLib::FileDescriptor> _socketDescriptor; //Only access with std::atomic_load() and std::atomic_store()
+  std::mutex _writeMutex;
+  std::vector<uint8_t> _receiveBuffer; //Only used by the reactor thread
+  uint8_t _hostProtocolCode = 0x01; //IPV4_UDP
 
-  std::mutex _sendPacketMutex;
-  std::mutex _getResponseMutex;
+  //{{{ Tunnels
+  uint32_t _tunnelCountSetting = 1; //0 means auto detection
+  std::vector<PTunnel> _tunnels; //Fixed size, created in the constructor
+  std::atomic<uint32_t> _connectedTunnelCount{0};
+  //}}}
 
+  //{{{ Requests
   std::mutex _requestsMutex;
-  std::map<uint32_t, std::shared_ptr<Request>> _requests;
+  std::condition_variable _requestsConditionVariable;
+  std::map<RequestKey, std::shared_ptr<Request>> _requests;
+  std::mutex _requestStatisticsMutex;
+  std::map<std::string, RequestStatistics> _requestStatistics;
+  //}}}
+
+  //{{{ Health
+  RttEstimator _ackRtt;
+  RttEstimator _confirmationRtt;
+  std::atomic<uint32_t> _consecutiveTimeouts{0};
+  std::atomic<uint64_t> _ackTimeouts{0};
+  std::atomic<uint64_t> _retransmissions{0};
+  std::atomic<uint64_t> _confirmationTimeouts{0};
+  std::atomic<uint64_t> _connectionFailures{0};
+  std::atomic<uint64_t> _reconnects{0};
+  std::atomic<uint64_t> _framesDropped{0}; //ACKs and other frames written by the reactor that couldn't be sent without blocking
+  //}}}
+
+  //{{{ Reconnect
+  std::atomic_bool _listening{false}; //True between startListening() and stopListening()
+  std::atomic_bool _reconnectScheduled{false};
+  std::atomic_bool _reconnectDue{false}; //Set by the reconnect timer. The reconnect itself is executed by the send thread of tunnel 0.
+  std::atomic<uint64_t> _reconnectTimer{0};
+  std::mutex _recoveryMutex;
+  const int32_t _minReconnectDelay = 50;
+  const int32_t _maxReconnectDelay = 10000;
+  int32_t _reconnectDelay = 50; //In milliseconds
+  int64_t _disconnectTime = 0;
+  uint64_t _recoveryCount = 0;
+  int64_t _lastRecoveryTime = 0;
+  int64_t _maxRecoveryTime = 0;
+  int64_t _recoveryTimeSum = 0;
+  //}}}
+
+  //{{{ Send queue
+  ConfirmationPolicy _confirmationPolicy = ConfirmationPolicy::confirmation;
+  uint32_t _maxSendQueueSize = 1000;
+  int64_t _sendQueueTimeout = 30000; //In milliseconds. Packets not sent within this time are dropped. 0 disables the timeout.
+  std::atomic<uint64_t> _packetsExpired{0};
+  std::atomic<uint32_t> _sendQueueSize{0}; //Sum over all tunnels
+  std::atomic<uint64_t> _packetsRejected{0};
+  //}}}
 
-  std::atomic_uchar _sequenceCounter{0};
   std::atomic_uchar _managementSequenceCounter{0};
   std::atomic_bool _managementConnected{false};
-  int64_t _lastConnectionState = 0;
-  std::thread _keepAliveThread;
-  std::thread _initThread;
+
+  //{{{ Heartbeat
+  std::atomic<uint64_t> _heartbeatTimer{0};
+  std::atomic<int64_t> _lastConnectionState{0};
+  std::atomic<uint32_t> _connectionStateAttempts{0};
+  //}}}
 
   std::function<void(const PKnxIpPacket &)> _packetReceivedCallback;
 
   void setListenAddress();
+  void appendHpai(std::vector<uint8_t> &data);
+
+  //{{{ Transport, overridden by interfaces not using UDP. All sockets are non-blocking and driven by Gd::reactor.
+  /**
+   * Opens the socket and registers it with the reactor. Throws C1Net::Exception on errors.
+   */
+  virtual void openSocket();
+  void closeSocket();
+  bool socketIsOpen();
+
+  /**
+   * Resolves the gateway's hostname and returns a non-blocking socket connected to it. UDP sockets are bound to
+   * "listenPort" first. Throws C1Net::Exception on errors.
+   */
+  std::shared_ptr<BaseLib::FileDescriptor> connectSocket(int32_t socketType);
+
+  /**
+   * Stores the socket and calls socketReadable() every time data is available.
+   */
+  void registerSocket(const std::shared_ptr<BaseLib::FileDescriptor> &socketDescriptor);
+
+  /**
+   * Writes a complete KNXnet/IP frame. Throws C1Net::Exception on errors.
+   */
+  void writeSocket(const std::vector<uint8_t> &data);
+
+  /**
+   * Writes a complete KNXnet/IP frame without waiting for the socket or the write lock. Used on the reactor thread,
+   * where waiting would delay all interfaces. Throws C1Net::Exception on errors.
+   *
+   * @return Returns false when nothing was written, because the socket buffer is full or another thread is writing.
+   */
+  bool tryWriteSocket(const std::vector<uint8_t> &data);
+
+  /**
+   * Writes "data" starting at "offset" and waits for the socket when its buffer is full. "_writeMutex" needs to be
+   * locked.
+   */
+  void writeFrame(int32_t descriptor, const std::vector<uint8_t> &data, size_t offset);
+
+  /**
+   * Reads one KNXnet/IP frame without blocking. Throws C1Net::Exception on errors.
+   *
+   * @return Returns false when no complete frame is available.
+   */
+  virtual bool readSocket(std::vector<uint8_t> &data);
+
+  /**
+   * Called by the reactor when the socket is readable.
+   */
+  virtual void socketReadable();
+  //}}}
+
+  /**
+   * Removes the reactor timers and socket and stops the send threads. Needs to be called in the destructor of every
+   * class overriding a method called by them.
+   */
+  void removeCallbacks();
+
+  /**
+   * Removes the timer stored in "timer". A running timer callback may store a new timer, so repeat until none is left.
+   */
+  static void removeTimer(std::atomic<uint64_t> &timer);
+
+  /**
+   * Marks the connection as broken and schedules a reconnect with exponential backoff. Never blocks.
+   */
+  void connectionLost();
   void reconnect();
   void init();
-  void listen();
+
+  /**
+   * Executed by the reactor. Sends CONNECTIONSTATE_REQUESTs every 60 seconds and repeats them after 10 seconds when no
+   * response was received (section 3.8.2 of the KNX Standard). After three unanswered requests the connection is lost.
+   */
+  void heartbeat();
   void processPacket(const std::vector<uint8_t> &data);
-  void sendAck(uint8_t sequenceCounter, uint8_t error);
+  void sendQueueWorker(PTunnel tunnel);
+  void clearSendQueue(const PTunnel &tunnel, SendResult result);
+
+  /**
+   * Removes packets older than "_sendQueueTimeout" from the send queue.
+   */
+  void expireSendQueue(const PTunnel &tunnel);
+
+  /**
+   * Resets the reconnect delay and updates the recovery statistics. Called when init() succeeded.
+   */
+  void connectionRecovered();
+  virtual SendResult transmitPacket(const PTunnel &tunnel, const PCemi &cemi);
+  void sendAck(uint8_t channelId, uint8_t sequenceCounter, uint8_t error);
+  void sendDisconnectRequest(uint8_t channelId);
   void sendDisconnectResponse(KnxIpErrorCodes status, uint8_t channelId);
-  bool getConnectionState();
+  uint32_t getTunnelSlotCount();
+  bool connectTunnel(const PTunnel &tunnel);
+  PTunnel getTunnelByChannelId(uint8_t channelId);
+  bool isOwnTunnelAddress(uint16_t address);
+  void raiseReconnected();
+  void raisePacketSent(const PCemi &packet);
+
+  static RequestKey getRequestKey(ServiceType responseType, const std::vector<uint8_t> &requestPacket);
+
+  /**
+   * Adds a request to "_requests". When a request with the same key is pending, waits for it to finish.
+   *
+   * @return Returns false when the key didn't become available within "timeout" milliseconds.
+   */
+  bool addRequest(const RequestKey &requestKey, const std::shared_ptr<Request> &request, int32_t timeout);
+  void removeRequest(const RequestKey &requestKey);
+  void addRequestStatistics(const std::string &name, int64_t latency, bool timeout);
+  void addRttSample(RttEstimator &estimator, int64_t responseTime);
+
+  /**
+   * Returns SRTT + 4 * RTTVAR limited to the estimator's bounds in milliseconds.
+   */
+  int32_t getRttTimeout(RttEstimator &estimator);
+
+  /**
+   * Sends a packet and waits for the response identified by "requestKey". Requests with different keys can be pending at the
+   * same time.
+   *
+   * @return Returns the response time in microseconds or -1 when no response was received.
+   */
+  int64_t sendAndWaitForResponse(const RequestKey &requestKey, const std::vector<uint8_t> &requestPacket, std::vector<uint8_t> &responsePacket, int32_t timeout);
 };
 
 }
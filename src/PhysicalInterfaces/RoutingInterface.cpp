@@ -0,0 +1,340 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "RoutingInterface.h"
+#include "../Gd.h"
+
+#include <arpa/inet.h>
+
+namespace Knx {
+
+RoutingInterface::RoutingInterface(const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings) : MainInterface(settings) {
+  _out.setPrefix(Gd::out.getPrefix() + "KNXNet/IP routing \"" + settings->id + "\": ");
+
+  if (!settings->host.empty()) _multicastIp = settings->host;
+  if (!settings->port.empty()) {
+    auto port = BaseLib::Math::getNumber(settings->port);
+    if (port > 0 && port < 65536) _multicastPort = (uint16_t)port;
+    else _out.printWarning("Warning: Invalid port: " + settings->port);
+  }
+
+  auto settingsIterator = settings->all.find("routingratelimit");
+  if (settingsIterator != settings->all.end()) {
+    if (settingsIterator->second->integerValue64 <= 0) _minSendInterval = 0;
+    else if (settingsIterator->second->integerValue64 > 1000) _minSendInterval = 1;
+    else _minSendInterval = 1000 / (uint32_t)settingsIterator->second->integerValue64;
+  }
+
+  if (_physicalAddress == 0) _out.printWarning("Warning: Setting \"physicalAddress\" is not set. Please set it to a free individual address of your KNX installation.");
+}
+
+RoutingInterface::~RoutingInterface() {
+  //The reactor calls our virtual methods, so the callbacks need to be removed before this object is destroyed.
+  removeCallbacks();
+  removeTimer(_rebindTimer);
+}
+
+void RoutingInterface::startListening() {
+  try {
+    stopListening();
+    setListenAddress();
+    if (_listenIp.empty()) return;
+    _out.printInfo("Info: Listen IP is: " + _listenIp);
+    _listening = true;
+    _listenPortBytes[0] = (uint8_t)(_multicastPort >> 8);
+    _listenPortBytes[1] = (uint8_t)(_multicastPort & 0xFF);
+    _hostname = _multicastIp;
+    _ipAddress = _multicastIp;
+    _stopped = false;
+
+    //There is no connection setup for routing. The first tunnel is only used for the send queue.
+    auto &tunnel = _tunnels.at(0);
+    tunnel->address = _physicalAddress.load();
+    tunnel->connected = true;
+    _connectedTunnelCount = 1;
+    _initComplete = true;
+
+    bindSocket();
+    Gd::bl->threadManager.start(tunnel->sendThread, true, &RoutingInterface::sendQueueWorker, this, tunnel);
+    IPhysicalInterface::startListening();
+
+    raiseReconnected();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void RoutingInterface::stopListening() {
+  try {
+    _listening = false;
+    removeTimer(_rebindTimer);
+    _initComplete = false;
+    _stopCallbackThread = true;
+    for (auto &tunnel : _tunnels) {
+      tunnel->sendQueueConditionVariable.notify_all();
+      Gd::bl->threadManager.join(tunnel->sendThread);
+    }
+    _stopCallbackThread = false;
+    for (auto &tunnel : _tunnels) {
+      tunnel->connected = false;
+      clearSendQueue(tunnel, SendResult::notConnected);
+    }
+    _connectedTunnelCount = 0;
+    closeSocket();
+    _stopped = true;
+    IPhysicalInterface::stopListening();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+std::shared_ptr<BaseLib::FileDescriptor> RoutingInterface::getSocketDescriptor() {
+  std::shared_ptr<BaseLib::FileDescriptor> socketDescriptor;
+  try {
+    if (_listenIp.empty()) return socketDescriptor;
+    socketDescriptor = Gd::bl->fileDescriptorManager.add(socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+    if (socketDescriptor->descriptor == -1) {
+      _out.printError("Error: Could not create socket.");
+      return socketDescriptor;
+    }
+
+    int32_t reuse = 1;
+    if (setsockopt(socketDescriptor->descriptor, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse, sizeof(reuse)) == -1) {
+      _out.printWarning("Warning: Could not set socket options: " + std::string(strerror(errno)));
+    }
+
+    //We don't want to receive our own packets
+    char loopch = 0;
+    if (setsockopt(socketDescriptor->descriptor, IPPROTO_IP, IP_MULTICAST_LOOP, (char *)&loopch, sizeof(loopch)) == -1) {
+      _out.printWarning("Warning: Could not set socket options: " + std::string(strerror(errno)));
+    }
+
+    struct in_addr localInterface{};
+    localInterface.s_addr = inet_addr(_listenIp.c_str());
+    if (setsockopt(socketDescriptor->descriptor, IPPROTO_IP, IP_MULTICAST_IF, (char *)&localInterface, sizeof(localInterface)) == -1) {
+      _out.printWarning("Warning: Could not set socket options: " + std::string(strerror(errno)));
+    }
+
+    struct sockaddr_in localSock{};
+    localSock.sin_family = AF_INET;
+    localSock.sin_port = htons(_multicastPort);
+    localSock.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(socketDescriptor->descriptor.load(), (struct sockaddr *)&localSock, sizeof(localSock)) == -1) {
+      _out.printError("Error: Binding to port " + std::to_string(_multicastPort) + " failed: " + std::string(strerror(errno)));
+      Gd::bl->fileDescriptorManager.close(socketDescriptor);
+      return socketDescriptor;
+    }
+
+    struct ip_mreq group{};
+    group.imr_multiaddr.s_addr = inet_addr(_multicastIp.c_str());
+    group.imr_interface.s_addr = inet_addr(_listenIp.c_str());
+    if (setsockopt(socketDescriptor->descriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP, (char *)&group, sizeof(group)) == -1) {
+      _out.printError("Error: Could not join multicast group " + _multicastIp + ": " + std::string(strerror(errno)));
+      Gd::bl->fileDescriptorManager.close(socketDescriptor);
+      return socketDescriptor;
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return socketDescriptor;
+}
+
+void RoutingInterface::bindSocket() {
+  try {
+    if (!_listening) return;
+    closeSocket();
+    setListenAddress();
+    auto socketDescriptor = getSocketDescriptor();
+    if (socketDescriptor && socketDescriptor->descriptor != -1) {
+      registerSocket(socketDescriptor);
+      return;
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  scheduleRebind();
+}
+
+void RoutingInterface::scheduleRebind() {
+  closeSocket();
+  if (!_listening) return;
+  _out.printWarning("Warning: Socket is closed. Rebinding in 10 seconds...");
+  _rebindTimer = Gd::reactor->addTimer(10000, [this] { bindSocket(); });
+}
+
+void RoutingInterface::socketReadable() {
+  try {
+    auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+    if (!socketDescriptor || socketDescriptor->descriptor == -1) return;
+    auto &data = _receiveBuffer;
+    struct sockaddr_in senderInfo{};
+    socklen_t senderInfoSize = sizeof(senderInfo);
+
+    //Limit the number of frames processed at once, so other sockets and timers of the reactor are not delayed too long.
+    for (int32_t i = 0; i < 100; i++) {
+      senderInfoSize = sizeof(senderInfo);
+      data.resize(2048);
+      ssize_t bytesReceived = 0;
+      do {
+        bytesReceived = recvfrom(socketDescriptor->descriptor, data.data(), data.size(), 0, (struct sockaddr *)&senderInfo, &senderInfoSize);
+      } while (bytesReceived == -1 && errno == EINTR);
+
+      if (bytesReceived == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+      if (bytesReceived <= 0) {
+        _out.printError("Error: Socket closed: " + std::string(strerror(errno)));
+        scheduleRebind();
+        return;
+      }
+
+      data.resize(bytesReceived);
+      if (_bl->debugLevel >= 5) _out.printDebug("Debug: Packet received. Raw data: " + BaseLib::HelperFunctions::getHexString(data));
+
+      processRoutingPacket(data);
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    scheduleRebind();
+  }
+}
+
+void RoutingInterface::processRoutingPacket(const std::vector<uint8_t> &data) {
+  try {
+    try {
+      auto packet = std::make_shared<KnxIpPacket>(data);
+
+      if (packet->getServiceType() == ServiceType::ROUTING_INDICATION) {
+        auto packetData = packet->getRoutingIndication();
+        if (packetData && packetData->cemi->getMessageCode() == 0x29 && packetData->cemi->getSourceAddress() != _physicalAddress) {
+          _lastPacketReceived = BaseLib::HelperFunctions::getTime();
+          raisePacketReceived(packetData->cemi);
+        }
+      } else if (packet->getServiceType() == ServiceType::ROUTING_BUSY) {
+        auto packetData = packet->getRoutingBusy();
+        if (packetData) routingBusyReceived(packetData->waitTime);
+      } else if (packet->getServiceType() == ServiceType::ROUTING_LOST_MESSAGE) {
+        auto packetData = packet->getRoutingLostMessage();
+        if (packetData) {
+          _lostMessages += packetData->lostMessages;
+          _out.printWarning("Warning: A router reported " + std::to_string(packetData->lostMessages) + " lost messages.");
+        }
+      }
+    }
+    catch (const InvalidKnxIpPacketException &ex) {
+      _out.printWarning("Warning: Invalid KNX/IP packet received: " + BaseLib::HelperFunctions::getHexString(data));
+    }
+    catch (const InvalidKnxPacketException &ex) {
+      _out.printWarning("Warning: Invalid KNX packet received: " + BaseLib::HelperFunctions::getHexString(data));
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void RoutingInterface::routingBusyReceived(uint16_t waitTime) {
+  try {
+    _routingBusyReceived++;
+    auto time = BaseLib::HelperFunctions::getTime();
+    std::lock_guard<std::mutex> flowControlGuard(_flowControlMutex);
+    //ROUTING_BUSY frames received within 10 ms are counted once, as they were most likely sent by different routers because of the same event.
+    if (time - _lastRoutingBusy > 10) _busyCounter++;
+    _lastRoutingBusy = time;
+    //Pause for the wait time plus a random time of up to N * 50 ms, so not all devices start sending at the same time.
+    int64_t pauseUntil = time + waitTime + BaseLib::HelperFunctions::getRandomNumber(0, _busyCounter * 50);
+    if (pauseUntil > _pauseUntil) _pauseUntil = pauseUntil;
+    //N is decremented every 5 ms after a further N * 100 ms without ROUTING_BUSY.
+    _busyCounterDecrementTime = _pauseUntil + _busyCounter * 100;
+    if (_bl->debugLevel >= 4) _out.printInfo("Info: ROUTING_BUSY received. Pausing sending for " + std::to_string(_pauseUntil - time) + " ms.");
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+MainInterface::SendResult RoutingInterface::transmitPacket(const PTunnel &tunnel, const PCemi &cemi) {
+  try {
+    if (!isOpen() || _stopped) return SendResult::notConnected;
+
+    //{{{ Flow control
+    while (!_stopCallbackThread) {
+      auto time = BaseLib::HelperFunctions::getTime();
+      int64_t sendTime = 0;
+      {
+        std::lock_guard<std::mutex> flowControlGuard(_flowControlMutex);
+        if (_busyCounter > 0 && time > _busyCounterDecrementTime) {
+          uint32_t decrement = (uint32_t)((time - _busyCounterDecrementTime) / 5);
+          if (decrement >= _busyCounter) _busyCounter = 0;
+          else _busyCounter -= decrement;
+          _busyCounterDecrementTime += decrement * 5;
+        }
+        sendTime = std::max(_pauseUntil, _lastSendTime + _minSendInterval);
+        if (time >= sendTime) {
+          _lastSendTime = time;
+          break;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(std::min(sendTime - time, (int64_t)100)));
+    }
+    if (_stopCallbackThread) return SendResult::notConnected;
+    //}}}
+
+    //Routing carries L_Data.ind. The Cemi might be shared with other interfaces, so we don't modify it but patch the
+    //message code and source address in the serialized packet.
+    auto &data = tunnel->sendBuffer;
+    data.clear();
+    KnxIpPacket::appendRoutingIndication(data, *cemi);
+    if (data.size() < 14 || data.size() < 14u + data.at(7)) return SendResult::sendError;
+    data[6] = 0x29;
+    size_t sourceAddressPosition = 10u + data[7];
+    data[sourceAddressPosition] = (uint8_t)(_physicalAddress.load() >> 8);
+    data[sourceAddressPosition + 1] = (uint8_t)(_physicalAddress.load() & 0xFF);
+    if (data.size() > 200) {
+      if (_bl->debugLevel >= 2) _out.printError("Error: Tried to send packet larger than 200 bytes. That is not supported.");
+      return SendResult::tooLarge;
+    }
+
+    struct sockaddr_in addressInfo{};
+    addressInfo.sin_family = AF_INET;
+    addressInfo.sin_addr.s_addr = inet_addr(_multicastIp.c_str());
+    addressInfo.sin_port = htons(_multicastPort);
+
+    if (_bl->debugLevel >= 4) _out.printInfo("Info: Sending packet " + BaseLib::HelperFunctions::getHexString(data));
+    auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+    if (!socketDescriptor || sendto(socketDescriptor->descriptor, (char *)data.data(), data.size(), 0, (struct sockaddr *)&addressInfo, sizeof(addressInfo)) == -1) {
+      _out.printError("Error sending packet: " + std::string(strerror(errno)));
+      return SendResult::sendError;
+    }
+
+    _lastPacketSent = BaseLib::HelperFunctions::getTime();
+    return SendResult::success;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return SendResult::sendError;
+}
+
+BaseLib::PVariable RoutingInterface::getStatistics() {
+  try {
+    auto statistics = MainInterface::getStatistics();
+    if (statistics->errorStruct) return statistics;
+    statistics->structValue->emplace("routingBusyReceived", std::make_shared<BaseLib::Variable>((int64_t)_routingBusyReceived));
+    statistics->structValue->emplace("lostMessages", std::make_shared<BaseLib::Variable>((int64_t)_lostMessages));
+    {
+      std::lock_guard<std::mutex> flowControlGuard(_flowControlMutex);
+      statistics->structValue->emplace("busyCounter", std::make_shared<BaseLib::Variable>(_busyCounter));
+    }
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
@@ -0,0 +1,60 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef ROUTINGINTERFACE_H_
+#define ROUTINGINTERFACE_H_
+
+#include "MainInterface.h"
+
+namespace Knx {
+
+/**
+ * KNXnet/IP routing (multicast) interface. See chapter 3.8.5 of the KNX Standard.
+ *
+ * Packets are sent as ROUTING_INDICATION without any acknowledgement. The send queue of MainInterface is used with a single
+ * "tunnel" which is always connected. Flow control is implemented as described in the standard: After receiving
+ * ROUTING_BUSY sending is paused for the requested wait time plus a random time depending on the number of ROUTING_BUSY
+ * frames received recently.
+ */
+class RoutingInterface : public MainInterface {
+ public:
+  explicit RoutingInterface(const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings);
+  ~RoutingInterface() override;
+
+  void startListening() override;
+  void stopListening() override;
+
+  BaseLib::PVariable getStatistics() override;
+ protected:
+  std::string _multicastIp = "224.0.23.12";
+  uint16_t _multicastPort = 3671;
+  std::atomic<uint64_t> _rebindTimer{0};
+  std::vector<uint8_t> _receiveBuffer; //Only used by the reactor thread
+
+  //{{{ Flow control
+  std::mutex _flowControlMutex;
+  uint32_t _minSendInterval = 20; //In milliseconds
+  int64_t _lastSendTime = 0;
+  int64_t _pauseUntil = 0;
+  int64_t _lastRoutingBusy = 0;
+  int64_t _busyCounterDecrementTime = 0;
+  uint32_t _busyCounter = 0;
+  std::atomic<uint64_t> _routingBusyReceived{0};
+  std::atomic<uint64_t> _lostMessages{0};
+  //}}}
+
+  std::shared_ptr<BaseLib::FileDescriptor> getSocketDescriptor();
+
+  /**
+   * Opens the multicast socket. On errors a new try is scheduled after 10 seconds.
+   */
+  void bindSocket();
+  void scheduleRebind();
+  void socketReadable() override;
+  void processRoutingPacket(const std::vector<uint8_t> &data);
+  void routingBusyReceived(uint16_t waitTime);
+  SendResult transmitPacket(const PTunnel &tunnel, const PCemi &cemi) override;
+};
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "TcpFrameReader.h"
+
+#include <cerrno>
+#include <sys/socket.h>
+
+namespace Knx {
+
+TcpFrameReader::Result TcpFrameReader::read(int32_t descriptor, std::vector<uint8_t> &data) {
+  while (true) {
+    //{{{ Return the next complete frame
+    if (_buffer.size() >= 6) {
+      uint16_t frameSize = (((uint16_t)_buffer.at(4)) << 8) | _buffer.at(5);
+      //We can't find the start of the next frame anymore.
+      if (_buffer.at(0) != 0x06 || _buffer.at(1) != 0x10 || frameSize < 6) return Result::invalidData;
+      if (_buffer.size() >= frameSize) {
+        data.assign(_buffer.begin(), _buffer.begin() + frameSize);
+        _buffer.erase(_buffer.begin(), _buffer.begin() + frameSize);
+        return Result::frame;
+      }
+    }
+    //}}}
+
+    //Receive directly into the stream buffer
+    size_t bufferSize = _buffer.size();
+    _buffer.resize(bufferSize + 2048);
+    ssize_t bytesReceived = 0;
+    do {
+      bytesReceived = recv(descriptor, _buffer.data() + bufferSize, 2048, 0);
+    } while (bytesReceived == -1 && errno == EINTR);
+    _buffer.resize(bufferSize + (bytesReceived > 0 ? bytesReceived : 0));
+    if (bytesReceived == 0) return Result::closed;
+    if (bytesReceived == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return Result::needMoreData;
+      _lastError = errno;
+      return Result::error;
+    }
+  }
+}
+
+}
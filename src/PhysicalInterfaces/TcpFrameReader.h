@@ -0,0 +1,51 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef TCPFRAMEREADER_H_
+#define TCPFRAMEREADER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace Knx {
+
+/**
+ * Extracts KNXnet/IP frames from a TCP byte stream using the total length field of the KNXnet/IP header. Only depends on
+ * POSIX sockets, so it can be tested without a gateway (see misc/Benchmarks/TcpFramingTest.cpp).
+ */
+class TcpFrameReader {
+ public:
+  enum class Result {
+    frame, //"data" contains the next frame
+    needMoreData, //The socket has no more data. Call read() again when it is readable.
+    closed, //The connection was closed by the peer
+    invalidData, //The stream doesn't start with a valid header. The connection needs to be reestablished.
+    error //recv() failed. See getLastError().
+  };
+
+  TcpFrameReader() = default;
+  virtual ~TcpFrameReader() = default;
+
+  void clear() { _buffer.clear(); }
+
+  /**
+   * Returns the next complete frame. Reads from the non-blocking socket only when the buffer doesn't contain one.
+   */
+  Result read(int32_t descriptor, std::vector<uint8_t> &data);
+
+  /**
+   * @return Returns the data not returned as frame yet.
+   */
+  const std::vector<uint8_t> &getBuffer() const { return _buffer; }
+
+  /**
+   * @return Returns errno of the last failed recv().
+   */
+  int32_t getLastError() const { return _lastError; }
+ private:
+  std::vector<uint8_t> _buffer;
+  int32_t _lastError = 0;
+};
+
+}
+
+#endif
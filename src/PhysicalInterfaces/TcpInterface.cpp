@@ -0,0 +1,51 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "TcpInterface.h"
+#include "../Gd.h"
+
+#include <netinet/tcp.h>
+
+namespace Knx {
+
+TcpInterface::TcpInterface(const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings) : MainInterface(settings) {
+  _out.setPrefix(Gd::out.getPrefix() + "KNXNet/IP TCP \"" + settings->id + "\": ");
+
+  _hostProtocolCode = 0x02; //IPV4_TCP
+}
+
+TcpInterface::~TcpInterface() {
+  //The reactor calls our virtual methods, so the callbacks need to be removed before this object is destroyed.
+  removeCallbacks();
+}
+
+void TcpInterface::openSocket() {
+  closeSocket();
+  _frameReader.clear();
+  auto socketDescriptor = connectSocket(SOCK_STREAM);
+  //Frames are small and need to be sent immediately
+  int32_t noDelay = 1;
+  if (setsockopt(socketDescriptor->descriptor, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay)) == -1) _out.printWarning("Warning: Could not set socket options: " + std::string(strerror(errno)));
+  //HPAIs don't contain an endpoint over TCP. The forwarder copies these bytes into requests, so clear them.
+  _listenIpBytes.fill(0);
+  _listenPortBytes.fill(0);
+  registerSocket(socketDescriptor);
+}
+
+bool TcpInterface::readSocket(std::vector<uint8_t> &data) {
+  auto socketDescriptor = std::atomic_load(&_socketDescriptor);
+  if (!socketDescriptor || socketDescriptor->descriptor == -1) throw C1Net::ClosedException("Socket is not open.");
+  switch (_frameReader.read(socketDescriptor->descriptor, data)) {
+    case TcpFrameReader::Result::frame:return true;
+    case TcpFrameReader::Result::needMoreData:return false;
+    case TcpFrameReader::Result::closed:throw C1Net::ClosedException("Connection closed by gateway.");
+    case TcpFrameReader::Result::invalidData:
+      //We can't find the start of the next frame anymore. The connection needs to be reestablished.
+      _out.printError("Error: Invalid KNXnet/IP header received: " + BaseLib::HelperFunctions::getHexString(_frameReader.getBuffer()));
+      _frameReader.clear();
+      throw C1Net::ClosedException("Invalid data in TCP stream.");
+    case TcpFrameReader::Result::error:break;
+  }
+  throw C1Net::ClosedException("Error reading from socket: " + std::string(strerror(_frameReader.getLastError())));
+}
+
+}
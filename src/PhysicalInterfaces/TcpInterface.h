@@ -0,0 +1,31 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef TCPINTERFACE_H_
+#define TCPINTERFACE_H_
+
+#include "MainInterface.h"
+#include "TcpFrameReader.h"
+
+namespace Knx {
+
+/**
+ * KNXnet/IP tunneling over TCP (KNXnet/IP core v2). See chapter 3.8.4 of the KNX Standard.
+ *
+ * The protocol is the same as with MainInterface, but there are no TUNNELING_ACKs as TCP already guarantees delivery. HPAIs
+ * contain the host protocol code for TCP and no endpoint address. Frames are extracted from the byte stream using the total
+ * length field of the KNXnet/IP header.
+ */
+class TcpInterface : public MainInterface {
+ public:
+  explicit TcpInterface(const std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> &settings);
+  ~TcpInterface() override;
+ protected:
+  TcpFrameReader _frameReader; //Only accessed by the reactor thread while the socket is open
+
+  void openSocket() override;
+  bool readSocket(std::vector<uint8_t> &data) override;
+};
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "Reactor.h"
+#include "Gd.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace Knx {
+
+Reactor::Reactor() {
+  _out.init(Gd::bl);
+  _out.setPrefix(Gd::out.getPrefix() + "Reactor: ");
+}
+
+Reactor::~Reactor() {
+  stop();
+}
+
+int64_t Reactor::getSteadyTime() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Reactor::start(int32_t threadPriority, int32_t threadPolicy) {
+  try {
+    stop();
+
+    _epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollDescriptor == -1) {
+      _out.printCritical("Critical: Could not create epoll descriptor: " + std::string(strerror(errno)));
+      return;
+    }
+
+    _timerDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    _eventDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_timerDescriptor == -1 || _eventDescriptor == -1) {
+      _out.printCritical("Critical: Could not create timer or event descriptor: " + std::string(strerror(errno)));
+      stop();
+      return;
+    }
+
+    for (auto descriptor : {_timerDescriptor, _eventDescriptor}) {
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.fd = descriptor;
+      epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, descriptor, &event);
+    }
+
+    {
+      std::lock_guard<std::mutex> dataGuard(_dataMutex);
+      armTimer();
+    }
+
+    _stop = false;
+    if (threadPriority > -1) Gd::bl->threadManager.start(_thread, true, threadPriority, threadPolicy, &Reactor::run, this);
+    else Gd::bl->threadManager.start(_thread, true, &Reactor::run, this);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void Reactor::stop() {
+  try {
+    _stop = true;
+    if (_eventDescriptor != -1) {
+      uint64_t value = 1;
+      if (write(_eventDescriptor, &value, sizeof(value)) == -1) _out.printError("Error: Could not wake up event loop: " + std::string(strerror(errno)));
+    }
+    Gd::bl->threadManager.join(_thread);
+
+    for (auto descriptor : {&_epollDescriptor, &_timerDescriptor, &_eventDescriptor}) {
+      if (*descriptor == -1) continue;
+      close(*descriptor);
+      *descriptor = -1;
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool Reactor::addFileDescriptor(int32_t fileDescriptor, const Callback &callback) {
+  try {
+    if (fileDescriptor == -1 || _epollDescriptor == -1) return false;
+    std::lock_guard<std::mutex> dataGuard(_dataMutex);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fileDescriptor;
+    if (epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) == -1) {
+      _out.printError("Error: Could not add file descriptor to epoll: " + std::string(strerror(errno)));
+      return false;
+    }
+    _fileDescriptors[fileDescriptor] = std::make_shared<Callback>(callback);
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void Reactor::removeFileDescriptor(int32_t fileDescriptor) {
+  try {
+    if (fileDescriptor == -1) return;
+    {
+      std::lock_guard<std::mutex> dataGuard(_dataMutex);
+      if (_fileDescriptors.erase(fileDescriptor) == 0) return;
+      if (_epollDescriptor != -1) epoll_ctl(_epollDescriptor, EPOLL_CTL_DEL, fileDescriptor, nullptr);
+    }
+    //Wait for a running callback to finish
+    std::lock_guard<std::recursive_mutex> callbackGuard(_callbackMutex);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+uint64_t Reactor::addTimer(int64_t delay, const Callback &callback) {
+  try {
+    std::lock_guard<std::mutex> dataGuard(_dataMutex);
+    uint64_t id = ++_currentTimerId;
+    if (id == 0) id = ++_currentTimerId;
+    int64_t dueTime = getSteadyTime() + (delay < 0 ? 0 : delay);
+    bool isFirst = _timers.empty() || dueTime < _timers.begin()->first.first;
+    _timers.emplace(std::make_pair(dueTime, id), callback);
+    _timerDueTimes.emplace(id, dueTime);
+    if (isFirst) armTimer();
+    return id;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return 0;
+}
+
+void Reactor::removeTimer(uint64_t id) {
+  try {
+    if (id == 0) return;
+    {
+      std::lock_guard<std::mutex> dataGuard(_dataMutex);
+      auto timerIterator = _timerDueTimes.find(id);
+      if (timerIterator != _timerDueTimes.end()) {
+        _timers.erase(std::make_pair(timerIterator->second, id));
+        _timerDueTimes.erase(timerIterator);
+      }
+    }
+    //Wait for a running callback to finish
+    std::lock_guard<std::recursive_mutex> callbackGuard(_callbackMutex);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void Reactor::armTimer() {
+  if (_timerDescriptor == -1) return;
+  itimerspec timerSpec{};
+  if (!_timers.empty()) {
+    int64_t delay = _timers.begin()->first.first - getSteadyTime();
+    if (delay <= 0) timerSpec.it_value.tv_nsec = 1; //A value of 0 disarms the timer
+    else {
+      timerSpec.it_value.tv_sec = delay / 1000;
+      timerSpec.it_value.tv_nsec = (delay % 1000) * 1000000;
+    }
+  }
+  if (timerfd_settime(_timerDescriptor, 0, &timerSpec, nullptr) == -1) _out.printError("Error: Could not set timer: " + std::string(strerror(errno)));
+}
+
+void Reactor::runTimers() {
+  while (!_stop) {
+    //Lock the callback mutex before removing the timer, so removeTimer() waits for it.
+    std::lock_guard<std::recursive_mutex> callbackGuard(_callbackMutex);
+    Callback callback;
+    {
+      std::lock_guard<std::mutex> dataGuard(_dataMutex);
+      if (_timers.empty() || _timers.begin()->first.first > getSteadyTime()) {
+        armTimer();
+        return;
+      }
+      auto timerIterator = _timers.begin();
+      callback = std::move(timerIterator->second);
+      _timerDueTimes.erase(timerIterator->first.second);
+      _timers.erase(timerIterator);
+    }
+
+    try {
+      if (callback) callback();
+    }
+    catch (const std::exception &ex) {
+      _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+}
+
+void Reactor::run() {
+  _threadId = std::this_thread::get_id();
+  std::array<epoll_event, 64> events{};
+  while (!_stop) {
+    try {
+      int32_t eventCount = epoll_wait(_epollDescriptor, events.data(), events.size(), -1);
+      if (eventCount == -1) {
+        if (errno == EINTR) continue;
+        _out.printError("Error: epoll_wait failed: " + std::string(strerror(errno)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+
+      for (int32_t i = 0; i < eventCount && !_stop; i++) {
+        int32_t descriptor = events[i].data.fd;
+        if (descriptor == _eventDescriptor) {
+          uint64_t value = 0;
+          if (read(_eventDescriptor, &value, sizeof(value)) == -1 && errno != EAGAIN) _out.printError("Error reading from event descriptor: " + std::string(strerror(errno)));
+          continue;
+        } else if (descriptor == _timerDescriptor) {
+          uint64_t expirations = 0;
+          if (read(_timerDescriptor, &expirations, sizeof(expirations)) == -1 && errno != EAGAIN) _out.printError("Error reading from timer descriptor: " + std::string(strerror(errno)));
+          runTimers();
+          continue;
+        }
+
+        std::lock_guard<std::recursive_mutex> callbackGuard(_callbackMutex);
+        std::shared_ptr<Callback> callback;
+        {
+          std::lock_guard<std::mutex> dataGuard(_dataMutex);
+          auto fileDescriptorIterator = _fileDescriptors.find(descriptor);
+          if (fileDescriptorIterator == _fileDescriptors.end()) continue; //Removed in the meantime
+          callback = fileDescriptorIterator->second;
+        }
+
+        try {
+          if (callback && *callback) (*callback)();
+        }
+        catch (const std::exception &ex) {
+          _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+        }
+      }
+    }
+    catch (const std::exception &ex) {
+      _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+  _threadId = std::thread::id();
+}
+
+}
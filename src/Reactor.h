@@ -0,0 +1,72 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef REACTOR_H_
+#define REACTOR_H_
+
+#include <homegear-base/BaseLib.h>
+
+namespace Knx {
+
+/**
+ * Event loop based on epoll and timerfd shared by all physical interfaces. It calls a callback when a socket becomes
+ * readable and executes timers at their exact due time.
+ *
+ * All callbacks are executed on the reactor thread, so they must not block. When removeFileDescriptor() or removeTimer()
+ * return, the corresponding callback is not executing anymore and won't be called again.
+ */
+class Reactor {
+ public:
+  typedef std::function<void()> Callback;
+
+  Reactor();
+  virtual ~Reactor();
+
+  /**
+   * @param threadPriority The priority of the reactor thread. "-1" starts the thread with the default priority.
+   * @param threadPolicy The scheduling policy of the reactor thread.
+   */
+  void start(int32_t threadPriority, int32_t threadPolicy);
+  void stop();
+
+  /**
+   * Calls "callback" every time "fileDescriptor" is readable (level triggered).
+   */
+  bool addFileDescriptor(int32_t fileDescriptor, const Callback &callback);
+  void removeFileDescriptor(int32_t fileDescriptor);
+
+  /**
+   * Executes "callback" once after "delay" milliseconds.
+   *
+   * @return Returns the ID of the timer to pass to removeTimer(). IDs are never 0.
+   */
+  uint64_t addTimer(int64_t delay, const Callback &callback);
+  void removeTimer(uint64_t id);
+
+  bool isReactorThread() { return std::this_thread::get_id() == _threadId; }
+ private:
+  BaseLib::Output _out;
+  std::atomic_bool _stop{true};
+  std::thread _thread;
+  std::atomic<std::thread::id> _threadId;
+  int32_t _epollDescriptor = -1;
+  int32_t _timerDescriptor = -1;
+  int32_t _eventDescriptor = -1; //Used to wake up the event loop on stop()
+
+  //Held while a callback is executed, so removal can wait for running callbacks. Recursive, because callbacks may remove themselves.
+  std::recursive_mutex _callbackMutex;
+
+  std::mutex _dataMutex;
+  std::unordered_map<int32_t, std::shared_ptr<Callback>> _fileDescriptors;
+  uint64_t _currentTimerId = 0;
+  std::map<std::pair<int64_t, uint64_t>, Callback> _timers; //Ordered by due time
+  std::unordered_map<uint64_t, int64_t> _timerDueTimes;
+
+  static int64_t getSteadyTime();
+  void armTimer();
+  void runTimers();
+  void run();
+};
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#include "ReadScheduler.h"
+#include "Gd.h"
+
+namespace Knx {
+
+ReadScheduler::ReadScheduler(uint32_t packetsPerSecond) {
+  _out.init(Gd::bl);
+  _out.setPrefix(Gd::out.getPrefix() + "Read scheduler: ");
+
+  _sendInterval = packetsPerSecond > 0 ? 1000000 / packetsPerSecond : 0;
+}
+
+ReadScheduler::~ReadScheduler() {
+  stop();
+}
+
+int64_t ReadScheduler::getSteadyTime() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ReadScheduler::start() {
+  try {
+    stop();
+    _stop = false;
+    Gd::bl->threadManager.start(_workerThread, true, Gd::bl->settings.workerThreadPriority(), Gd::bl->settings.workerThreadPolicy(), &ReadScheduler::worker, this);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void ReadScheduler::stop() {
+  try {
+    _stop = true;
+    _queueConditionVariable.notify_all();
+    Gd::bl->threadManager.join(_workerThread);
+
+    std::lock_guard<std::mutex> queueGuard(_queueMutex);
+    _writeQueue.clear();
+    _readQueue.clear();
+    _queuedWrites.clear();
+    _queuedReads.clear();
+    _pendingResponses.clear();
+    _pendingResponseCount = 0;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+bool ReadScheduler::isDone() {
+  return _writeQueue.empty() && _readQueue.empty() && _pendingResponses.empty();
+}
+
+void ReadScheduler::add(std::vector<Request> &writes, std::vector<Request> &reads) {
+  try {
+    if (_stop || (writes.empty() && reads.empty())) return;
+
+    {
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      if (isDone()) {
+        _startTime = getSteadyTime();
+        _endTime = 0;
+        _requestsQueued = 0;
+        _writesSent = 0;
+        _readsSent = 0;
+        _readsAnswered = 0;
+        _readsUnanswered = 0;
+        _requestsFailed = 0;
+      }
+
+      for (auto &request : writes) {
+        if (!request.interface || !request.packet || !_queuedWrites.emplace(request.interface->getID(), request.packet->getDestinationAddress()).second) continue;
+        _writeQueue.emplace_back(std::move(request));
+        _requestsQueued++;
+      }
+
+      for (auto &request : reads) {
+        if (!request.interface || !request.packet || !_queuedReads.emplace(request.interface->getID(), request.packet->getDestinationAddress()).second) continue;
+        _readQueue.emplace_back(std::move(request));
+        _requestsQueued++;
+      }
+
+      _out.printInfo("Info: " + std::to_string(_writeQueue.size()) + " writes and " + std::to_string(_readQueue.size()) + " reads are queued.");
+    }
+    _queueConditionVariable.notify_one();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void ReadScheduler::responseReceived(const std::string &interfaceId, uint16_t groupAddress) {
+  try {
+    //Called for every received packet, so avoid locking when no read is pending.
+    if (_pendingResponseCount == 0) return;
+
+    std::lock_guard<std::mutex> queueGuard(_queueMutex);
+    auto pendingResponseIterator = _pendingResponses.find(RequestKey(interfaceId, groupAddress));
+    if (pendingResponseIterator == _pendingResponses.end()) return;
+    _pendingResponses.erase(pendingResponseIterator);
+    _pendingResponseCount = _pendingResponses.size();
+    _readsAnswered++;
+    if (isDone()) _endTime = getSteadyTime();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void ReadScheduler::expirePendingResponses(int64_t time) {
+  if (_pendingResponses.empty()) return;
+  for (auto pendingResponseIterator = _pendingResponses.begin(); pendingResponseIterator != _pendingResponses.end();) {
+    if (time - pendingResponseIterator->second >= _responseTimeout) {
+      _readsUnanswered++;
+      pendingResponseIterator = _pendingResponses.erase(pendingResponseIterator);
+    } else pendingResponseIterator++;
+  }
+  _pendingResponseCount = _pendingResponses.size();
+  if (isDone() && _endTime == 0) _endTime = time;
+}
+
+void ReadScheduler::worker() {
+  int64_t nextSendTime = 0;
+  //Requests that couldn't be sent since the last request sent from the same queue. When all requests of both queues are
+  //blocked, the worker waits before trying again.
+  size_t blockedWrites = 0;
+  size_t blockedReads = 0;
+  bool queueFull = false;
+  while (!_stop) {
+    try {
+      Request request;
+      bool isRead = false;
+
+      {
+        std::unique_lock<std::mutex> queueGuard(_queueMutex);
+        _queueConditionVariable.wait_for(queueGuard, std::chrono::milliseconds(1000), [&] { return !_writeQueue.empty() || !_readQueue.empty() || _stop; });
+        if (_stop) return;
+        expirePendingResponses(getSteadyTime());
+        if (_writeQueue.empty() && _readQueue.empty()) continue;
+        if (blockedWrites >= _writeQueue.size() && blockedReads >= _readQueue.size()) {
+          //No interface accepts requests right now.
+          _queueConditionVariable.wait_for(queueGuard, std::chrono::milliseconds(queueFull ? 100 : 1000), [&] { return _stop.load(); });
+          blockedWrites = 0;
+          blockedReads = 0;
+          queueFull = false;
+          continue;
+        }
+        //Writes are sent first, unless all of them are for interfaces that don't accept requests.
+        isRead = blockedWrites >= _writeQueue.size();
+        //Only this thread removes or moves entries, so the request stays at the front until it is sent.
+        request = isRead ? _readQueue.front() : _writeQueue.front();
+      }
+
+      auto time = getSteadyTime();
+      if (nextSendTime > time) std::this_thread::sleep_for(std::chrono::microseconds(nextSendTime - time));
+      if (_stop) return;
+
+      auto result = request.interface->queuePacket(request.packet);
+      if (result == MainInterface::SendResult::queueFull || result == MainInterface::SendResult::notConnected) {
+        //Try again later and continue with the requests of the other interfaces in the meantime. Requests queued again
+        //after a reconnect are ignored, because they are still queued.
+        std::lock_guard<std::mutex> queueGuard(_queueMutex);
+        if (_stop) return;
+        auto &queue = isRead ? _readQueue : _writeQueue;
+        queue.push_back(std::move(queue.front()));
+        queue.pop_front();
+        if (isRead) blockedReads++;
+        else blockedWrites++;
+        if (result == MainInterface::SendResult::queueFull) queueFull = true;
+        continue;
+      }
+      if (isRead) blockedReads = 0;
+      else blockedWrites = 0;
+      time = getSteadyTime();
+      nextSendTime = time + _sendInterval;
+
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      if (_stop) return;
+      RequestKey key(request.interface->getID(), request.packet->getDestinationAddress());
+      if (isRead) {
+        _readQueue.pop_front();
+        _queuedReads.erase(key);
+      } else {
+        _writeQueue.pop_front();
+        _queuedWrites.erase(key);
+      }
+      if (result != MainInterface::SendResult::queued) {
+        _requestsFailed++;
+        _out.printWarning("Warning: Could not send request to " + Cemi::getFormattedGroupAddress(key.second) + " on interface " + key.first + ": " + MainInterface::getSendResultString(result));
+      } else if (isRead) {
+        _readsSent++;
+        _pendingResponses[key] = time;
+        _pendingResponseCount = _pendingResponses.size();
+      } else _writesSent++;
+      if (isDone()) _endTime = time;
+    }
+    catch (const std::exception &ex) {
+      _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+}
+
+BaseLib::PVariable ReadScheduler::getStatistics() {
+  try {
+    auto statistics = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
+    std::lock_guard<std::mutex> queueGuard(_queueMutex);
+
+    auto time = getSteadyTime();
+    std::string state = "idle";
+    if (_startTime != 0) state = isDone() ? "finished" : "running";
+    int64_t duration = _startTime == 0 ? 0 : (_endTime != 0 ? _endTime : time) - _startTime;
+
+    //Use the measured rate once requests were sent, as the interfaces might not be able to send at the configured rate.
+    uint64_t requestsSent = _writesSent + _readsSent + _requestsFailed;
+    uint64_t remainingRequests = _writeQueue.size() + _readQueue.size();
+    int64_t eta = -1;
+    if (remainingRequests == 0) eta = 0;
+    else if (requestsSent > 0 && duration > 0) eta = (int64_t)(remainingRequests * duration / requestsSent) / 1000000;
+    else if (_sendInterval > 0) eta = (int64_t)(remainingRequests * _sendInterval) / 1000000;
+
+    statistics->structValue->emplace("state", std::make_shared<BaseLib::Variable>(state));
+    statistics->structValue->emplace("requestsQueued", std::make_shared<BaseLib::Variable>((int64_t)_requestsQueued));
+    statistics->structValue->emplace("writesQueued", std::make_shared<BaseLib::Variable>((int64_t)_writeQueue.size()));
+    statistics->structValue->emplace("readsQueued", std::make_shared<BaseLib::Variable>((int64_t)_readQueue.size()));
+    statistics->structValue->emplace("writesSent", std::make_shared<BaseLib::Variable>((int64_t)_writesSent));
+    statistics->structValue->emplace("readsSent", std::make_shared<BaseLib::Variable>((int64_t)_readsSent));
+    statistics->structValue->emplace("readsPending", std::make_shared<BaseLib::Variable>((int64_t)_pendingResponses.size()));
+    statistics->structValue->emplace("readsAnswered", std::make_shared<BaseLib::Variable>((int64_t)_readsAnswered));
+    statistics->structValue->emplace("readsUnanswered", std::make_shared<BaseLib::Variable>((int64_t)_readsUnanswered));
+    statistics->structValue->emplace("requestsFailed", std::make_shared<BaseLib::Variable>((int64_t)_requestsFailed));
+    statistics->structValue->emplace("progress", std::make_shared<BaseLib::Variable>(_requestsQueued > 0 ? (double)(_requestsQueued - remainingRequests) / _requestsQueued : 1.0));
+    statistics->structValue->emplace("duration", std::make_shared<BaseLib::Variable>(duration / 1000000)); //In seconds
+    statistics->structValue->emplace("eta", std::make_shared<BaseLib::Variable>(eta)); //In seconds, -1 if unknown
+    return statistics;
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return BaseLib::Variable::createError(-32500, "Unknown application error.");
+}
+
+}
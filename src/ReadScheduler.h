@@ -0,0 +1,92 @@
+/* Copyright 2013-2019 Homegear GmbH */
+
+#ifndef READSCHEDULER_H_
+#define READSCHEDULER_H_
+
+#include "Cemi.h"
+#include "PhysicalInterfaces/MainInterface.h"
+
+#include <homegear-base/BaseLib.h>
+
+namespace Knx {
+
+/**
+ * Acquires the state of all group addresses after start up or a reconnect. Instead of every peer reading its variables
+ * one after another and waiting for each response, the central collects the requests of all peers and queues them here.
+ * Every group address is only read (or written for "read on init") once per interface, no matter how many peers use it.
+ * Requests are sent without waiting for responses, limited by a packet rate. Responses are dispatched to all peers of the
+ * group address like any other packet.
+ */
+class ReadScheduler {
+ public:
+  struct Request {
+    std::shared_ptr<MainInterface> interface; //The interface the request is sent to
+    PCemi packet;
+  };
+
+  /**
+   * @param packetsPerSecond The maximum number of requests sent per second. "0" disables the limit.
+   */
+  explicit ReadScheduler(uint32_t packetsPerSecond);
+  virtual ~ReadScheduler();
+
+  void start();
+  void stop();
+
+  /**
+   * Queues requests. Writes are sent before reads. Requests for a group address that is already queued for the same
+   * interface are ignored. Requests for an interface that is not connected or whose queue is full are moved to the end
+   * of their queue, so they don't hold up the requests of other interfaces.
+   */
+  void add(std::vector<Request> &writes, std::vector<Request> &reads);
+
+  /**
+   * Must be called for every GroupValueResponse and GroupValueWrite, so answered reads are counted.
+   *
+   * @param interfaceId The ID of the interface the packet was received on.
+   */
+  void responseReceived(const std::string &interfaceId, uint16_t groupAddress);
+
+  BaseLib::PVariable getStatistics();
+ private:
+  typedef std::pair<std::string, uint16_t> RequestKey; //Interface ID and group address
+
+  BaseLib::Output _out;
+  std::atomic_bool _stop{true};
+  std::thread _workerThread;
+  int64_t _sendInterval = 0; //In microseconds
+  static constexpr int64_t _responseTimeout = 5000000; //In microseconds
+
+  std::mutex _queueMutex;
+  std::condition_variable _queueConditionVariable;
+  std::deque<Request> _writeQueue;
+  std::deque<Request> _readQueue;
+  std::set<RequestKey> _queuedWrites; //Requests in _writeQueue
+  std::set<RequestKey> _queuedReads; //Requests in _readQueue
+  std::map<RequestKey, int64_t> _pendingResponses; //Steady time in microseconds the read was sent
+  std::atomic<uint32_t> _pendingResponseCount{0};
+
+  //{{{ Statistics, protected by _queueMutex. They are reset when requests are added after all previous ones are done.
+  int64_t _startTime = 0;
+  int64_t _endTime = 0;
+  uint64_t _requestsQueued = 0;
+  uint64_t _writesSent = 0;
+  uint64_t _readsSent = 0;
+  uint64_t _readsAnswered = 0;
+  uint64_t _readsUnanswered = 0;
+  uint64_t _requestsFailed = 0;
+  //}}}
+
+  static int64_t getSteadyTime();
+
+  //{{{ _queueMutex needs to be locked when calling these methods.
+  bool isDone();
+  void expirePendingResponses(int64_t time);
+  //}}}
+
+  void worker();
+};
+
+}
+
+#endif